@@ -1,8 +1,72 @@
 #include "crow_all.h"
 #include "mkdisk.h"
+#include "singleflight.h"
+#include "scheduler.h"
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <filesystem>
+#include <functional>
+
+// Crear el disco y armar la respuesta de /mkdisk. Las creaciones de una misma
+// ruta pasan de a una: si llega el mismo disco mientras se crea, la segunda
+// espera y recibe su propio resultado ("El disco ya existe"), sin llenar el
+// archivo a la par. Un disco pesado lo crea uno de los hilos del trabajo
+// pesado, que es quien espera esa ruta; si esos hilos están todos ocupados se
+// responde 503 con Retry-After
+crow::response runMkdisk(SingleFlight::PathLocks& creating, int size, const std::string& unit,
+                         const std::string& path, Scheduler::Kind kind) {
+    crow::json::wvalue response;
+
+    try {
+        std::string diskPath = std::filesystem::path(CommandMkdisk::expandPath(path)).lexically_normal().string();
+        std::string result;
+        bool busy = false;
+        if (kind == Scheduler::Kind::Bulk) {
+            busy = !Scheduler::bulkPool().tryRun([&creating, diskPath, size, unit, path]() {
+                SingleFlight::PathLocks::Guard guard(creating, diskPath);
+                return CommandMkdisk::execute(size, unit, path, Scheduler::yieldToInteractive);
+            }, result);
+        } else {
+            SingleFlight::PathLocks::Guard guard(creating, diskPath);
+            result = CommandMkdisk::execute(size, unit, path, nullptr);
+        }
+
+        // Sin hilo libre para el trabajo pesado
+        if (busy) {
+            response["success"] = false;
+            response["error"] = "Servidor ocupado con otros discos grandes, intente más tarde";
+            crow::response busyResponse(503, response);
+            busyResponse.set_header("Retry-After", std::to_string(Scheduler::BULK_RETRY_AFTER_S));
+            return busyResponse;
+        }
+
+        // Verificar si hubo error
+        if (result.find("Error:") != std::string::npos ||
+            result.find("error:") != std::string::npos) {
+            response["success"] = false;
+            response["error"] = result;
+            return crow::response(400, response);
+        }
+
+        // Éxito
+        response["success"] = true;
+        response["message"] = "Disco creado exitosamente";
+        response["details"] = result;
+        response["parameters"] = crow::json::wvalue{
+            {"size", size},
+            {"unit", unit},
+            {"path", path}
+        };
+
+        return crow::response(200, response);
+
+    } catch (const std::exception& e) {
+        response["success"] = false;
+        response["error"] = std::string("Excepción: ") + e.what();
+        return crow::response(500, response);
+    }
+}
 
 int main() {
     // Inicializar generador de números aleatorios
@@ -10,6 +74,9 @@ int main() {
     
     // Crear aplicación Crow
     crow::SimpleApp app;
+
+    // Discos que se están creando (una creación a la vez por ruta)
+    SingleFlight::PathLocks creating;
     
     // ========== ENDPOINT: GET ==========
     CROW_ROUTE(app, "/")
@@ -27,7 +94,7 @@ int main() {
     // ========== ENDPOINT: POST /mkdisk (Crear disco) ==========
     CROW_ROUTE(app, "/mkdisk")
     .methods("POST"_method)
-    ([](const crow::request& req) {
+    ([&creating](const crow::request& req) {
         crow::json::wvalue response;
         
         try {
@@ -51,29 +118,17 @@ int main() {
                 response["error"] = "El parámetro 'path' es obligatorio";
                 return crow::response(400, response);
             }
-            
-            // Ejecutar comando mkdisk
-            std::string result = CommandMkdisk::execute(size, unit, path);
-            
-            // Verificar si hubo error
-            if (result.find("Error:") != std::string::npos || 
-                result.find("error:") != std::string::npos) {
-                response["success"] = false;
-                response["error"] = result;
-                return crow::response(400, response);
+
+            // Un disco grande es trabajo pesado: lo crea uno de los hilos
+            // propios (BULK_SLOTS a la vez, prioridad de E/S baja y cediendo
+            // el disco entre trozos) y esta petición espera el resultado, o
+            // recibe 503 si no hay hilo libre
+            if (Scheduler::classifyMkdisk(size, unit) == Scheduler::Kind::Bulk) {
+                return runMkdisk(creating, size, unit, path, Scheduler::Kind::Bulk);
             }
-            
-            // Éxito
-            response["success"] = true;
-            response["message"] = "Disco creado exitosamente";
-            response["details"] = result;
-            response["parameters"] = crow::json::wvalue{
-                {"size", size},
-                {"unit", unit},
-                {"path", path}
-            };
-            
-            return crow::response(200, response);
+
+            Scheduler::Interactive interactive;
+            return runMkdisk(creating, size, unit, path, Scheduler::Kind::Interactive);
             
         } catch (const std::exception& e) {
             response["success"] = false;
@@ -85,9 +140,19 @@ int main() {
     // ========== ENDPOINT: GET /health ==========
     CROW_ROUTE(app, "/health")
     ([]() {
+        Scheduler::Interactive interactive;
         crow::json::wvalue response;
         response["status"] = "healthy";
         response["uptime"] = "N/A";
+        Scheduler::Stats& stats = Scheduler::stats();
+        response["scheduler"] = crow::json::wvalue{
+            {"interactive_active", stats.interactiveActive.load()},
+            {"interactive_done", static_cast<int64_t>(stats.interactiveDone.load())},
+            {"bulk_active", stats.bulkActive.load()},
+            {"bulk_done", static_cast<int64_t>(stats.bulkDone.load())},
+            {"bulk_rejected", static_cast<int64_t>(stats.bulkRejected.load())},
+            {"bulk_yields", static_cast<int64_t>(stats.yields.load())}
+        };
         return crow::response(200, response);
     });
     
@@ -96,8 +161,10 @@ int main() {
     std::cout << "MIA Proyecto 1 - 2026\n";
     std::cout << "\n🔥 Servidor corriendo... Presiona Ctrl+C para detener\n\n";
     
+    // Hilos fijos (no según los núcleos): los interactivos deben existir
+    // aunque haya trabajos pesados ocupando sus lugares
     app.port(8081)
-       .multithreaded()
+       .concurrency(Scheduler::serverThreads())
        .run();
     
     return 0;
@@ -5,8 +5,11 @@
 #include <iostream>    // Maneja entrada y salida estándar (cin, cout).
 #include <fstream>     // Proporciona funcionalidades para trabajar con archivos (lectura y escritura).
 #include <cstring>     // Manipula cadenas C-style (funciones como strcpy, strcmp, etc.).
+#include <algorithm>   // std::min.
 #include <cstdlib>     // Proporciona funciones generales como rand() y conversiones de cadenas a números.
 #include <filesystem>  // Proporciona funciones para trabajar con el sistema de archivos (archivos, directorios).
+#include <functional>  // Acción entre trozos del llenado con ceros.
+#include <vector>      // Trozo de ceros.
 #include "structures.h" // Define estructuras de datos personalizadas.
 
 
@@ -44,8 +47,12 @@ namespace CommandMkdisk {
         }
     }
 
-    // Comando mkdisk: Crear un disco virtual
-    inline std::string execute(int size, const std::string& unit, const std::string& path) {
+    const size_t ZERO_CHUNK = 1024 * 1024;     // Bytes por escritura del llenado con ceros
+
+    // Comando mkdisk: Crear un disco virtual. 'betweenChunks' se llama entre
+    // dos trozos del llenado (el servidor la usa para ceder el disco)
+    inline std::string execute(int size, const std::string& unit, const std::string& path,
+                               const std::function<void()>& betweenChunks = nullptr) {
         try {
             std::string expandedPath = expandPath(path);
             
@@ -82,10 +89,16 @@ namespace CommandMkdisk {
                 return "Error: No se pudo crear el archivo del disco";
             }
 
-            // Llenar el archivo con ceros
-            char zero = '\0';
-            for (int i = 0; i < sizeInBytes; i++) {
-                diskFile.write(&zero, 1);
+            // Llenar el archivo con ceros, por trozos
+            std::vector<char> zeros(ZERO_CHUNK, '\0');
+            for (long long written = 0; written < sizeInBytes; ) {
+                size_t length = static_cast<size_t>(std::min<long long>(ZERO_CHUNK, sizeInBytes - written));
+                diskFile.write(zeros.data(), length);
+                written += length;
+                if (betweenChunks && written < sizeInBytes) {
+                    diskFile.flush();
+                    betweenChunks();
+                }
             }
 
             // Crear y escribir el MBR
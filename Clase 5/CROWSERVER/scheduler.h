@@ -0,0 +1,191 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <string>              // Unidades de mkdisk
+#include <atomic>              // Contadores compartidos
+#include <thread>              // Pausas entre trozos, hilos del trabajo pesado
+#include <chrono>              // Duración de las pausas
+#include <deque>               // Cola del trabajo pesado
+#include <mutex>               // Acceso a la cola
+#include <condition_variable>  // Aviso de trabajo nuevo
+#include <functional>          // Trabajos en cola
+#include <future>              // Resultado que espera la petición
+#include <memory>              // Tareas compartidas con la cola
+#include <unistd.h>            // syscall
+#include <sys/syscall.h>       // SYS_ioprio_set, SYS_ioprio_get
+
+// Dos clases de trabajo en el servidor. Lo interactivo (consultas, discos
+// pequeños) corre en los hilos de Crow con prioridad de E/S alta; lo pesado
+// (mkdisk grandes) corre en BULK_SLOTS hilos propios, con la prioridad de E/S
+// más baja, y escribe en trozos cediendo entre uno y otro mientras haya
+// peticiones interactivas en curso. Si esos hilos están ocupados el trabajo
+// se rechaza (la petición responde 503) en vez de dejar otro hilo de Crow
+// esperando en una cola
+namespace Scheduler {
+
+    enum class Kind { Interactive, Bulk };
+
+    const long long BULK_THRESHOLD = 8LL * 1024 * 1024;     // mkdisk desde este tamaño es pesado
+    const int INTERACTIVE_WORKERS = 4;                      // Hilos de Crow además de BULK_SLOTS
+    const int BULK_SLOTS = 2;                               // Trabajos pesados a la vez (hilos propios)
+    const int MAX_YIELD_MS = 20;                            // Espera máxima entre dos trozos
+    const int BULK_RETRY_AFTER_S = 5;                       // Retry-After del 503 sin lugar
+
+    // Hilos para app.concurrency(): Crow usa uno para aceptar conexiones y
+    // reparte las conexiones entre el resto. Una petición pesada deja su hilo
+    // esperando el resultado y solo se admiten BULK_SLOTS a la vez, así que
+    // se suman BULK_SLOTS a los interactivos
+    inline unsigned serverThreads() {
+        return 1 + INTERACTIVE_WORKERS + BULK_SLOTS;
+    }
+
+    // Prioridad de E/S del hilo (clase best-effort, nivel 0 = más alta, 7 = más baja)
+    const int IOPRIO_WHO_PROCESS = 1;
+    const int IOPRIO_CLASS_BE = 2;
+    const int IOPRIO_CLASS_SHIFT = 13;
+
+    inline bool setIoPriority(int level) {
+        int value = (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | level;
+        return syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, value) == 0;
+    }
+
+    // Prioridad de E/S completa del hilo (clase y nivel), -1 si no se pudo leer
+    inline int getIoPriority() {
+        return static_cast<int>(syscall(SYS_ioprio_get, IOPRIO_WHO_PROCESS, 0));
+    }
+
+    inline bool restoreIoPriority(int value) {
+        return value >= 0 && syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, value) == 0;
+    }
+
+    // Contadores para /health
+    struct Stats {
+        std::atomic<int> interactiveActive{0};
+        std::atomic<int> bulkActive{0};
+        std::atomic<long long> interactiveDone{0};
+        std::atomic<long long> bulkDone{0};
+        std::atomic<long long> bulkRejected{0}; // Trabajos pesados sin lugar (503)
+        std::atomic<long long> yields{0};       // Pausas de trabajos pesados
+    };
+
+    inline Stats& stats() {
+        static auto* counters = new Stats();
+        return *counters;
+    }
+
+    // Tamaño en bytes de un mkdisk (-1 si la unidad no es válida)
+    inline long long mkdiskBytes(int size, const std::string& unit) {
+        if (unit == "k" || unit == "K") {
+            return static_cast<long long>(size) * 1024;
+        }
+        if (unit == "m" || unit == "M") {
+            return static_cast<long long>(size) * 1024 * 1024;
+        }
+        return -1;
+    }
+
+    inline Kind classifyMkdisk(int size, const std::string& unit) {
+        return mkdiskBytes(size, unit) >= BULK_THRESHOLD ? Kind::Bulk : Kind::Interactive;
+    }
+
+    // Marca una petición interactiva mientras dura. Los hilos de Crow son
+    // compartidos: al terminar se devuelve la prioridad de E/S que tenía
+    class Interactive {
+    public:
+        Interactive() : previous(getIoPriority()) {
+            setIoPriority(0);
+            stats().interactiveActive++;
+        }
+
+        ~Interactive() {
+            restoreIoPriority(previous);
+            stats().interactiveActive--;
+            stats().interactiveDone++;
+        }
+
+    private:
+        int previous;
+    };
+
+    // Hilos del trabajo pesado. tryRun() entrega el trabajo a un hilo libre y
+    // bloquea al hilo de Crow hasta tener el resultado (la respuesta se arma
+    // ahí mismo: terminar una respuesta desde otro hilo no es seguro en Crow).
+    // Con BULK_SLOTS trabajos en curso devuelve false sin esperar, así que
+    // nunca hay más de BULK_SLOTS hilos de Crow bloqueados. Los errores del
+    // trabajo se vuelven a lanzar en quien espera
+    class BulkPool {
+    public:
+        BulkPool() {
+            for (int k = 0; k < BULK_SLOTS; k++) {
+                std::thread([this]() { loop(); }).detach();
+            }
+        }
+
+        bool tryRun(std::function<std::string()> work, std::string& output) {
+            auto task = std::make_shared<std::packaged_task<std::string()>>(std::move(work));
+            std::future<std::string> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (admitted >= BULK_SLOTS) {
+                    stats().bulkRejected++;
+                    return false;
+                }
+                admitted++;
+                queue.push_back([task]() { (*task)(); });
+            }
+            ready.notify_one();
+            output = result.get();
+            return true;
+        }
+
+    private:
+        void loop() {
+            setIoPriority(7);
+            while (true) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&]() { return !queue.empty(); });
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                }
+                stats().bulkActive++;
+                job();
+                stats().bulkActive--;
+                stats().bulkDone++;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    admitted--;
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::function<void()>> queue;   // Nunca más de BULK_SLOTS
+        int admitted = 0;                           // Trabajos entregados y sin terminar
+    };
+
+    inline BulkPool& bulkPool() {
+        static auto* pool = new BulkPool();
+        return *pool;
+    }
+
+    // Entre dos trozos de un trabajo pesado: esperar a que terminen las
+    // peticiones interactivas en curso (hasta MAX_YIELD_MS)
+    inline void yieldToInteractive() {
+        bool waited = false;
+        for (int ms = 0; ms < MAX_YIELD_MS && stats().interactiveActive.load() > 0; ms++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            waited = true;
+        }
+        if (waited) {
+            stats().yields++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+} // namespace Scheduler
+
+#endif // SCHEDULER_H
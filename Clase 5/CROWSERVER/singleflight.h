@@ -0,0 +1,167 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <string>              // Claves de las peticiones
+#include <map>                 // Peticiones en curso por clave
+#include <memory>              // Estado compartido de cada ejecución
+#include <mutex>               // Acceso concurrente al registro
+#include <condition_variable>  // Espera del resultado
+#include <functional>          // Trabajo a ejecutar
+#include <exception>           // Errores compartidos con los que esperan
+#include <sys/stat.h>          // Fecha de modificación de la imagen
+
+// Agrupar peticiones idénticas que llegan al mismo tiempo: mientras una se
+// ejecuta, las demás con la misma clave esperan y reciben su resultado, así
+// que una ráfaga de consultas repetidas hace una sola lectura del disco. Solo
+// sirve para consultas de solo lectura (la clave lleva la fecha de la
+// imagen); las que escriben una imagen pasan de a una con PathLocks y cada
+// una recibe su propio resultado
+namespace SingleFlight {
+
+    // Ejecución en curso de una clave
+    template <typename T>
+    struct Call {
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        int waiters = 0;            // Peticiones que esperan (con el candado del grupo)
+        T result;
+        std::exception_ptr error;
+    };
+
+    template <typename T>
+    class Group {
+    public:
+        // Ejecutar 'work' para 'key' o esperar la ejecución que ya está en
+        // curso. 'shared' indica si el resultado vino de otra petición
+        T run(const std::string& key, const std::function<T()>& work, bool& shared) {
+            std::shared_ptr<Call<T>> call;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = calls.find(key);
+                if (it != calls.end()) {
+                    call = it->second;
+                    call->waiters++;
+                    shared = true;
+                } else {
+                    call = std::make_shared<Call<T>>();
+                    calls[key] = call;
+                    shared = false;
+                }
+            }
+
+            if (shared) {
+                std::unique_lock<std::mutex> lock(call->mutex);
+                call->done.wait(lock, [&]() { return call->finished; });
+                if (call->error) {
+                    std::rethrow_exception(call->error);
+                }
+                return call->result;
+            }
+
+            T result{};
+            std::exception_ptr error;
+            try {
+                result = work();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            {
+                // La clave se suelta antes de avisar: lo que llegue después
+                // vuelve a ejecutar y ve el disco ya cambiado. Los que esperan
+                // se suman con este candado, así que aquí ya no cambian
+                std::lock_guard<std::mutex> lock(mutex);
+                calls.erase(key);
+                coalesced += call->waiters;
+            }
+            {
+                std::lock_guard<std::mutex> lock(call->mutex);
+                call->result = result;
+                call->error = error;
+                call->finished = true;
+            }
+            call->done.notify_all();
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return result;
+        }
+
+        // Peticiones que no se ejecutaron por compartir un resultado
+        long long coalescedCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return coalesced;
+        }
+
+    private:
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<Call<T>>> calls;
+        long long coalesced = 0;
+    };
+
+    // Candados por ruta de imagen: las peticiones que escriben la misma
+    // imagen se ejecutan de a una. La entrada se borra al soltar el último
+    class PathLocks {
+        struct Entry {
+            std::mutex mutex;
+            int users = 0;          // Dueño y los que esperan (con el candado del registro)
+        };
+
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<Entry>> entries;
+
+    public:
+        class Guard {
+        public:
+            Guard(PathLocks& owner, const std::string& path) : owner(owner), path(path) {
+                std::shared_ptr<Entry> entry;
+                {
+                    std::lock_guard<std::mutex> lock(owner.mutex);
+                    auto& slot = owner.entries[path];
+                    if (!slot) {
+                        slot = std::make_shared<Entry>();
+                    }
+                    slot->users++;
+                    entry = slot;
+                }
+                entry->mutex.lock();
+                held = entry;
+            }
+
+            ~Guard() {
+                held->mutex.unlock();
+                std::lock_guard<std::mutex> lock(owner.mutex);
+                if (--held->users == 0) {
+                    owner.entries.erase(path);
+                }
+            }
+
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+
+        private:
+            PathLocks& owner;
+            std::string path;
+            std::shared_ptr<Entry> held;
+        };
+    };
+
+    // Fecha de modificación de la imagen en nanosegundos ("-" si no existe):
+    // forma parte de la clave para no mezclar lecturas de versiones distintas
+    inline std::string imageStamp(const std::string& path) {
+        struct stat info;
+        if (path.empty() || stat(path.c_str(), &info) != 0) {
+            return "-";
+        }
+        return std::to_string(static_cast<long long>(info.st_mtim.tv_sec)) + "." +
+               std::to_string(static_cast<long long>(info.st_mtim.tv_nsec));
+    }
+
+    // Clave de una petición: endpoint, parámetros ya normalizados e imagen
+    inline std::string key(const std::string& endpoint, const std::string& params, const std::string& imagePath) {
+        return endpoint + "|" + params + "|" + imageStamp(imagePath);
+    }
+
+} // namespace SingleFlight
+
+#endif // SINGLEFLIGHT_H
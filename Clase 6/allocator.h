@@ -0,0 +1,518 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <string>       // Manejo de la clase std::string
+#include <map>          // Registro de asignadores por sistema de archivos
+#include <memory>       // std::shared_ptr / std::unique_ptr
+#include <mutex>        // Un candado por grupo de bloques
+#include <vector>       // Vectores dinámicos
+#include <fstream>      // Lectura inicial de bitmaps
+#include <cstddef>      // offsetof
+#include <algorithm>    // std::min
+#include "structures.h"
+#include "filesystem.h"
+#include "bitmap.h"
+#include "journal.h"
+#include "itable_init.h"
+#include "buffer_cache.h"
+
+// Asignación de inodos y bloques. Los bitmaps y los descriptores de grupo se
+// leen del disco una sola vez y se mantienen en memoria: asignar es buscar un
+// bit en memoria (desde la pista next-fit s_first_ino / s_first_blo) y escribir
+// solo el byte del bitmap, el descriptor y los contadores del Superbloque que
+// cambian. Cada grupo de bloques tiene su propio candado, así que asignaciones
+// en grupos distintos avanzan en paralelo; los inodos nuevos se buscan primero
+// en el grupo de la carpeta padre y los bloques en el grupo de su inodo.
+// Los bloques se reservan antes de buscarlos: una asignación solo toma libres
+// que nadie reservó (la asignación diferida reserva al agregar datos)
+namespace Allocator {
+
+    // Copia en memoria de un grupo de bloques
+    struct Group {
+        Bitmap::Bits inodes;
+        Bitmap::Bits blocks;
+        GroupDescriptor gd;
+        int nextInode = 0;      // Pista next-fit local al grupo
+        int nextBlock = 0;
+    };
+
+    struct State {
+        std::vector<std::unique_ptr<std::mutex>> groupLocks;   // Un candado por grupo
+        std::vector<Group> groups;
+        std::mutex superblockMutex;                            // Contadores globales
+        int freeInodes = 0;     // s_free_inodes_count
+        int freeBlocks = 0;     // s_free_blocks_count
+        int reservedBlocks = 0; // Libres ya prometidos (protegido por superblockMutex)
+        int firstIno = 0;       // s_first_ino
+        int firstBlo = 0;       // s_first_blo
+    };
+
+    inline std::map<std::string, std::shared_ptr<State>>& registry() {
+        static auto* states = new std::map<std::string, std::shared_ptr<State>>();
+        return *states;
+    }
+
+    inline std::mutex& registryMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    inline std::string key(const std::string& path, int partStart) {
+        return path + ":" + std::to_string(partStart);
+    }
+
+    // Cargar bitmaps, descriptores y contadores del sistema de archivos
+    inline std::shared_ptr<State> load(const std::string& path, const Superblock& sb) {
+        BufferCache::flush(path);   // Los bitmaps se leen directo del disco
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return nullptr;
+        }
+        auto state = std::make_shared<State>();
+        int groups = FileSystem::groupsCount(sb);
+        state->groups.resize(groups);
+        for (int g = 0; g < groups; g++) {
+            Group& group = state->groups[g];
+            group.inodes = Bitmap::readGroupInodes(file, sb, g);
+            group.blocks = Bitmap::readGroupBlocks(file, sb, g);
+            if (FileSystem::hasGroups(sb)) {
+                group.gd = FileSystem::readGroupDescriptor(file, sb, g);
+            }
+            state->groupLocks.push_back(std::make_unique<std::mutex>());
+        }
+        state->freeInodes = sb.s_free_inodes_count;
+        state->freeBlocks = sb.s_free_blocks_count;
+        state->firstIno = sb.s_first_ino;
+        state->firstBlo = sb.s_first_blo;
+
+        // Las pistas del Superbloque arrancan la búsqueda en su grupo
+        if (sb.s_first_ino >= 0 && sb.s_first_ino < sb.s_inodes_count) {
+            int g = FileSystem::inodeGroup(sb, sb.s_first_ino);
+            state->groups[g].nextInode = sb.s_first_ino - g * FileSystem::inodesPerGroup(sb);
+        }
+        if (sb.s_first_blo >= 0 && sb.s_first_blo < sb.s_blocks_count) {
+            int g = FileSystem::blockGroup(sb, sb.s_first_blo);
+            state->groups[g].nextBlock = sb.s_first_blo - g * FileSystem::blocksPerGroup(sb);
+        }
+        return state;
+    }
+
+    inline std::shared_ptr<State> getState(const std::string& path, int partStart, const Superblock& sb) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto& state = registry()[key(path, partStart)];
+        if (!state || static_cast<int>(state->groups.size()) != FileSystem::groupsCount(sb)) {
+            state = load(path, sb);
+        }
+        return state;
+    }
+
+    // Olvidar el estado (antes de volver a formatear la partición)
+    inline void discard(const std::string& path, int partStart) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().erase(key(path, partStart));
+    }
+
+    // Reservar hasta 'wanted' bloques libres que nadie haya reservado.
+    // Devuelve cuántos se reservaron (todos o ninguno si no es 'partial')
+    inline int reserveLocked(State& state, int wanted, bool partial) {
+        int available = std::max(0, state.freeBlocks - state.reservedBlocks);
+        int granted = partial ? std::min(wanted, available) : (available >= wanted ? wanted : 0);
+        state.reservedBlocks += granted;
+        return granted;
+    }
+
+    inline void unreserve(State& state, int count) {
+        std::lock_guard<std::mutex> lock(state.superblockMutex);
+        state.reservedBlocks -= count;
+    }
+
+    // Sumar 'inodesDelta' / 'blocksDelta' a los contadores de libres y mover las
+    // pistas. Solo se escriben esos campos, no el Superbloque completo. Los
+    // bloques asignados consumen su reserva
+    inline bool adjustSuperblock(const std::string& path, int partStart, const Superblock& sb,
+                                 State& state, int inodesDelta, int blocksDelta,
+                                 int firstIno, int firstBlo) {
+        std::lock_guard<std::mutex> lock(state.superblockMutex);
+        if (blocksDelta < 0) {
+            state.reservedBlocks += blocksDelta;
+        }
+        state.freeBlocks += blocksDelta;
+        state.freeInodes += inodesDelta;
+        int counters[2] = {state.freeBlocks, state.freeInodes};   // Campos contiguos
+        bool ok = Journal::writeMetadata(path, partStart, sb,
+                                         partStart + offsetof(Superblock, s_free_blocks_count),
+                                         counters, sizeof(counters));
+
+        if (firstIno >= 0 || firstBlo >= 0) {
+            if (firstIno >= 0) state.firstIno = firstIno;
+            if (firstBlo >= 0) state.firstBlo = firstBlo;
+            int hints[2] = {state.firstIno, state.firstBlo};      // Campos contiguos
+            ok = Journal::writeMetadata(path, partStart, sb,
+                                        partStart + offsetof(Superblock, s_first_ino),
+                                        hints, sizeof(hints)) && ok;
+        }
+        return ok;
+    }
+
+    // Actualizar el descriptor del grupo g (llamar con el candado del grupo tomado)
+    inline bool adjustGroupDescriptor(const std::string& path, int partStart, const Superblock& sb,
+                                      Group& group, int g, int inodesDelta, int blocksDelta, int dirsDelta) {
+        if (!FileSystem::hasGroups(sb)) {
+            return true;
+        }
+        group.gd.bg_free_inodes_count += inodesDelta;
+        group.gd.bg_free_blocks_count += blocksDelta;
+        group.gd.bg_used_dirs_count += dirsDelta;
+        return Journal::writeMetadata(path, partStart, sb, FileSystem::groupDescriptorOffset(sb, g),
+                                      &group.gd, sizeof(GroupDescriptor));
+    }
+
+    // Escribir solo el byte del bitmap que contiene el bit 'local'
+    inline bool writeBitmapByte(const std::string& path, int partStart, const Superblock& sb,
+                                const Bitmap::Bits& bits, long long bitmapStart, int local) {
+        char value = Bitmap::byteValue(bits, local, sb.s_rev_level);
+        return Journal::writeMetadata(path, partStart, sb,
+                                      bitmapStart + Bitmap::byteOffset(local, sb.s_rev_level), &value, 1);
+    }
+
+    // Escribir los bytes del bitmap que cubren los bits [first, last]
+    inline bool writeBitmapRange(const std::string& path, int partStart, const Superblock& sb,
+                                 const Bitmap::Bits& bits, long long bitmapStart, int first, int last) {
+        long long begin = Bitmap::byteOffset(first, sb.s_rev_level);
+        long long end = Bitmap::byteOffset(last, sb.s_rev_level);
+        std::vector<char> values(end - begin + 1);
+        for (int local = first; local <= last; local++) {
+            values[Bitmap::byteOffset(local, sb.s_rev_level) - begin] = Bitmap::byteValue(bits, local, sb.s_rev_level);
+        }
+        return Journal::writeMetadata(path, partStart, sb, bitmapStart + begin, values.data(), values.size());
+    }
+
+    // Reservar un inodo o bloque libre del grupo g, buscando desde la pista
+    // next-fit del grupo. Devuelve el número local o -1 si el grupo está lleno.
+    // 'nextFree' recibe el siguiente libre tras el asignado (nueva pista)
+    inline int allocateInGroup(const std::string& path, int partStart, const Superblock& sb,
+                               State& state, int g, bool inode, bool directory, int& nextFree) {
+        std::lock_guard<std::mutex> lock(*state.groupLocks[g]);
+        Group& group = state.groups[g];
+
+        // El descriptor permite saltar grupos llenos sin buscar en su bitmap
+        if (FileSystem::hasGroups(sb) &&
+            (inode ? group.gd.bg_free_inodes_count : group.gd.bg_free_blocks_count) <= 0) {
+            return -1;
+        }
+
+        Bitmap::Bits& bits = inode ? group.inodes : group.blocks;
+        int& hint = inode ? group.nextInode : group.nextBlock;
+        int local = bits.findFree(hint);
+        if (local == -1) {
+            return -1;
+        }
+        bits.set(local);
+        nextFree = bits.findFree(local + 1 < bits.count ? local + 1 : 0);
+        hint = nextFree == -1 ? 0 : nextFree;
+
+        long long bitmapStart = inode ? FileSystem::groupInodeBitmap(sb, g) : FileSystem::groupBlockBitmap(sb, g);
+        if (!writeBitmapByte(path, partStart, sb, bits, bitmapStart, local)) {
+            bits.clear(local);
+            return -1;
+        }
+        adjustGroupDescriptor(path, partStart, sb, group, g, inode ? -1 : 0, inode ? 0 : -1, directory ? 1 : 0);
+        return local;
+    }
+
+    // Reservar hasta 'wanted' bloques contiguos del grupo g. Si el bloque meta
+    // 'goal' (local, -1 si no hay) está libre, el tramo empieza ahí para seguir
+    // al anterior del archivo; si no, se toma el primer tramo de 'wanted' libres
+    // desde la pista o, si no hay, el más largo. Devuelve el primero y su largo
+    inline int allocateRunInGroup(const std::string& path, int partStart, const Superblock& sb,
+                                  State& state, int g, int goal, int wanted, int& count) {
+        std::lock_guard<std::mutex> lock(*state.groupLocks[g]);
+        Group& group = state.groups[g];
+        if (FileSystem::hasGroups(sb) && group.gd.bg_free_blocks_count <= 0) {
+            return -1;
+        }
+
+        Bitmap::Bits& bits = group.blocks;
+        int first = -1;
+        count = 0;
+        if (goal >= 0 && goal < bits.count && !bits.test(goal)) {
+            first = goal;
+            count = std::min(wanted, bits.findUsedFrom(goal) - goal);
+        } else {
+            int position = group.nextBlock;
+            bool wrapped = false;
+            while (count < wanted) {
+                int local = bits.findFreeFrom(position);
+                if (local == -1 || (wrapped && local >= group.nextBlock)) {
+                    if (wrapped || group.nextBlock == 0) {
+                        break;
+                    }
+                    wrapped = true;
+                    position = 0;
+                    continue;
+                }
+                int end = bits.findUsedFrom(local);
+                if (end - local > count) {
+                    first = local;
+                    count = std::min(wanted, end - local);
+                }
+                position = end;
+            }
+        }
+        if (first == -1) {
+            return -1;
+        }
+
+        for (int local = first; local < first + count; local++) {
+            bits.set(local);
+        }
+        int nextFree = bits.findFree(first + count < bits.count ? first + count : 0);
+        group.nextBlock = nextFree == -1 ? 0 : nextFree;
+        if (!writeBitmapRange(path, partStart, sb, bits, FileSystem::groupBlockBitmap(sb, g),
+                              first, first + count - 1)) {
+            for (int local = first; local < first + count; local++) {
+                bits.clear(local);
+            }
+            return -1;
+        }
+        adjustGroupDescriptor(path, partStart, sb, group, g, 0, -count, 0);
+        return first;
+    }
+
+    // Reservar hasta 'wanted' inodos de archivo del grupo g de una vez: el
+    // bitmap se escribe como un solo rango (y el descriptor una sola vez) en
+    // lugar de un byte por inodo. Agrega los números locales a 'out'
+    inline int allocateInodesInGroup(const std::string& path, int partStart, const Superblock& sb,
+                                     State& state, int g, int wanted, std::vector<int>& out) {
+        std::lock_guard<std::mutex> lock(*state.groupLocks[g]);
+        Group& group = state.groups[g];
+        if (FileSystem::hasGroups(sb) && group.gd.bg_free_inodes_count <= 0) {
+            return 0;
+        }
+
+        Bitmap::Bits& bits = group.inodes;
+        long long bitmapStart = FileSystem::groupInodeBitmap(sb, g);
+        int hint = group.nextInode;
+        int taken = 0;
+        int last = -1;
+        // Primero desde la pista hasta el final y luego desde el inicio hasta la pista
+        for (int pass = 0; pass < 2 && taken < wanted; pass++) {
+            if (pass == 1 && hint == 0) {
+                break;
+            }
+            int limit = pass == 0 ? bits.count : hint;
+            size_t begin = out.size();
+            int first = -1;
+            int local = bits.findFreeFrom(pass == 0 ? hint : 0);
+            while (local != -1 && local < limit && taken < wanted) {
+                bits.set(local);
+                out.push_back(local);
+                taken++;
+                if (first == -1) {
+                    first = local;
+                }
+                last = local;
+                local = bits.findFreeFrom(local + 1);
+            }
+            if (first != -1 && !writeBitmapRange(path, partStart, sb, bits, bitmapStart, first, last)) {
+                for (size_t k = begin; k < out.size(); k++) {
+                    bits.clear(out[k]);
+                }
+                taken -= static_cast<int>(out.size() - begin);
+                out.resize(begin);
+                break;
+            }
+        }
+        if (taken == 0) {
+            return 0;
+        }
+        int nextFree = bits.findFree(last + 1 < bits.count ? last + 1 : 0);
+        group.nextInode = nextFree == -1 ? 0 : nextFree;
+        adjustGroupDescriptor(path, partStart, sb, group, g, -taken, 0, 0);
+        return taken;
+    }
+
+    // Liberar un inodo o bloque en su grupo
+    inline bool freeInGroup(const std::string& path, int partStart, const Superblock& sb,
+                            State& state, int index, bool inode, bool directory) {
+        int g = inode ? FileSystem::inodeGroup(sb, index) : FileSystem::blockGroup(sb, index);
+        int perGroup = inode ? FileSystem::inodesPerGroup(sb) : FileSystem::blocksPerGroup(sb);
+        int local = index - g * perGroup;
+
+        std::lock_guard<std::mutex> lock(*state.groupLocks[g]);
+        Group& group = state.groups[g];
+        Bitmap::Bits& bits = inode ? group.inodes : group.blocks;
+        if (!bits.test(local)) {
+            return false;  // Ya estaba libre
+        }
+        bits.clear(local);
+
+        long long bitmapStart = inode ? FileSystem::groupInodeBitmap(sb, g) : FileSystem::groupBlockBitmap(sb, g);
+        writeBitmapByte(path, partStart, sb, bits, bitmapStart, local);
+        adjustGroupDescriptor(path, partStart, sb, group, g, inode ? 1 : 0, inode ? 0 : 1, directory ? -1 : 0);
+        return true;
+    }
+
+    // Asignar un inodo, empezando por el grupo de la carpeta padre
+    inline int allocateInode(const std::string& path, int partStart, const Superblock& sb,
+                             int parentInode, bool directory) {
+        auto state = getState(path, partStart, sb);
+        if (!state) {
+            return -1;
+        }
+        int groups = FileSystem::groupsCount(sb);
+        int perGroup = FileSystem::inodesPerGroup(sb);
+        int goal = parentInode >= 0 ? FileSystem::inodeGroup(sb, parentInode) : 0;
+
+        for (int k = 0; k < groups; k++) {
+            int g = (goal + k) % groups;
+            int nextFree = -1;
+            int local = allocateInGroup(path, partStart, sb, *state, g, true, directory, nextFree);
+            if (local != -1) {
+                int index = g * perGroup + local;
+                // La porción de la tabla de inodos puede seguir sin inicializar
+                ItableInit::ensureInodeReady(path, partStart, sb, index);
+                adjustSuperblock(path, partStart, sb, *state, -1, 0,
+                                 nextFree == -1 ? index : g * perGroup + nextFree, -1);
+                return index;
+            }
+        }
+        return -1;
+    }
+
+    // Asignar hasta 'wanted' inodos de archivo en lote, empezando por el grupo
+    // de la carpeta padre. Devuelve cuántos se asignaron (sus números en 'out')
+    inline int allocateInodes(const std::string& path, int partStart, const Superblock& sb,
+                              int parentInode, int wanted, std::vector<int>& out) {
+        auto state = getState(path, partStart, sb);
+        if (!state || wanted <= 0) {
+            return 0;
+        }
+        int groups = FileSystem::groupsCount(sb);
+        int perGroup = FileSystem::inodesPerGroup(sb);
+        int goal = parentInode >= 0 ? FileSystem::inodeGroup(sb, parentInode) : 0;
+        int taken = 0;
+
+        for (int k = 0; k < groups && taken < wanted; k++) {
+            int g = (goal + k) % groups;
+            std::vector<int> locals;
+            int got = allocateInodesInGroup(path, partStart, sb, *state, g, wanted - taken, locals);
+            for (int local : locals) {
+                int index = g * perGroup + local;
+                ItableInit::ensureInodeReady(path, partStart, sb, index);
+                out.push_back(index);
+            }
+            taken += got;
+        }
+        if (taken > 0) {
+            int next = out.back() + 1 < sb.s_inodes_count ? out.back() + 1 : 0;
+            adjustSuperblock(path, partStart, sb, *state, -taken, 0, next, -1);
+        }
+        return taken;
+    }
+
+    // Asignar un bloque, empezando por el grupo del inodo que lo va a usar
+    inline int allocateBlock(const std::string& path, int partStart, const Superblock& sb, int ownerInode) {
+        auto state = getState(path, partStart, sb);
+        if (!state) {
+            return -1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(state->superblockMutex);
+            if (reserveLocked(*state, 1, false) == 0) {
+                return -1;
+            }
+        }
+        int groups = FileSystem::groupsCount(sb);
+        int perGroup = FileSystem::blocksPerGroup(sb);
+        int goal = ownerInode >= 0 ? FileSystem::inodeGroup(sb, ownerInode) : 0;
+
+        for (int k = 0; k < groups; k++) {
+            int g = (goal + k) % groups;
+            int nextFree = -1;
+            int local = allocateInGroup(path, partStart, sb, *state, g, false, false, nextFree);
+            if (local != -1) {
+                int index = g * perGroup + local;
+                adjustSuperblock(path, partStart, sb, *state, 0, -1,
+                                 -1, nextFree == -1 ? index : g * perGroup + nextFree);
+                return index;
+            }
+        }
+        unreserve(*state, 1);
+        return -1;
+    }
+
+    // Asignar hasta 'wanted' bloques contiguos, empezando por el grupo del
+    // bloque meta 'goalBlock' (el siguiente al último del archivo, -1 si no
+    // hay) o del inodo dueño. Devuelve el primero; 'count' recibe el largo
+    inline int allocateRun(const std::string& path, int partStart, const Superblock& sb,
+                           int ownerInode, int goalBlock, int wanted, int& count) {
+        count = 0;
+        auto state = getState(path, partStart, sb);
+        if (!state || wanted <= 0) {
+            return -1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(state->superblockMutex);
+            wanted = reserveLocked(*state, wanted, true);
+        }
+        if (wanted == 0) {
+            return -1;
+        }
+        int groups = FileSystem::groupsCount(sb);
+        int perGroup = FileSystem::blocksPerGroup(sb);
+        bool hasGoal = goalBlock >= 0 && goalBlock < sb.s_blocks_count;
+        int goal = hasGoal ? FileSystem::blockGroup(sb, goalBlock)
+                           : (ownerInode >= 0 ? FileSystem::inodeGroup(sb, ownerInode) : 0);
+
+        for (int k = 0; k < groups; k++) {
+            int g = (goal + k) % groups;
+            int local = allocateRunInGroup(path, partStart, sb, *state, g,
+                                           k == 0 && hasGoal ? goalBlock - g * perGroup : -1, wanted, count);
+            if (local != -1) {
+                int index = g * perGroup + local;
+                adjustSuperblock(path, partStart, sb, *state, 0, -count, -1, index + count);
+                unreserve(*state, wanted - count);
+                return index;
+            }
+        }
+        unreserve(*state, wanted);
+        return -1;
+    }
+
+    // Reservar 'count' bloques para asignarlos después (todos o ninguno)
+    inline bool reserveBlocks(const std::string& path, int partStart, const Superblock& sb, int count) {
+        auto state = getState(path, partStart, sb);
+        if (!state) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(state->superblockMutex);
+        return reserveLocked(*state, count, false) == count;
+    }
+
+    // Devolver una reserva que no se va a usar
+    inline void releaseBlocks(const std::string& path, int partStart, const Superblock& sb, int count) {
+        auto state = getState(path, partStart, sb);
+        if (state && count > 0) {
+            unreserve(*state, count);
+        }
+    }
+
+    inline void freeInode(const std::string& path, int partStart, const Superblock& sb,
+                          int index, bool directory) {
+        auto state = getState(path, partStart, sb);
+        if (state && freeInGroup(path, partStart, sb, *state, index, true, directory)) {
+            adjustSuperblock(path, partStart, sb, *state, 1, 0, -1, -1);
+        }
+    }
+
+    inline void freeBlock(const std::string& path, int partStart, const Superblock& sb, int index) {
+        auto state = getState(path, partStart, sb);
+        if (state && freeInGroup(path, partStart, sb, *state, index, false, false)) {
+            adjustSuperblock(path, partStart, sb, *state, 0, 1, -1, -1);
+        }
+    }
+
+} // namespace Allocator
+
+#endif // ALLOCATOR_H
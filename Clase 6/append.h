@@ -0,0 +1,90 @@
+#ifndef APPEND_H
+#define APPEND_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <fstream>      // Lectura del archivo de contenido (-cont)
+#include "structures.h"
+#include "fileops.h"
+#include "delalloc.h"
+#include "mkfile.h"
+#include "mount.h"
+#include "users.h"
+
+namespace CommandAppend {
+
+    // Comando append: agregar al final de un archivo existente -size bytes
+    // generados o el contenido de un archivo del host (-cont). Los datos
+    // quedan en memoria (DelayedAlloc) y sus bloques se asignan juntos al
+    // volcar, así que muchas escrituras pequeñas terminan en un solo tramo
+    inline std::string execute(const std::string& id, const std::string& path, const std::string& sizeParam,
+                               const std::string& cont) {
+        if (id.empty()) {
+            return "Error: append requiere el parámetro -id";
+        }
+        if (path.empty()) {
+            return "Error: append requiere el parámetro -path";
+        }
+
+        std::string data;
+        if (!cont.empty()) {
+            std::string hostPath = CommandMount::expandPath(cont);
+            std::ifstream source(hostPath, std::ios::binary);
+            if (!source.is_open()) {
+                return "Error: no se pudo abrir el archivo de contenido '" + cont + "'";
+            }
+            std::ostringstream buffer;
+            buffer << source.rdbuf();
+            data = buffer.str();
+        } else if (!sizeParam.empty()) {
+            int size;
+            try {
+                size = std::stoi(sizeParam);
+            } catch (const std::exception& e) {
+                size = -1;
+            }
+            if (size < 0) {
+                return "Error: size debe ser un número entero no negativo";
+            }
+            data = CommandMkfile::generateContent(size);
+        } else {
+            return "Error: append requiere el parámetro -size o -cont";
+        }
+
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        int inodeIndex = FileOps::resolvePath(ctx, path, error);
+        if (inodeIndex == -1) {
+            return error;
+        }
+        Inode inode = FileOps::readInode(ctx, inodeIndex);
+        if (inode.i_type != '0') {
+            return "Error: '" + path + "' no es un archivo";
+        }
+        if (!Users::allowed(ctx, inode, 2)) {
+            return "Error: sin permiso de escritura sobre '" + path + "'";
+        }
+
+        error = DelayedAlloc::append(ctx, inodeIndex, inode, data);
+        if (!error.empty()) {
+            return error;
+        }
+        inode = FileOps::readInode(ctx, inodeIndex);
+        size_t pending = DelayedAlloc::pendingBytes(ctx, inodeIndex);
+
+        std::ostringstream result;
+        result << "\n=== APPEND ===\n";
+        result << data.size() << " bytes agregados a '" << path << "' (inodo " << inodeIndex << ")\n";
+        result << "  Tamaño: " << static_cast<long long>(inode.i_size) + static_cast<long long>(pending) << " bytes";
+        if (pending > 0) {
+            result << " (" << pending << " en memoria; sus bloques se asignan al volcar)";
+        }
+        return result.str();
+    }
+
+} // namespace CommandAppend
+
+#endif // APPEND_H
@@ -0,0 +1,171 @@
+#ifndef ATIME_H
+#define ATIME_H
+
+#include <string>       // Manejo de la clase std::string
+#include <map>          // Fechas pendientes por partición y por inodo
+#include <vector>       // Particiones a volcar
+#include <mutex>        // Acceso concurrente al registro
+#include <atomic>       // Contadores
+#include <ctime>        // Fecha de acceso
+#include "structures.h"
+#include "fileops.h"
+#include "allocator.h"
+#include "mount.h"
+
+// Fecha de último acceso (i_atime) de lo que se lee. Guardarla en cada lectura
+// convierte un cat o un reporte en escrituras de inodos, así que depende de la
+// opción de montaje: noatime no la toca, strictatime la escribe en cada
+// lectura y relatime (por omisión) solo la cambia si quedó antes de i_mtime o
+// tiene más de un día, y junta los cambios en memoria para escribirlos en
+// lotes (al llegar a BATCH inodos, en sync, a la salida o antes de un reporte)
+namespace Atime {
+
+    const size_t BATCH = 256;                   // Inodos pendientes por partición
+    const time_t RELATIME_AGE = 24 * 60 * 60;   // Antigüedad que obliga a actualizar
+
+    struct Stats {
+        std::atomic<long long> reads{0};        // Lecturas vistas
+        std::atomic<long long> skipped{0};      // Sin cambio (noatime o relatime al día)
+        std::atomic<long long> coalesced{0};    // Inodo que ya estaba pendiente
+        std::atomic<long long> written{0};      // Inodos escritos
+        std::atomic<long long> batches{0};      // Volcados de relatime
+    };
+
+    inline std::map<std::string, std::map<int, time_t>>& registry() {
+        static auto* pending = new std::map<std::string, std::map<int, time_t>>();
+        return *pending;
+    }
+
+    inline std::mutex& registryMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    inline Stats& stats() {
+        static auto* counters = new Stats();
+        return *counters;
+    }
+
+    // Escribir las fechas pendientes de la partición de 'ctx'. Devuelve los
+    // inodos escritos
+    inline int flush(FileOps::Context& ctx) {
+        std::map<int, time_t> pending;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            auto it = registry().find(Allocator::key(ctx.path, ctx.partStart));
+            if (it == registry().end()) {
+                return 0;
+            }
+            pending = std::move(it->second);
+            registry().erase(it);
+        }
+        int written = 0;
+        for (const auto& [index, when] : pending) {
+            Inode inode = FileOps::readInode(ctx, index);
+            if (inode.i_atime < when) {
+                inode.i_atime = when;
+                FileOps::writeInode(ctx, index, inode);
+                written++;
+            }
+        }
+        FileOps::finish(ctx);
+        stats().written += written;
+        stats().batches++;
+        return written;
+    }
+
+    // Volcar una partición sin contexto abierto (reportes)
+    inline int flush(const std::string& path, int partStart) {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            if (registry().find(Allocator::key(path, partStart)) == registry().end()) {
+                return 0;
+            }
+        }
+        FileOps::Context ctx;
+        ctx.path = path;
+        ctx.partStart = partStart;
+        if (!BufferCache::read(path, partStart, &ctx.sb, sizeof(Superblock)) ||
+            !FileSystem::acceptSuperblock(ctx.sb, partStart)) {
+            return 0;
+        }
+        return flush(ctx);
+    }
+
+    // Volcar todas las particiones (sync / salida)
+    inline void flushAll() {
+        std::vector<std::string> keys;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for (const auto& [key, pending] : registry()) {
+                keys.push_back(key);
+            }
+        }
+        for (const std::string& key : keys) {
+            size_t colon = key.rfind(':');
+            flush(key.substr(0, colon), std::stoi(key.substr(colon + 1)));
+        }
+    }
+
+    // Olvidar la fecha pendiente de un inodo que se elimina
+    inline void forget(const FileOps::Context& ctx, int index) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(Allocator::key(ctx.path, ctx.partStart));
+        if (it != registry().end()) {
+            it->second.erase(index);
+        }
+    }
+
+    // Olvidar lo pendiente (antes de volver a formatear la partición)
+    inline void discard(const std::string& path, int partStart) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().erase(Allocator::key(path, partStart));
+    }
+
+    // Se leyó el contenido del inodo 'index' (archivo o carpeta)
+    inline void touch(FileOps::Context& ctx, int index, const Inode& inode) {
+        stats().reads++;
+        time_t now = time(nullptr);
+        CommandMount::AtimeMode mode = CommandMount::atimeMode(ctx.path, ctx.partStart);
+        if (mode == CommandMount::AtimeMode::NoAtime || inode.i_atime >= now) {
+            stats().skipped++;
+            return;
+        }
+
+        if (mode == CommandMount::AtimeMode::StrictAtime) {
+            Inode updated = FileOps::readInode(ctx, index);
+            updated.i_atime = now;
+            FileOps::writeInode(ctx, index, updated);
+            FileOps::finish(ctx);
+            stats().written++;
+            return;
+        }
+
+        bool due;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            std::map<int, time_t>& pending = registry()[Allocator::key(ctx.path, ctx.partStart)];
+            auto it = pending.find(index);
+            if (it != pending.end()) {
+                // La fecha en memoria es la que cuenta para relatime
+                if (it->second < now && (inode.i_mtime >= it->second || now - it->second >= RELATIME_AGE)) {
+                    it->second = now;
+                }
+                stats().coalesced++;
+                return;
+            }
+            if (inode.i_atime > inode.i_mtime && now - inode.i_atime < RELATIME_AGE) {
+                stats().skipped++;
+                return;
+            }
+            pending[index] = now;
+            due = pending.size() >= BATCH;
+        }
+        if (due) {
+            flush(ctx);
+        }
+    }
+
+} // namespace Atime
+
+#endif // ATIME_H
@@ -0,0 +1,217 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <string>     // Manejo de la clase std::string
+#include <iostream>   // Flujos de entrada/salida
+#include <vector>     // Vectores dinámicos
+#include <cstdint>    // Enteros de ancho fijo (uint64_t)
+#include <cstring>    // memcpy
+#include "structures.h"
+#include "filesystem.h"
+
+namespace Bitmap {
+
+    // Bytes que ocupa en disco un bitmap de 'count' objetos según la revisión
+    //   rev 0: un byte ASCII '0'/'1' por objeto
+    //   rev 1: un bit por objeto (LSB primero dentro de cada byte)
+    inline int diskBytes(int count, int revLevel) {
+        if (revLevel >= FS_REV_PACKED_BITMAPS) {
+            return (count + 7) / 8;
+        }
+        return count;
+    }
+
+    // Bitmap en memoria: siempre empaquetado en palabras de 64 bits,
+    // sin importar el formato en disco
+    struct Bits {
+        std::vector<uint64_t> words;   // Bits agrupados de 64 en 64
+        int count;                     // Número de objetos representados
+
+        Bits() : count(0) {}
+
+        explicit Bits(int n) : words((n + 63) / 64, 0), count(n) {}
+
+        bool test(int i) const {
+            return (words[i >> 6] >> (i & 63)) & 1ULL;
+        }
+
+        void set(int i) {
+            words[i >> 6] |= (1ULL << (i & 63));
+        }
+
+        void clear(int i) {
+            words[i >> 6] &= ~(1ULL << (i & 63));
+        }
+
+        // Busca el primer bit libre en [from, count) revisando 64 objetos por
+        // iteración; las palabras llenas se saltan con una sola comparación
+        int findFreeFrom(int from) const {
+            if (from < 0) from = 0;
+            if (from >= count) return -1;
+
+            size_t w = from >> 6;
+            uint64_t free = ~words[w] & (~0ULL << (from & 63));
+            while (true) {
+                if (free != 0) {
+                    int index = static_cast<int>((w << 6) + __builtin_ctzll(free));
+                    return (index < count) ? index : -1;
+                }
+                if (++w >= words.size()) return -1;
+                free = ~words[w];
+            }
+        }
+
+        // Busca el primer bit usado en [from, count); 'count' si no hay ninguno
+        int findUsedFrom(int from) const {
+            if (from < 0) from = 0;
+            if (from >= count) return count;
+
+            size_t w = from >> 6;
+            uint64_t used = words[w] & (~0ULL << (from & 63));
+            while (true) {
+                if (used != 0) {
+                    int index = static_cast<int>((w << 6) + __builtin_ctzll(used));
+                    return (index < count) ? index : count;
+                }
+                if (++w >= words.size()) return count;
+                used = words[w];
+            }
+        }
+
+        // Next-fit: busca desde 'hint' y da la vuelta al inicio si es necesario
+        int findFree(int hint = 0) const {
+            int index = findFreeFrom(hint);
+            if (index == -1 && hint > 0) {
+                index = findFreeFrom(0);
+            }
+            return index;
+        }
+
+        // Número de objetos marcados como usados
+        int countUsed() const {
+            int used = 0;
+            for (uint64_t word : words) {
+                used += __builtin_popcountll(word);
+            }
+            return used;
+        }
+    };
+
+    // Leer un bitmap desde disco (acepta ambos formatos)
+    inline Bits read(std::istream& file, int offset, int count, int revLevel) {
+        Bits bits(count);
+        std::vector<char> raw(diskBytes(count, revLevel));
+        file.seekg(offset, std::ios::beg);
+        file.read(raw.data(), raw.size());
+
+        if (revLevel >= FS_REV_PACKED_BITMAPS) {
+            // Formato empaquetado: copia directa a las palabras (little-endian)
+            std::memcpy(bits.words.data(), raw.data(), raw.size());
+            if (count % 64 != 0) {
+                bits.words.back() &= (1ULL << (count % 64)) - 1;   // Ignorar bits de relleno
+            }
+        } else {
+            // Formato ASCII heredado: un byte por objeto
+            for (int i = 0; i < count; i++) {
+                if (raw[i] == '1') bits.set(i);
+            }
+        }
+        return bits;
+    }
+
+    // Bytes en disco de un bitmap en el formato de la revisión indicada
+    inline std::vector<char> encode(const Bits& bits, int revLevel) {
+        std::vector<char> raw(diskBytes(bits.count, revLevel));
+
+        if (revLevel >= FS_REV_PACKED_BITMAPS) {
+            std::memcpy(raw.data(), bits.words.data(), raw.size());
+        } else {
+            for (int i = 0; i < bits.count; i++) {
+                raw[i] = bits.test(i) ? '1' : '0';
+            }
+        }
+        return raw;
+    }
+
+    // Escribir un bitmap a disco en el formato de la revisión indicada
+    inline void write(std::ostream& file, int offset, const Bits& bits, int revLevel) {
+        std::vector<char> raw = encode(bits, revLevel);
+        file.seekp(offset, std::ios::beg);
+        file.write(raw.data(), raw.size());
+    }
+
+    // Byte en disco que contiene el bit 'index' (relativo al inicio del bitmap)
+    // y su valor actual, para escribir un solo byte al cambiar un bit
+    inline int byteOffset(int index, int revLevel) {
+        return (revLevel >= FS_REV_PACKED_BITMAPS) ? index / 8 : index;
+    }
+
+    inline char byteValue(const Bits& bits, int index, int revLevel) {
+        if (revLevel >= FS_REV_PACKED_BITMAPS) {
+            return static_cast<char>((bits.words[index >> 6] >> (((index >> 3) & 7) * 8)) & 0xFF);
+        }
+        return bits.test(index) ? '1' : '0';
+    }
+
+    // Bitmap de un grupo de bloques
+    inline Bits readGroupInodes(std::istream& file, const Superblock& sb, int g) {
+        return read(file, FileSystem::groupInodeBitmap(sb, g), FileSystem::inodesPerGroup(sb), sb.s_rev_level);
+    }
+
+    inline Bits readGroupBlocks(std::istream& file, const Superblock& sb, int g) {
+        return read(file, FileSystem::groupBlockBitmap(sb, g), FileSystem::blocksPerGroup(sb), sb.s_rev_level);
+    }
+
+    // Unir los bitmaps de todos los grupos en uno solo
+    inline Bits concat(const std::vector<Bits>& groups, int total) {
+        Bits all(total);
+        int base = 0;
+        for (const Bits& group : groups) {
+            for (int i = 0; i < group.count && base + i < total; i++) {
+                if (group.test(i)) all.set(base + i);
+            }
+            base += group.count;
+        }
+        return all;
+    }
+
+    // Bitmaps completos de un sistema de archivos formateado
+    inline Bits readInodes(std::istream& file, const Superblock& sb) {
+        if (!FileSystem::hasGroups(sb)) {
+            return read(file, sb.s_bm_inode_start, sb.s_inodes_count, sb.s_rev_level);
+        }
+        std::vector<Bits> groups;
+        for (int g = 0; g < sb.s_groups_count; g++) {
+            groups.push_back(readGroupInodes(file, sb, g));
+        }
+        return concat(groups, sb.s_inodes_count);
+    }
+
+    inline Bits readBlocks(std::istream& file, const Superblock& sb) {
+        if (!FileSystem::hasGroups(sb)) {
+            return read(file, sb.s_bm_block_start, sb.s_blocks_count, sb.s_rev_level);
+        }
+        std::vector<Bits> groups;
+        for (int g = 0; g < sb.s_groups_count; g++) {
+            groups.push_back(readGroupBlocks(file, sb, g));
+        }
+        return concat(groups, sb.s_blocks_count);
+    }
+
+    // Vista textual 0/1 del bitmap (para los reportes bm_inode / bm_block)
+    inline std::string render(const Bits& bits, int perLine) {
+        std::string text;
+        text.reserve(bits.count * 2 + bits.count / perLine + 1);
+        for (int i = 0; i < bits.count; i++) {
+            text += bits.test(i) ? '1' : '0';
+            text += ((i + 1) % perLine == 0) ? '\n' : ' ';
+        }
+        if (bits.count % perLine != 0 && !text.empty()) {
+            text.back() = '\n';
+        }
+        return text;
+    }
+
+} // namespace Bitmap
+
+#endif // BITMAP_H
@@ -0,0 +1,478 @@
+#ifndef BUFFER_CACHE_H
+#define BUFFER_CACHE_H
+
+#include <string>         // Manejo de la clase std::string
+#include <vector>         // Marcos y buffers
+#include <set>            // Lista de marcos sucios ordenada por posición
+#include <map>            // Registro de discos
+#include <unordered_map>  // Índice (disco, marco) -> posición en la caché
+#include <mutex>          // Exclusión entre hilos
+#include <algorithm>      // std::min / std::max
+#include <cstring>        // memcpy, memset
+#include <cstdint>        // uint64_t
+#include <fcntl.h>        // open
+#include <unistd.h>       // pread, close
+#include <sys/stat.h>     // fstat
+#include <sys/uio.h>      // pwritev
+
+// Caché de bloques entre el código del sistema de archivos y la imagen del
+// disco. El disco se divide en marcos de FRAME_SIZE bytes alineados; las
+// lecturas y escrituras de cualquier estructura (inodos, bitmaps, bloques,
+// campos del Superbloque) se hacen sobre los marcos en memoria. Los marcos
+// sucios se vuelcan ordenados por posición y los contiguos se unen en una sola
+// escritura, así que muchas escrituras pequeñas y dispersas terminan como
+// pocas escrituras secuenciales. El reemplazo usa el algoritmo del reloj.
+// El journal fija (pin) los marcos de su transacción abierta: no se vuelcan
+// ni se desalojan hasta que el registro de commit está en el disco
+namespace BufferCache {
+
+    const int FRAME_SIZE = 4096;          // Bytes por marco
+    const int FRAMES = 1024;              // Marcos en memoria (4 MB)
+    const int MAX_RUN_FRAMES = 64;        // Marcos por escritura unida (256 KB)
+    const int MAX_PINNED_FRAMES = FRAMES / 2;  // Con más, el journal confirma su transacción
+
+    // Imagen de disco abierta
+    struct Device {
+        std::string path;
+        int fd = -1;
+        long long size = 0;               // Tamaño del archivo de disco
+        std::set<long long> dirty;        // Marcos sucios (número de marco)
+    };
+
+    struct Frame {
+        int device = -1;                  // -1: marco libre
+        long long number = -1;            // Número de marco dentro del disco
+        int length = 0;                   // Bytes válidos (el último marco puede ser parcial)
+        std::vector<char> data;
+        bool dirty = false;
+        bool referenced = false;          // Bit de referencia del reloj
+        int pins = 0;                     // Registros de transacciones abiertas sobre el marco
+    };
+
+    struct Cache {
+        std::mutex mutex;
+        std::vector<Frame> frames;
+        std::vector<Device> devices;                       // Nunca se borran
+        std::map<std::string, int> deviceIds;
+        std::unordered_map<uint64_t, int> index;           // (disco, marco) -> posición
+        int hand = 0;                                      // Manecilla del reloj
+        int pinned = 0;                                    // Marcos con pins > 0
+
+        // Estadísticas
+        long long hits = 0;
+        long long misses = 0;
+        long long evictions = 0;
+        long long flushes = 0;
+        long long writes = 0;             // Escrituras al disco (una por tramo unido)
+        long long framesWritten = 0;
+        long long overflows = 0;          // Marcos agregados porque todos estaban fijados
+
+        Cache() : frames(FRAMES) {}
+    };
+
+    inline Cache& cache() {
+        static auto* instance = new Cache();
+        return *instance;
+    }
+
+    inline uint64_t frameKey(int device, long long number) {
+        return (static_cast<uint64_t>(device) << 40) | static_cast<uint64_t>(number);
+    }
+
+    // Abrir (o reutilizar) un disco; -1 si no se puede abrir
+    inline int deviceLocked(Cache& c, const std::string& path) {
+        auto it = c.deviceIds.find(path);
+        if (it != c.deviceIds.end() && c.devices[it->second].fd >= 0) {
+            return it->second;
+        }
+        Device device;
+        device.path = path;
+        device.fd = open(path.c_str(), O_RDWR);
+        if (device.fd < 0) {
+            return -1;
+        }
+        struct stat info;
+        device.size = fstat(device.fd, &info) == 0 ? info.st_size : 0;
+        if (it != c.deviceIds.end()) {
+            c.devices[it->second] = device;
+            return it->second;
+        }
+        c.devices.push_back(device);
+        c.deviceIds[path] = static_cast<int>(c.devices.size()) - 1;
+        return c.deviceIds[path];
+    }
+
+    // Volcar los marcos sucios de un disco en orden, uniendo los contiguos. Los
+    // marcos fijados por una transacción abierta siguen sucios en memoria,
+    // salvo los de 'release' (checkpoint de esa transacción)
+    inline bool flushDeviceLocked(Cache& c, int id, const std::set<long long>* release = nullptr) {
+        Device& device = c.devices[id];
+        if (device.dirty.empty()) {
+            return true;
+        }
+        bool ok = true;
+        std::vector<struct iovec> run;
+        long long runStart = -1;
+        long long previous = -2;
+        size_t runBytes = 0;
+
+        auto writeRun = [&]() {
+            if (run.empty()) return;
+            ssize_t written = pwritev(device.fd, run.data(), static_cast<int>(run.size()),
+                                      runStart * FRAME_SIZE);
+            ok = ok && written == static_cast<ssize_t>(runBytes);
+            c.writes++;
+            run.clear();
+            runBytes = 0;
+        };
+
+        std::set<long long> held;
+        for (long long number : device.dirty) {
+            auto found = c.index.find(frameKey(id, number));
+            if (found == c.index.end()) {
+                continue;
+            }
+            Frame& frame = c.frames[found->second];
+            if (frame.pins > 0 && !(release && release->count(number))) {
+                held.insert(number);
+                continue;
+            }
+            if (number != previous + 1 || static_cast<int>(run.size()) >= MAX_RUN_FRAMES) {
+                writeRun();
+                runStart = number;
+            }
+            run.push_back({frame.data.data(), static_cast<size_t>(frame.length)});
+            runBytes += frame.length;
+            frame.dirty = false;
+            c.framesWritten++;
+            previous = number;
+        }
+        writeRun();
+        device.dirty.swap(held);
+        c.flushes++;
+        return ok;
+    }
+
+    // Escribir un solo marco sucio a su posición en el disco
+    inline bool writeFrameLocked(Cache& c, Frame& frame) {
+        Device& device = c.devices[frame.device];
+        bool ok = pwrite(device.fd, frame.data.data(), frame.length, frame.number * FRAME_SIZE) == frame.length;
+        device.dirty.erase(frame.number);
+        frame.dirty = false;
+        c.writes++;
+        c.framesWritten++;
+        return ok;
+    }
+
+    // Elegir un marco con el reloj: se salta (y limpia) los marcos referenciados
+    // y nunca toma uno fijado. Si en dos vueltas todos estaban fijados, la caché
+    // crece un marco en vez de escribir metadatos sin commit
+    inline int victimLocked(Cache& c) {
+        size_t steps = 0;
+        while (steps++ < 2 * c.frames.size()) {
+            int position = c.hand;
+            c.hand = (c.hand + 1) % static_cast<int>(c.frames.size());
+            Frame& frame = c.frames[position];
+            if (frame.device == -1) {
+                return position;
+            }
+            if (frame.pins > 0) {
+                continue;
+            }
+            if (frame.referenced) {
+                frame.referenced = false;
+                continue;
+            }
+            // Solo se escribe el marco desalojado; el resto espera al volcado
+            if (frame.dirty) {
+                writeFrameLocked(c, frame);
+            }
+            c.index.erase(frameKey(frame.device, frame.number));
+            frame.device = -1;
+            c.evictions++;
+            return position;
+        }
+        c.frames.emplace_back();
+        c.overflows++;
+        return static_cast<int>(c.frames.size()) - 1;
+    }
+
+    // Marco 'number' del disco 'id', cargándolo del disco si no está en memoria
+    inline Frame& frameLocked(Cache& c, int id, long long number) {
+        auto found = c.index.find(frameKey(id, number));
+        if (found != c.index.end()) {
+            Frame& frame = c.frames[found->second];
+            frame.referenced = true;
+            c.hits++;
+            return frame;
+        }
+
+        c.misses++;
+        int position = victimLocked(c);
+        Frame& frame = c.frames[position];
+        Device& device = c.devices[id];
+        long long offset = number * FRAME_SIZE;
+        frame.device = id;
+        frame.number = number;
+        frame.length = static_cast<int>(std::max(0LL, std::min<long long>(FRAME_SIZE, device.size - offset)));
+        frame.data.assign(FRAME_SIZE, 0);
+        frame.dirty = false;
+        frame.referenced = true;
+        frame.pins = 0;
+        if (frame.length > 0) {
+            pread(device.fd, frame.data.data(), frame.length, offset);
+        }
+        c.index[frameKey(id, number)] = position;
+        return frame;
+    }
+
+    // Leer 'length' bytes desde 'offset' (de la caché o del disco)
+    inline bool read(const std::string& path, long long offset, void* out, size_t length) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        int id = deviceLocked(c, path);
+        if (id < 0 || offset < 0 || offset + static_cast<long long>(length) > c.devices[id].size) {
+            return false;
+        }
+        char* target = static_cast<char*>(out);
+        while (length > 0) {
+            Frame& frame = frameLocked(c, id, offset / FRAME_SIZE);
+            int within = static_cast<int>(offset % FRAME_SIZE);
+            size_t chunk = std::min(length, static_cast<size_t>(FRAME_SIZE - within));
+            std::memcpy(target, frame.data.data() + within, chunk);
+            target += chunk;
+            offset += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+
+    // Escribir 'length' bytes en 'offset'; quedan en memoria hasta el volcado
+    inline bool write(const std::string& path, long long offset, const void* data, size_t length) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        int id = deviceLocked(c, path);
+        if (id < 0 || offset < 0 || offset + static_cast<long long>(length) > c.devices[id].size) {
+            return false;
+        }
+        const char* source = static_cast<const char*>(data);
+        while (length > 0) {
+            long long number = offset / FRAME_SIZE;
+            Frame& frame = frameLocked(c, id, number);
+            int within = static_cast<int>(offset % FRAME_SIZE);
+            size_t chunk = std::min(length, static_cast<size_t>(FRAME_SIZE - within));
+            std::memcpy(frame.data.data() + within, source, chunk);
+            frame.dirty = true;
+            c.devices[id].dirty.insert(number);
+            source += chunk;
+            offset += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+
+    // Fijar los marcos de [offset, offset + length) (cargándolos si hace falta)
+    // antes de escribir en ellos un registro del journal
+    inline bool pin(const std::string& path, long long offset, size_t length) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        int id = deviceLocked(c, path);
+        if (id < 0 || offset < 0 || offset + static_cast<long long>(length) > c.devices[id].size) {
+            return false;
+        }
+        long long end = offset + static_cast<long long>(length);
+        for (long long number = offset / FRAME_SIZE; number * FRAME_SIZE < end; number++) {
+            Frame& frame = frameLocked(c, id, number);
+            if (frame.pins++ == 0) {
+                c.pinned++;
+            }
+        }
+        return true;
+    }
+
+    // Soltar los marcos de un registro cuyo commit ya es durable (o que se descarta)
+    inline void unpin(const std::string& path, long long offset, size_t length) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto it = c.deviceIds.find(path);
+        if (it == c.deviceIds.end()) {
+            return;
+        }
+        long long end = offset + static_cast<long long>(length);
+        for (long long number = offset / FRAME_SIZE; number * FRAME_SIZE < end; number++) {
+            auto found = c.index.find(frameKey(it->second, number));
+            if (found == c.index.end()) {
+                continue;
+            }
+            Frame& frame = c.frames[found->second];
+            if (frame.pins > 0 && --frame.pins == 0) {
+                c.pinned--;
+            }
+        }
+    }
+
+    // Contenido de un registro del journal antes de la transacción abierta
+    struct Image {
+        long long offset;
+        const std::vector<char>* before;
+    };
+
+    // Checkpoint con una transacción abierta: sus marcos se escriben con el
+    // contenido previo a la transacción ('open', en orden de registro) y luego
+    // vuelven en memoria a su estado actual, sucios y fijados
+    inline bool checkpoint(const std::string& path, const std::vector<Image>& open) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto it = c.deviceIds.find(path);
+        if (it == c.deviceIds.end()) {
+            return true;
+        }
+        int id = it->second;
+
+        auto copyRange = [&](long long offset, char* out, const char* in, size_t length) {
+            while (length > 0) {
+                Frame& frame = frameLocked(c, id, offset / FRAME_SIZE);
+                int within = static_cast<int>(offset % FRAME_SIZE);
+                size_t chunk = std::min(length, static_cast<size_t>(FRAME_SIZE - within));
+                if (out) {
+                    std::memcpy(out, frame.data.data() + within, chunk);
+                    out += chunk;
+                } else {
+                    std::memcpy(frame.data.data() + within, in, chunk);
+                    in += chunk;
+                    frame.dirty = true;
+                    c.devices[id].dirty.insert(frame.number);
+                }
+                offset += chunk;
+                length -= chunk;
+            }
+        };
+
+        std::vector<std::vector<char>> current(open.size());
+        std::set<long long> release;
+        for (size_t i = 0; i < open.size(); i++) {
+            current[i].resize(open[i].before->size());
+            copyRange(open[i].offset, current[i].data(), nullptr, current[i].size());
+            long long end = open[i].offset + static_cast<long long>(current[i].size());
+            for (long long number = open[i].offset / FRAME_SIZE; number * FRAME_SIZE < end; number++) {
+                release.insert(number);
+            }
+        }
+        // Al revés: el primer registro sobre un byte guarda su valor más antiguo
+        for (size_t i = open.size(); i-- > 0;) {
+            copyRange(open[i].offset, nullptr, open[i].before->data(), open[i].before->size());
+        }
+        bool ok = flushDeviceLocked(c, id, &release);
+        for (size_t i = 0; i < open.size(); i++) {
+            copyRange(open[i].offset, nullptr, current[i].data(), current[i].size());
+        }
+        return ok;
+    }
+
+    // Marcos fijados por transacciones abiertas
+    inline int pinnedFrames() {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        return c.pinned;
+    }
+
+    // Poner a cero un rango en los marcos que ya estén en memoria, sin cargar
+    // los demás (para quien escribe ceros directamente al disco)
+    inline void zeroCached(const std::string& path, long long offset, long long length) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto it = c.deviceIds.find(path);
+        if (it == c.deviceIds.end() || length <= 0) {
+            return;
+        }
+        long long end = offset + length;
+        for (long long number = offset / FRAME_SIZE; number * FRAME_SIZE < end; number++) {
+            auto found = c.index.find(frameKey(it->second, number));
+            if (found == c.index.end()) {
+                continue;
+            }
+            long long frameStart = number * FRAME_SIZE;
+            long long from = std::max(offset, frameStart);
+            long long to = std::min(end, frameStart + FRAME_SIZE);
+            std::memset(c.frames[found->second].data.data() + (from - frameStart), 0, to - from);
+        }
+    }
+
+    // Volcar los marcos sucios de un disco
+    inline bool flush(const std::string& path) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto it = c.deviceIds.find(path);
+        if (it == c.deviceIds.end()) {
+            return true;
+        }
+        return flushDeviceLocked(c, it->second);
+    }
+
+    inline bool flushAll() {
+        bool ok = true;
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        for (size_t id = 0; id < c.devices.size(); id++) {
+            if (c.devices[id].fd >= 0) {
+                ok = flushDeviceLocked(c, static_cast<int>(id)) && ok;
+            }
+        }
+        return ok;
+    }
+
+    // Volcar el disco y olvidar los marcos de [begin, end), por ejemplo antes de
+    // que mkfs escriba la partición directamente
+    inline void invalidate(const std::string& path, long long begin, long long end) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto it = c.deviceIds.find(path);
+        if (it == c.deviceIds.end()) {
+            return;
+        }
+        int id = it->second;
+        flushDeviceLocked(c, id);
+        for (Frame& frame : c.frames) {
+            if (frame.device == id && frame.number * FRAME_SIZE < end &&
+                (frame.number + 1) * FRAME_SIZE > begin) {
+                c.index.erase(frameKey(id, frame.number));
+                c.devices[id].dirty.erase(frame.number);
+                c.pinned -= frame.pins > 0;
+                frame.pins = 0;
+                frame.device = -1;
+            }
+        }
+        // El tamaño del disco puede haber cambiado (por ejemplo tras mkdisk)
+        struct stat info;
+        if (fstat(c.devices[id].fd, &info) == 0) {
+            c.devices[id].size = info.st_size;
+        }
+    }
+
+    // Olvidar un disco sin volcarlo (rmdisk, o mkdisk que lo vuelve a crear)
+    inline void forget(const std::string& path) {
+        Cache& c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto it = c.deviceIds.find(path);
+        if (it == c.deviceIds.end()) {
+            return;
+        }
+        int id = it->second;
+        for (Frame& frame : c.frames) {
+            if (frame.device == id) {
+                c.index.erase(frameKey(id, frame.number));
+                c.pinned -= frame.pins > 0;
+                frame.pins = 0;
+                frame.device = -1;
+            }
+        }
+        c.devices[id].dirty.clear();
+        if (c.devices[id].fd >= 0) {
+            close(c.devices[id].fd);
+            c.devices[id].fd = -1;
+        }
+    }
+
+} // namespace BufferCache
+
+#endif // BUFFER_CACHE_H
@@ -0,0 +1,96 @@
+#ifndef CAT_H
+#define CAT_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <iostream>     // Salida del contenido
+#include <iomanip>      // Formato de los números
+#include <vector>       // Lista de archivos
+#include "structures.h"
+#include "fileops.h"
+#include "file_stream.h"
+#include "delalloc.h"
+#include "users.h"
+#include "atime.h"
+
+namespace CommandCat {
+
+    // Comando cat: mostrar el contenido de uno o más archivos (-file1, -file2,
+    // ...). El contenido se escribe en 'out' a medida que se lee del disco, sin
+    // cargar el archivo completo; el resultado solo trae el resumen
+    inline std::string execute(const std::string& id, const std::vector<std::string>& files,
+                               std::ostream& out = std::cout) {
+        if (id.empty()) {
+            return "Error: cat requiere el parámetro -id";
+        }
+        if (files.empty()) {
+            return "Error: cat requiere al menos el parámetro -file1";
+        }
+
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        // Lo agregado con asignación diferida se vuelca antes de leer
+        error = DelayedAlloc::flush(ctx).error;
+        if (!error.empty()) {
+            return error;
+        }
+
+        // Validar todos los archivos antes de escribir nada
+        std::vector<int> indices;
+        std::vector<Inode> inodes;
+        for (const std::string& file : files) {
+            int index = FileOps::resolvePath(ctx, file, error);
+            if (index == -1) {
+                return error;
+            }
+            Inode inode = FileOps::readInode(ctx, index);
+            if (inode.i_type != '0') {
+                return "Error: '" + file + "' no es un archivo";
+            }
+            if (!Users::allowed(ctx, inode, 4)) {
+                return "Error: sin permiso de lectura sobre '" + file + "'";
+            }
+            indices.push_back(index);
+            inodes.push_back(inode);
+        }
+
+        FileStream::Result total;
+        FileStream::Sink sink = [&](const char* data, size_t size) {
+            out.write(data, static_cast<std::streamsize>(size));
+            return static_cast<bool>(out);
+        };
+        out << "\n=== CAT ===\n";
+        for (size_t k = 0; k < inodes.size(); k++) {
+            if (k > 0) {
+                out << "\n";
+            }
+            FileStream::Result part = FileStream::read(ctx, inodes[k], sink);
+            total.bytes += part.bytes;
+            total.reads += part.reads;
+            total.runs += part.runs;
+            total.seconds += part.seconds;
+            if (!part.error.empty()) {
+                out.flush();
+                return part.error + " ('" + files[k] + "')";
+            }
+            Atime::touch(ctx, indices[k], inodes[k]);
+        }
+        out.flush();
+
+        std::ostringstream result;
+        double megabytes = total.bytes / (1024.0 * 1024.0);
+        result << "\n[" << inodes.size() << " archivo(s), " << total.bytes << " bytes en "
+               << total.runs << " tramo(s) y " << total.reads << " lectura(s)";
+        if (total.seconds > 0) {
+            result << ", " << std::fixed << std::setprecision(1) << megabytes / total.seconds << " MB/s";
+        }
+        result << "]";
+        return result.str();
+    }
+
+} // namespace CommandCat
+
+#endif // CAT_H
@@ -0,0 +1,284 @@
+#ifndef COPY_H
+#define COPY_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <vector>       // Entradas de una carpeta
+#include <utility>      // std::pair
+#include <algorithm>    // std::min
+#include "structures.h"
+#include "filesystem.h"
+#include "fileops.h"
+#include "allocator.h"
+#include "refcount.h"
+#include "delalloc.h"
+#include "users.h"
+
+namespace CommandCopy {
+
+    struct Stats {
+        int files = 0;
+        int folders = 0;
+        int reflinked = 0;          // Archivos que comparten sus bloques con el original
+        long long sharedBlocks = 0; // Bloques de datos compartidos en vez de copiados
+    };
+
+    // Copia completa: cada tramo de datos se lee y se escribe en bloques
+    // nuevos; los huecos de un archivo disperso siguen siendo huecos
+    inline std::string copyContent(FileOps::Context& ctx, int child, Inode& inode, const Inode& source) {
+        int blockSize = ctx.sb.s_block_size;
+        long long blocks = (static_cast<long long>(source.i_size) + blockSize - 1) / blockSize;
+        std::string error;
+        int goal = -1;
+        FileOps::forEachRun(ctx, source, blocks, [&](long long logical, int physical, int count) {
+            for (int done = 0; physical != -1 && done < count; ) {
+                int run = 0;
+                int first = Allocator::allocateRun(ctx.path, ctx.partStart, ctx.sb, child, goal, count - done, run);
+                if (first == -1) {
+                    error = "Error: no hay bloques libres";
+                    return false;
+                }
+                std::vector<char> data(static_cast<size_t>(run) * blockSize);
+                BufferCache::read(ctx.path, FileSystem::blockOffset(ctx.sb, physical + done), data.data(), data.size());
+                BufferCache::write(ctx.path, FileSystem::blockOffset(ctx.sb, first), data.data(), data.size());
+                if (!FileOps::mapRun(ctx, child, inode, logical + done, first, run)) {
+                    // Lo que sí quedó asociado se libera con el archivo
+                    for (int k = 0; k < run; k++) {
+                        if (FileOps::blockAt(ctx, inode, logical + done + k) != first + k) {
+                            Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, first + k);
+                        }
+                    }
+                    inode.i_size = static_cast<int>(std::min<long long>(source.i_size,
+                                                                        (logical + done + run) * blockSize));
+                    error = "Error: no hay bloques libres";
+                    return false;
+                }
+                done += run;
+                goal = first + run;
+                inode.i_size = static_cast<int>(std::min<long long>(source.i_size, (logical + done) * blockSize));
+            }
+            return true;
+        });
+        if (error.empty()) {
+            inode.i_size = source.i_size;
+        }
+        return error;
+    }
+
+    // Reflink: el inodo nuevo apunta a los mismos bloques de datos, que suman
+    // una referencia; solo se reservan sus propios bloques de apuntadores o
+    // nodos de extents. Devuelve false si algún bloque no admite otra referencia
+    inline bool reflinkContent(FileOps::Context& ctx, int child, Inode& inode, const Inode& source, Stats& stats) {
+        long long blocks = (static_cast<long long>(source.i_size) + ctx.sb.s_block_size - 1) / ctx.sb.s_block_size;
+        long long shared = 0;
+        bool ok = FileOps::forEachRun(ctx, source, blocks, [&](long long logical, int physical, int count) {
+            if (physical == -1) {
+                return true;    // Hueco: sigue sin bloques
+            }
+            if (!Refcount::share(ctx.path, ctx.partStart, ctx.sb, physical, count)) {
+                return false;
+            }
+            if (!FileOps::mapRun(ctx, child, inode, logical, physical, count)) {
+                // El tramo no quedó en el inodo: su referencia se quita aquí
+                Refcount::release(ctx.path, ctx.partStart, ctx.sb, physical, count);
+                return false;
+            }
+            // releaseData recorre hasta i_size: debe cubrir lo ya compartido
+            long long end = (logical + count) * ctx.sb.s_block_size;
+            inode.i_size = static_cast<int>(std::min<long long>(source.i_size, end));
+            shared += count;
+            return true;
+        });
+        if (!ok) {
+            // Deshacer: las referencias sumadas se quitan y el inodo queda vacío
+            FileOps::releaseData(ctx, inode);
+            return false;
+        }
+        inode.i_size = source.i_size;
+        stats.sharedBlocks += shared;
+        return true;
+    }
+
+    // Copiar el archivo 'source' como 'name' dentro de la carpeta 'dirIndex'
+    inline std::string copyFile(FileOps::Context& ctx, const Inode& source, int dirIndex, Inode& dir,
+                                const std::string& name, Stats& stats) {
+        int child = Allocator::allocateInode(ctx.path, ctx.partStart, ctx.sb, dirIndex, false);
+        if (child == -1) {
+            return "Error: no hay inodos libres";
+        }
+        Inode inode = FileOps::newInode('0');
+        inode.i_uid = source.i_uid;
+        inode.i_gid = source.i_gid;
+        inode.i_perm = source.i_perm;
+
+        std::string error;
+        if (FileSystem::hasInlineData(source)) {
+            // Los datos en línea se copian con el inodo
+            FileSystem::writeInlineData(inode, FileSystem::readInlineData(source));
+        } else {
+            // Mismo formato que el original para poder compartir sus tramos
+            if (Extents::usesExtents(source)) {
+                Extents::initRoot(inode);
+            }
+            if (Refcount::enabled(ctx.sb) && reflinkContent(ctx, child, inode, source, stats)) {
+                stats.reflinked++;
+            } else {
+                error = copyContent(ctx, child, inode, source);
+            }
+        }
+        FileOps::writeInode(ctx, child, inode);
+        if (error.empty()) {
+            error = FileOps::addEntry(ctx, dirIndex, dir, name, child);
+        }
+        if (!error.empty()) {
+            FileOps::releaseData(ctx, inode);
+            FileOps::writeInode(ctx, child, inode);
+            Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, child, false);
+            return error;
+        }
+        stats.files++;
+        return "";
+    }
+
+    // Copiar la carpeta 'sourceIndex' (y todo su contenido) como 'name' dentro de 'dirIndex'
+    inline std::string copyFolder(FileOps::Context& ctx, int sourceIndex, int dirIndex, Inode& dir,
+                                  const std::string& name, Stats& stats) {
+        std::string error;
+        int folder = FileOps::createDirectory(ctx, dirIndex, dir, name, error);
+        FileOps::finish(ctx);
+        if (folder == -1) {
+            return error;
+        }
+        stats.folders++;
+
+        // Entradas del original antes de empezar a crear
+        Inode source = FileOps::readInode(ctx, sourceIndex);
+        std::vector<std::pair<int, std::string>> entries;
+        int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+        for (long long logical = 0; ; logical++) {
+            int b = FileOps::blockAt(ctx, source, logical);
+            if (b < 0) {
+                break;
+            }
+            FileSystem::Block block = FileOps::readBlock(ctx, b);
+            for (int k = 0; k < perBlock; k++) {
+                const Content& entry = block.contents()[k];
+                std::string entryName = FileOps::entryName(entry);
+                if (entry.b_inodo >= 0 && entryName != "." && entryName != "..") {
+                    entries.push_back({entry.b_inodo, entryName});
+                }
+            }
+        }
+
+        Inode copy = FileOps::readInode(ctx, folder);
+        for (const auto& [index, entryName] : entries) {
+            Inode inode = FileOps::readInode(ctx, index);
+            if (inode.i_type == '1') {
+                error = copyFolder(ctx, index, folder, copy, entryName, stats);
+                copy = FileOps::readInode(ctx, folder);
+            } else {
+                error = copyFile(ctx, inode, folder, copy, entryName, stats);
+                FileOps::finish(ctx);
+            }
+            if (!error.empty()) {
+                return error;
+            }
+        }
+        return "";
+    }
+
+    // ¿Es 'dirIndex' la carpeta 'ancestor' o está dentro de ella?
+    inline bool isInside(FileOps::Context& ctx, int dirIndex, int ancestor) {
+        for (int current = dirIndex, guard = 0; guard < ctx.sb.s_inodes_count; guard++) {
+            if (current == ancestor) {
+                return true;
+            }
+            if (current == 0) {
+                return false;
+            }
+            current = FileOps::lookup(ctx, current, FileOps::readInode(ctx, current), "..");
+            if (current == -1) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Comando copy: copiar el archivo o la carpeta -path dentro de la carpeta
+    // -destino. Con FS_FEATURE_REFLINK (mkfs -reflink=1) los archivos copiados
+    // comparten los bloques de datos del original hasta que uno de los dos se
+    // reescribe; sin ella se copia el contenido
+    inline std::string execute(const std::string& id, const std::string& path, const std::string& destino) {
+        if (id.empty()) {
+            return "Error: copy requiere el parámetro -id";
+        }
+        if (path.empty() || destino.empty()) {
+            return "Error: copy requiere los parámetros -path y -destino";
+        }
+
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        // El original se copia con lo que tenga pendiente
+        error = DelayedAlloc::flush(ctx).error;
+        if (!error.empty()) {
+            return error;
+        }
+        int sourceIndex = FileOps::resolvePath(ctx, path, error);
+        if (sourceIndex == -1) {
+            return error;
+        }
+        if (sourceIndex == 0) {
+            return "Error: no se puede copiar la carpeta raíz";
+        }
+        int destIndex = FileOps::resolvePath(ctx, destino, error);
+        if (destIndex == -1) {
+            return error;
+        }
+        Inode dest = FileOps::readInode(ctx, destIndex);
+        if (dest.i_type != '1') {
+            return "Error: '" + destino + "' no es una carpeta";
+        }
+        if (!Users::allowed(ctx, dest, 2)) {
+            return "Error: sin permiso de escritura sobre '" + destino + "'";
+        }
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        if (FileOps::lookup(ctx, destIndex, dest, name) != -1) {
+            return "Error: ya existe '" + name + "' en la carpeta destino";
+        }
+
+        auto state = Allocator::getState(ctx.path, ctx.partStart, ctx.sb);
+        int freeBefore = state ? state->freeBlocks : 0;
+        Stats stats;
+        Inode source = FileOps::readInode(ctx, sourceIndex);
+        if (source.i_type == '1') {
+            if (isInside(ctx, destIndex, sourceIndex)) {
+                return "Error: no se puede copiar una carpeta dentro de sí misma";
+            }
+            error = copyFolder(ctx, sourceIndex, destIndex, dest, name, stats);
+        } else {
+            error = copyFile(ctx, source, destIndex, dest, name, stats);
+            FileOps::finish(ctx);
+        }
+        int usedBlocks = state ? freeBefore - state->freeBlocks : 0;
+
+        std::ostringstream result;
+        result << "\n=== COPY ===\n";
+        if (!error.empty()) {
+            result << error << "\n";
+        }
+        result << "'" << path << "' copiado en '" << destino << "'\n";
+        result << "  Archivos: " << stats.files << " (" << stats.reflinked << " con bloques compartidos)\n";
+        if (stats.folders > 0) {
+            result << "  Carpetas: " << stats.folders << "\n";
+        }
+        result << "  Bloques compartidos: " << stats.sharedBlocks << "\n";
+        result << "  Bloques nuevos: " << usedBlocks;
+        return result.str();
+    }
+
+} // namespace CommandCopy
+
+#endif // COPY_H
@@ -0,0 +1,338 @@
+#ifndef DELALLOC_H
+#define DELALLOC_H
+
+#include <string>       // Manejo de la clase std::string
+#include <map>          // Datos pendientes por partición y por inodo
+#include <mutex>        // Acceso concurrente al registro
+#include <vector>       // Buffer de un tramo
+#include <cstring>      // memcpy
+#include <climits>      // INT_MAX
+#include <ctime>        // Fecha de modificación
+#include <algorithm>    // std::min
+#include "structures.h"
+#include "filesystem.h"
+#include "allocator.h"
+#include "buffer_cache.h"
+#include "refcount.h"
+#include "fileops.h"
+
+// Asignación diferida de bloques. Lo que se agrega al final de un archivo se
+// acumula en memoria por inodo y los bloques se piden recién al volcar (sync,
+// salida, un comando que lee el archivo o al pasar MAX_PENDING): todo lo
+// pendiente de un archivo sale como un solo tramo contiguo, con una escritura
+// del bitmap y un ajuste de contadores del Superbloque, en vez de un bloque
+// por cada escritura pequeña. Al agregar se reservan en el asignador los
+// bloques que el volcado puede necesitar; si no alcanzan, append falla en
+// ese momento en lugar de perder los datos después
+namespace DelayedAlloc {
+
+    const size_t MAX_PENDING = 8 * 1024 * 1024;     // Bytes en memoria por partición
+
+    // Datos pendientes de una partición
+    struct Pending {
+        std::map<int, std::string> files;   // Inodo -> bytes a agregar al final
+        std::map<int, int> reserved;        // Inodo -> bloques reservados
+        size_t bytes = 0;
+    };
+
+    // Resultado de un volcado
+    struct Result {
+        int files = 0;
+        long long bytes = 0;
+        int runs = 0;               // Tramos pedidos al asignador
+        long long blocks = 0;       // Bloques nuevos
+        std::string error;
+    };
+
+    inline std::map<std::string, Pending>& registry() {
+        static auto* pending = new std::map<std::string, Pending>();
+        return *pending;
+    }
+
+    inline std::mutex& registryMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    // Bytes pendientes del inodo (el tamaño lógico es i_size más esto)
+    inline size_t pendingBytes(const FileOps::Context& ctx, int inodeIndex) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(Allocator::key(ctx.path, ctx.partStart));
+        if (it == registry().end()) {
+            return 0;
+        }
+        auto file = it->second.files.find(inodeIndex);
+        return file == it->second.files.end() ? 0 : file->second.size();
+    }
+
+    // Cota de los bloques que necesita volcar 'pending' bytes al final del
+    // inodo: los de datos (todo el archivo si se reescribe, por estar en
+    // línea o compartir su último bloque) más los de apuntadores o del árbol
+    inline int blocksNeeded(FileOps::Context& ctx, const Inode& inode, long long pending) {
+        long long blockSize = ctx.sb.s_block_size;
+        long long size = inode.i_size;
+        long long end = size + pending;
+        long long data = (end + blockSize - 1) / blockSize - size / blockSize;
+        if (FileSystem::hasInlineData(inode)) {
+            data = end <= FileSystem::inlineCapacity() ? 0 : (end + blockSize - 1) / blockSize;
+        } else if (size % blockSize > 0 && Refcount::enabled(ctx.sb)) {
+            int last = FileOps::blockAt(ctx, inode, size / blockSize);
+            if (last != -1 && Refcount::extra(ctx.path, ctx.sb, last) > 0) {
+                data = (end + blockSize - 1) / blockSize;
+            }
+        }
+        if (data <= 0) {
+            return 0;
+        }
+        long long per = std::max(1, std::min(FileSystem::pointersPerBlock(ctx.sb), Extents::blockCapacity(ctx.sb)));
+        return static_cast<int>(std::min<long long>(INT_MAX, data + (data + per - 1) / per + 3));
+    }
+
+    // Agregar 'data' al final del contenido del inodo. Devuelve un error o ""
+    inline std::string flushFile(FileOps::Context& ctx, int inodeIndex, const std::string& data, Result& result) {
+        Inode inode = FileOps::readInode(ctx, inodeIndex);
+        int blockSize = ctx.sb.s_block_size;
+        long long size = inode.i_size;
+        result.files++;
+        if (!FileOps::fitsInInode(ctx.sb, inode, size + static_cast<long long>(data.size()))) {
+            return "Error: el archivo supera el tamaño máximo que admite un inodo";
+        }
+
+        // En línea: el contenido completo se vuelve a escribir (writeFileData
+        // lo pasa a bloques si deja de caber)
+        if (FileSystem::hasInlineData(inode)) {
+            std::string error = FileOps::writeFileData(ctx, inodeIndex, inode, FileSystem::readInlineData(inode) + data);
+            result.bytes += error.empty() ? static_cast<long long>(data.size()) : 0;
+            return error;
+        }
+
+        // El último bloque incompleto se completa en su lugar; si es
+        // compartido por un reflink, el archivo se reescribe (copy-on-write)
+        std::string tail = data;
+        long long logical = size / blockSize;
+        int offset = static_cast<int>(size % blockSize);
+        if (offset > 0) {
+            int last = FileOps::blockAt(ctx, inode, logical);
+            if (last != -1 && Refcount::enabled(ctx.sb) && Refcount::extra(ctx.path, ctx.sb, last) > 0) {
+                std::string error = FileOps::writeFileData(ctx, inodeIndex, inode,
+                                                           FileOps::readFileData(ctx, inode) + data);
+                result.bytes += error.empty() ? static_cast<long long>(data.size()) : 0;
+                return error;
+            }
+            if (last != -1) {
+                size_t fill = std::min(data.size(), static_cast<size_t>(blockSize - offset));
+                BufferCache::write(ctx.path, FileSystem::blockOffset(ctx.sb, last) + offset, data.data(), fill);
+                tail = data.substr(fill);
+                size += fill;
+                logical++;
+            } else {
+                // El bloque es un hueco: el tramo nuevo empieza con sus ceros
+                tail = std::string(offset, '\0') + data;
+            }
+        }
+
+        long long start = logical * blockSize;      // Byte donde empieza 'tail'
+        long long count = (static_cast<long long>(tail.size()) + blockSize - 1) / blockSize;
+        std::string error;
+        int goal = logical > 0 ? FileOps::blockAt(ctx, inode, logical - 1) : -1;
+        goal = goal == -1 ? -1 : goal + 1;
+
+        for (long long done = 0; done < count; ) {
+            int run = 0;
+            int first = Allocator::allocateRun(ctx.path, ctx.partStart, ctx.sb, inodeIndex, goal,
+                                               static_cast<int>(count - done), run);
+            if (first == -1) {
+                error = "Error: no hay bloques libres";
+                break;
+            }
+            size_t from = static_cast<size_t>(done * blockSize);
+            size_t length = std::min(static_cast<size_t>(run) * blockSize, tail.size() - from);
+            std::vector<char> buffer(static_cast<size_t>(run) * blockSize, 0);
+            std::memcpy(buffer.data(), tail.data() + from, length);
+            BufferCache::write(ctx.path, FileSystem::blockOffset(ctx.sb, first), buffer.data(), buffer.size());
+            int mapped = 0;
+            if (Extents::usesExtents(inode)) {
+                mapped = FileOps::mapExtent(ctx, inodeIndex, inode, logical + done, first, run) ? run : 0;
+            } else {
+                while (mapped < run &&
+                       FileOps::mapBlock(ctx, inodeIndex, inode, logical + done + mapped, first + mapped)) {
+                    mapped++;
+                }
+            }
+            // Lo asociado entra en i_size (para liberarse con el archivo); el
+            // resto del tramo se devuelve
+            size_t written = std::min(length, static_cast<size_t>(mapped) * blockSize);
+            size = std::max(size, start + static_cast<long long>(from + written));
+            result.blocks += mapped;
+            if (mapped < run) {
+                for (int k = mapped; k < run; k++) {
+                    Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, first + k);
+                }
+                error = "Error: no hay bloques libres";
+                break;
+            }
+            result.runs++;
+            done += run;
+            goal = first + run;
+        }
+        result.bytes += size - inode.i_size;
+        inode.i_size = static_cast<int>(size);
+        inode.i_mtime = time(nullptr);
+        FileOps::writeInode(ctx, inodeIndex, inode);
+        return error;
+    }
+
+    // Volcar todo lo pendiente de la partición de 'ctx'. La reserva de cada
+    // archivo se devuelve justo antes de asignar sus bloques. Lo que no se
+    // pudo escribir vuelve a quedar pendiente (delante de lo que se haya
+    // agregado mientras tanto) y el error se devuelve
+    inline Result flush(FileOps::Context& ctx) {
+        Pending pending;
+        std::string key = Allocator::key(ctx.path, ctx.partStart);
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            auto it = registry().find(key);
+            if (it == registry().end()) {
+                return Result();
+            }
+            pending = std::move(it->second);
+            registry().erase(it);
+        }
+        Result result;
+        for (const auto& [inodeIndex, data] : pending.files) {
+            Allocator::releaseBlocks(ctx.path, ctx.partStart, ctx.sb, pending.reserved[inodeIndex]);
+            long long before = result.bytes;
+            std::string error = flushFile(ctx, inodeIndex, data, result);
+            if (error.empty()) {
+                continue;
+            }
+            size_t written = static_cast<size_t>(std::min<long long>(result.bytes - before,
+                                                                     static_cast<long long>(data.size())));
+            std::string remainder = data.substr(written);
+            if (!remainder.empty()) {
+                // Vuelve a la cola con su reserva, calculada sobre el inodo actual
+                Inode current = FileOps::readInode(ctx, inodeIndex);
+                std::lock_guard<std::mutex> lock(registryMutex());
+                Pending& requeued = registry()[key];
+                std::string& buffer = requeued.files[inodeIndex];
+                buffer = remainder + buffer;
+                requeued.bytes += remainder.size();
+                int needed = blocksNeeded(ctx, current, static_cast<long long>(buffer.size()));
+                int& reserved = requeued.reserved[inodeIndex];
+                if (needed > reserved &&
+                    Allocator::reserveBlocks(ctx.path, ctx.partStart, ctx.sb, needed - reserved)) {
+                    reserved = needed;
+                }
+                error += " (" + std::to_string(remainder.size()) + " bytes del inodo " +
+                         std::to_string(inodeIndex) + " siguen en memoria)";
+            }
+            if (result.error.empty()) {
+                result.error = error;
+            }
+        }
+        FileOps::finish(ctx);
+        return result;
+    }
+
+    // Volcar lo pendiente de una partición sin contexto abierto (reportes)
+    inline Result flush(const std::string& path, int partStart) {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            if (registry().find(Allocator::key(path, partStart)) == registry().end()) {
+                return Result();
+            }
+        }
+        FileOps::Context ctx;
+        ctx.path = path;
+        ctx.partStart = partStart;
+        if (!BufferCache::read(path, partStart, &ctx.sb, sizeof(Superblock)) ||
+            !FileSystem::acceptSuperblock(ctx.sb, partStart)) {
+            return Result();
+        }
+        return flush(ctx);
+    }
+
+    // Volcar todas las particiones (sync / salida). Devuelve el primer error
+    inline std::string flushAll() {
+        std::vector<std::string> keys;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for (const auto& [key, pending] : registry()) {
+                keys.push_back(key);
+            }
+        }
+        std::string error;
+        for (const std::string& key : keys) {
+            size_t colon = key.rfind(':');
+            Result result = flush(key.substr(0, colon), std::stoi(key.substr(colon + 1)));
+            if (error.empty() && !result.error.empty()) {
+                error = result.error;
+            }
+        }
+        return error;
+    }
+
+    // Agregar 'data' al final del archivo 'inodeIndex' sin asignar bloques,
+    // reservando los que necesitará. Devuelve un error si no alcanzan o el
+    // del volcado si la partición pasó de MAX_PENDING
+    inline std::string append(FileOps::Context& ctx, int inodeIndex, const Inode& inode, const std::string& data) {
+        bool due;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            Pending& pending = registry()[Allocator::key(ctx.path, ctx.partStart)];
+            std::string& buffer = pending.files[inodeIndex];
+            int& reserved = pending.reserved[inodeIndex];
+            auto reject = [&](const std::string& error) {
+                if (buffer.empty()) {
+                    pending.files.erase(inodeIndex);
+                    pending.reserved.erase(inodeIndex);
+                }
+                return error;
+            };
+            // El mismo límite que aplica el volcado (flushFile)
+            if (!FileOps::fitsInInode(ctx.sb, inode,
+                                      static_cast<long long>(inode.i_size) + buffer.size() + data.size())) {
+                return reject("Error: el archivo supera el tamaño máximo que admite un inodo");
+            }
+            int needed = blocksNeeded(ctx, inode, static_cast<long long>(buffer.size() + data.size()));
+            if (needed > reserved) {
+                if (!Allocator::reserveBlocks(ctx.path, ctx.partStart, ctx.sb, needed - reserved)) {
+                    return reject("Error: no hay bloques libres para agregar " + std::to_string(data.size()) + " bytes");
+                }
+                reserved = needed;
+            }
+            buffer += data;
+            pending.bytes += data.size();
+            due = pending.bytes >= MAX_PENDING;
+        }
+        return due ? flush(ctx).error : "";
+    }
+
+    // Olvidar lo pendiente de un archivo que se elimina
+    inline void drop(const FileOps::Context& ctx, int inodeIndex) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(Allocator::key(ctx.path, ctx.partStart));
+        if (it == registry().end()) {
+            return;
+        }
+        auto file = it->second.files.find(inodeIndex);
+        if (file != it->second.files.end()) {
+            it->second.bytes -= file->second.size();
+            it->second.files.erase(file);
+        }
+        auto reserved = it->second.reserved.find(inodeIndex);
+        if (reserved != it->second.reserved.end()) {
+            Allocator::releaseBlocks(ctx.path, ctx.partStart, ctx.sb, reserved->second);
+            it->second.reserved.erase(reserved);
+        }
+    }
+
+    // Olvidar lo pendiente (antes de volver a formatear la partición)
+    inline void discard(const std::string& path, int partStart) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().erase(Allocator::key(path, partStart));
+    }
+
+} // namespace DelayedAlloc
+
+#endif // DELALLOC_H
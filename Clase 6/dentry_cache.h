@@ -0,0 +1,168 @@
+#ifndef DENTRY_CACHE_H
+#define DENTRY_CACHE_H
+
+#include <string>         // Manejo de la clase std::string
+#include <list>           // Orden LRU de cada fragmento
+#include <unordered_map>  // Índice (montaje, carpeta, nombre) -> entrada
+#include <mutex>          // Un candado por fragmento
+#include <atomic>         // Contadores de aciertos y fallos
+#include <functional>     // std::hash
+
+// Caché de entradas de carpeta para resolver rutas: (montaje, inodo de la
+// carpeta, nombre) -> inodo. También guarda entradas negativas (el nombre no
+// existe), así que buscar un nombre ausente no vuelve a recorrer los bloques
+// de la carpeta. Quien crea, borra o renombra una entrada debe actualizarla
+// aquí con insert() / invalidate()
+namespace DentryCache {
+
+    const int SHARDS = 16;                 // Fragmentos independientes
+    const size_t CAPACITY = 16384;         // Entradas en memoria en total
+    const size_t SHARD_CAPACITY = CAPACITY / SHARDS;
+
+    // Inodo de una entrada negativa
+    const int NEGATIVE = -1;
+
+    struct Key {
+        std::string mount;                  // path:partStart
+        int parent;
+        std::string name;
+
+        bool operator==(const Key& other) const {
+            return parent == other.parent && name == other.name && mount == other.mount;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t hash = std::hash<std::string>()(key.mount);
+            hash = hash * 31 + std::hash<int>()(key.parent);
+            return hash * 31 + std::hash<std::string>()(key.name);
+        }
+    };
+
+    struct Entry {
+        Key key;
+        int inode;                          // NEGATIVE si el nombre no existe
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;               // Más reciente al frente
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    };
+
+    struct Stats {
+        std::atomic<long long> hits{0};
+        std::atomic<long long> negativeHits{0};
+        std::atomic<long long> misses{0};
+        std::atomic<long long> invalidations{0};
+    };
+
+    inline Shard* shards() {
+        static auto* all = new Shard[SHARDS];
+        return all;
+    }
+
+    inline Stats& stats() {
+        static auto* counters = new Stats();
+        return *counters;
+    }
+
+    inline std::string key(const std::string& path, int partStart) {
+        return path + ":" + std::to_string(partStart);
+    }
+
+    inline Shard& shardFor(const Key& k) {
+        return shards()[KeyHash()(k) % SHARDS];
+    }
+
+    // Buscar una entrada. Devuelve true si está en la caché; 'inode' recibe el
+    // inodo o NEGATIVE si se sabe que el nombre no existe
+    inline bool lookup(const std::string& path, int partStart, int parent,
+                       const std::string& name, int& inode) {
+        Key k{key(path, partStart), parent, name};
+        Shard& shard = shardFor(k);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(k);
+        if (it == shard.index.end()) {
+            stats().misses++;
+            return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        inode = it->second->inode;
+        if (inode == NEGATIVE) {
+            stats().negativeHits++;
+        } else {
+            stats().hits++;
+        }
+        return true;
+    }
+
+    // Guardar el resultado de una búsqueda (o una entrada recién creada)
+    inline void insert(const std::string& path, int partStart, int parent,
+                       const std::string& name, int inode) {
+        Key k{key(path, partStart), parent, name};
+        Shard& shard = shardFor(k);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(k);
+        if (it != shard.index.end()) {
+            it->second->inode = inode;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+        shard.lru.push_front(Entry{k, inode});
+        shard.index[k] = shard.lru.begin();
+        while (shard.lru.size() > SHARD_CAPACITY) {
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+        }
+    }
+
+    // Olvidar una entrada (al borrar o renombrar)
+    inline void invalidate(const std::string& path, int partStart, int parent, const std::string& name) {
+        Key k{key(path, partStart), parent, name};
+        Shard& shard = shardFor(k);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(k);
+        if (it != shard.index.end()) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            stats().invalidations++;
+        }
+    }
+
+    // Olvidar todas las entradas del sistema de archivos (antes de formatearlo
+    // o de que fsck lo repare); al borrar se invalida entrada por entrada
+    inline void invalidateAll(const std::string& path, int partStart) {
+        std::string mount = key(path, partStart);
+        for (int s = 0; s < SHARDS; s++) {
+            Shard& shard = shards()[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.lru.begin(); it != shard.lru.end();) {
+                if (it->key.mount == mount) {
+                    shard.index.erase(it->key);
+                    it = shard.lru.erase(it);
+                    stats().invalidations++;
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    // Entradas en memoria (positivas y negativas)
+    inline void usage(size_t& positive, size_t& negative) {
+        positive = 0;
+        negative = 0;
+        for (int s = 0; s < SHARDS; s++) {
+            Shard& shard = shards()[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const Entry& entry : shard.lru) {
+                if (entry.inode == NEGATIVE) negative++; else positive++;
+            }
+        }
+    }
+
+} // namespace DentryCache
+
+#endif // DENTRY_CACHE_H
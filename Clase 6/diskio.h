@@ -0,0 +1,91 @@
+#ifndef DISKIO_H
+#define DISKIO_H
+
+#include <string>     // Manejo de la clase std::string
+#include <vector>     // Vectores dinámicos
+#include <thread>     // Hilos para escrituras en paralelo
+#include <atomic>     // Banderas compartidas entre hilos
+#include <algorithm>  // std::min / std::max
+#include <fcntl.h>    // open, fallocate
+#include <unistd.h>   // pwrite, close
+
+namespace DiskIO {
+
+    // Tamaño de cada escritura de ceros (1 MB)
+    const long long ZERO_CHUNK = 1024 * 1024;
+
+    // Método usado para poner a cero un rango
+    enum class ZeroMethod { None, PunchHole, ParallelWrite, Failed };
+
+    inline std::string methodName(ZeroMethod method) {
+        switch (method) {
+            case ZeroMethod::PunchHole:     return "punch hole (archivo disperso)";
+            case ZeroMethod::ParallelWrite: return "escritura paralela";
+            case ZeroMethod::Failed:        return "error";
+            default:                        return "ninguno";
+        }
+    }
+
+    // Escribir ceros en [offset, offset + length) con varios hilos; cada hilo
+    // toma un rango disjunto y lo escribe en bloques grandes con pwrite
+    inline bool parallelZero(int fd, long long offset, long long length) {
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        long long chunks = (length + ZERO_CHUNK - 1) / ZERO_CHUNK;
+        threads = static_cast<unsigned>(std::min<long long>(threads, std::max(1LL, chunks)));
+
+        long long perThread = ((chunks + threads - 1) / threads) * ZERO_CHUNK;
+        std::atomic<bool> ok(true);
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 0; t < threads; t++) {
+            long long begin = offset + t * perThread;
+            long long end = std::min(offset + length, begin + perThread);
+            if (begin >= end) break;
+
+            workers.emplace_back([fd, begin, end, &ok]() {
+                std::vector<char> zeros(ZERO_CHUNK, 0);
+                for (long long pos = begin; pos < end && ok; pos += ZERO_CHUNK) {
+                    size_t len = static_cast<size_t>(std::min(ZERO_CHUNK, end - pos));
+                    if (pwrite(fd, zeros.data(), len, pos) != static_cast<ssize_t>(len)) {
+                        ok = false;
+                    }
+                }
+            });
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return ok;
+    }
+
+    // Poner a cero un rango del disco. Si el sistema de archivos del host
+    // soporta archivos dispersos se liberan los bloques (punch hole), de lo
+    // contrario se escriben ceros en paralelo
+    inline ZeroMethod zeroRange(const std::string& path, long long offset, long long length) {
+        if (length <= 0) {
+            return ZeroMethod::None;
+        }
+
+        int fd = open(path.c_str(), O_WRONLY);
+        if (fd < 0) {
+            return ZeroMethod::Failed;
+        }
+
+        ZeroMethod method = ZeroMethod::Failed;
+#ifdef FALLOC_FL_PUNCH_HOLE
+        if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length) == 0) {
+            method = ZeroMethod::PunchHole;
+        }
+#endif
+        if (method == ZeroMethod::Failed && parallelZero(fd, offset, length)) {
+            method = ZeroMethod::ParallelWrite;
+        }
+
+        close(fd);
+        return method;
+    }
+
+} // namespace DiskIO
+
+#endif // DISKIO_H
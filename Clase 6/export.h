@@ -0,0 +1,335 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <string>               // Manejo de la clase std::string
+#include <sstream>              // Construcción del mensaje de resultado
+#include <fstream>              // Archivo tar de salida
+#include <iomanip>              // Formato de los números
+#include <vector>               // Pila del recorrido
+#include <deque>                // Cola entre el recorrido y la escritura
+#include <thread>               // Hilo del recorrido
+#include <mutex>                // Candado de la cola
+#include <condition_variable>   // Espera con la cola llena o vacía
+#include <chrono>               // Medición del tiempo
+#include <cstring>              // memset, memcpy
+#include <fcntl.h>              // open, posix_fadvise
+#include <unistd.h>             // close
+#include "structures.h"
+#include "filesystem.h"
+#include "fileops.h"
+#include "file_stream.h"
+#include "delalloc.h"
+#include "mount.h"
+
+// Exportación del árbol de una partición a un archivo tar (formato POSIX
+// ustar). Un hilo recorre las carpetas y deja los inodos en una cola acotada
+// mientras el hilo principal escribe cabeceras y contenido; al encolar un
+// archivo se pide al sistema operativo su primer tramo, así que su lectura ya
+// está en curso cuando le toca. La memoria queda acotada por la cola y el
+// buffer de FileStream, sin importar el tamaño del árbol
+namespace CommandExport {
+
+    const int TAR_BLOCK = 512;
+    const size_t QUEUE_CAPACITY = 256;      // Entradas encoladas por adelantado
+
+    // Entrada del árbol lista para escribirse
+    struct Item {
+        std::string name;       // Ruta dentro del tar (las carpetas terminan en '/')
+        Inode inode;
+    };
+
+    // Cola acotada entre el hilo del recorrido y el de escritura
+    struct Queue {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<Item> items;
+        bool done = false;          // El recorrido terminó
+        bool cancelled = false;     // La escritura falló; el recorrido debe parar
+    };
+
+    struct Stats {
+        int files = 0;
+        int folders = 0;
+        int skipped = 0;            // Rutas que no caben en una cabecera ustar
+        long long bytes = 0;
+    };
+
+    // Permisos del inodo (dígitos octales guardados como 664) para el tar; las
+    // carpetas reciben permiso de ejecución donde tienen de lectura
+    inline int tarMode(const Inode& inode) {
+        int mode = 0;
+        for (int perm = inode.i_perm, shift = 0; shift < 9; perm /= 10, shift += 3) {
+            int digit = perm % 10 & 7;
+            if (inode.i_type == '1' && (digit & 4)) {
+                digit |= 1;
+            }
+            mode |= digit << shift;
+        }
+        return mode;
+    }
+
+    // Separar la ruta en los campos prefix (155) y name (100) de ustar
+    inline bool splitName(const std::string& path, std::string& prefix, std::string& name) {
+        if (path.size() <= 100) {
+            prefix.clear();
+            name = path;
+            return true;
+        }
+        size_t cut = path.rfind('/', std::min<size_t>(path.size() - 1, 155));
+        while (cut != std::string::npos && cut > 0) {
+            if (path.size() - cut - 1 <= 100) {
+                prefix = path.substr(0, cut);
+                name = path.substr(cut + 1);
+                return true;
+            }
+            cut = path.rfind('/', cut - 1);
+        }
+        return false;
+    }
+
+    // Campo numérico en octal rellenado con ceros y terminado en '\0'
+    inline void writeOctal(char* field, int width, unsigned long long value) {
+        for (int k = width - 2; k >= 0; k--) {
+            field[k] = static_cast<char>('0' + (value & 7));
+            value >>= 3;
+        }
+        field[width - 1] = '\0';
+    }
+
+    // Cabecera ustar de una entrada. Devuelve false si la ruta no cabe
+    inline bool buildHeader(const Item& item, long long size, char* header) {
+        std::string prefix, name;
+        if (!splitName(item.name, prefix, name)) {
+            return false;
+        }
+        std::memset(header, 0, TAR_BLOCK);
+        std::memcpy(header, name.data(), name.size());
+        writeOctal(header + 100, 8, tarMode(item.inode));
+        writeOctal(header + 108, 8, item.inode.i_uid < 0 ? 0 : item.inode.i_uid);
+        writeOctal(header + 116, 8, item.inode.i_gid < 0 ? 0 : item.inode.i_gid);
+        writeOctal(header + 124, 12, size);
+        writeOctal(header + 136, 12, item.inode.i_mtime);
+        header[156] = item.inode.i_type == '1' ? '5' : '0';
+        std::memcpy(header + 257, "ustar", 6);
+        std::memcpy(header + 263, "00", 2);
+        std::memcpy(header + 345, prefix.data(), prefix.size());
+
+        // La suma se calcula con el campo del checksum lleno de espacios
+        std::memset(header + 148, ' ', 8);
+        unsigned int sum = 0;
+        for (int k = 0; k < TAR_BLOCK; k++) {
+            sum += static_cast<unsigned char>(header[k]);
+        }
+        writeOctal(header + 148, 7, sum);
+        header[155] = ' ';
+        return true;
+    }
+
+    // Recorrer el árbol desde 'rootIndex' (hilo productor). Las carpetas se
+    // leen bloque por bloque y cada entrada se encola apenas se encuentra
+    inline void walkTree(FileOps::Context ctx, int rootIndex, std::string rootName, Queue& queue) {
+        int fd = ::open(ctx.path.c_str(), O_RDONLY);
+        auto push = [&](Item item) {
+            // Pedir por adelantado el primer tramo del archivo
+            if (fd >= 0 && item.inode.i_type == '0' && !FileSystem::hasInlineData(item.inode)) {
+                FileOps::forEachRun(ctx, item.inode, 1, [&](long long, int physical, int) {
+                    if (physical != -1) {
+                        posix_fadvise(fd, FileSystem::blockOffset(ctx.sb, physical),
+                                      FileStream::READAHEAD_MIN, POSIX_FADV_WILLNEED);
+                    }
+                    return false;
+                });
+            }
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.changed.wait(lock, [&]() { return queue.items.size() < QUEUE_CAPACITY || queue.cancelled; });
+            if (queue.cancelled) {
+                return false;
+            }
+            queue.items.push_back(std::move(item));
+            queue.changed.notify_all();
+            return true;
+        };
+
+        // Pila de carpetas pendientes (inodo, ruta dentro del tar)
+        std::vector<std::pair<int, std::string>> pending;
+        Inode root = FileOps::readInode(ctx, rootIndex);
+        if (root.i_type == '1') {
+            pending.push_back({rootIndex, rootName});
+        } else {
+            push({rootName, root});
+        }
+        bool ok = true;
+        int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+        while (ok && !pending.empty()) {
+            auto [dirIndex, prefix] = pending.back();
+            pending.pop_back();
+            Inode dir = FileOps::readInode(ctx, dirIndex);
+            std::vector<std::pair<int, std::string>> children;
+            for (long long logical = 0; ok; logical++) {
+                int b = FileOps::blockAt(ctx, dir, logical);
+                if (b < 0) {
+                    break;
+                }
+                FileSystem::Block block = FileOps::readBlock(ctx, b);
+                for (int k = 0; k < perBlock && ok; k++) {
+                    const Content& entry = block.contents()[k];
+                    if (entry.b_inodo < 0) {
+                        continue;
+                    }
+                    std::string name = FileOps::entryName(entry);
+                    if (name == "." || name == "..") {
+                        continue;
+                    }
+                    Inode inode = FileOps::readInode(ctx, entry.b_inodo);
+                    std::string path = prefix + name;
+                    if (inode.i_type == '1') {
+                        path += "/";
+                        children.push_back({entry.b_inodo, path});
+                    }
+                    ok = push({path, inode});
+                }
+            }
+            // Se apilan al revés para recorrerlas en el orden de la carpeta
+            pending.insert(pending.end(), children.rbegin(), children.rend());
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.done = true;
+        queue.changed.notify_all();
+    }
+
+    // Escribir en 'out' el tar del árbol que empieza en 'rootIndex'. Sirve para
+    // un archivo, la salida estándar o el cuerpo de una respuesta HTTP
+    inline std::string writeTar(FileOps::Context& ctx, int rootIndex, const std::string& rootName,
+                                std::ostream& out, Stats& stats) {
+        Queue queue;
+        std::thread walker(walkTree, ctx, rootIndex, rootName, std::ref(queue));
+
+        std::string error;
+        char header[TAR_BLOCK];
+        static const char zeros[TAR_BLOCK] = {};
+        FileStream::Sink sink = [&](const char* data, size_t size) {
+            out.write(data, static_cast<std::streamsize>(size));
+            return static_cast<bool>(out);
+        };
+        while (error.empty()) {
+            Item item;
+            {
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                queue.changed.wait(lock, [&]() { return !queue.items.empty() || queue.done; });
+                if (queue.items.empty()) {
+                    break;
+                }
+                item = std::move(queue.items.front());
+                queue.items.pop_front();
+                queue.changed.notify_all();
+            }
+            bool folder = item.inode.i_type == '1';
+            long long size = folder ? 0 : item.inode.i_size;
+            if (!buildHeader(item, size, header)) {
+                stats.skipped++;
+                continue;
+            }
+            out.write(header, TAR_BLOCK);
+            if (folder) {
+                stats.folders++;
+                continue;
+            }
+            FileStream::Result read = FileStream::read(ctx, item.inode, sink);
+            if (!read.error.empty()) {
+                error = read.error + " ('" + item.name + "')";
+                break;
+            }
+            out.write(zeros, (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK);
+            stats.files++;
+            stats.bytes += size;
+            if (!out) {
+                error = "Error: no se pudo escribir la salida";
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.cancelled = true;
+            queue.changed.notify_all();
+        }
+        walker.join();
+        if (error.empty()) {
+            // Fin del archivo: dos bloques en ceros
+            out.write(zeros, TAR_BLOCK);
+            out.write(zeros, TAR_BLOCK);
+            out.flush();
+            if (!out) {
+                error = "Error: no se pudo escribir la salida";
+            }
+        }
+        return error;
+    }
+
+    // Comando export: escribir en -out un tar con la carpeta (o el archivo)
+    // -path de la partición montada; por defecto toda la partición
+    inline std::string execute(const std::string& id, const std::string& pathParam, const std::string& outParam) {
+        if (id.empty()) {
+            return "Error: export requiere el parámetro -id";
+        }
+        if (outParam.empty()) {
+            return "Error: export requiere el parámetro -out";
+        }
+        std::string path = pathParam.empty() ? "/" : pathParam;
+
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        int rootIndex = FileOps::resolvePath(ctx, path, error);
+        if (rootIndex == -1) {
+            return error;
+        }
+        // Un archivo suelto se guarda con su nombre; una carpeta, con su contenido
+        std::string rootName;
+        if (FileOps::readInode(ctx, rootIndex).i_type != '1') {
+            rootName = path.substr(path.find_last_of('/') + 1);
+        }
+
+        std::string outPath = CommandMount::expandPath(outParam);
+        std::ofstream out(outPath, std::ios::binary);
+        if (!out.is_open()) {
+            return "Error: no se pudo crear el archivo '" + outParam + "'";
+        }
+
+        // Los bloques se leen directo del disco
+        error = DelayedAlloc::flush(ctx).error;
+        if (!error.empty()) {
+            return error;
+        }
+        BufferCache::flush(ctx.path);
+        auto begin = std::chrono::steady_clock::now();
+        Stats stats;
+        error = writeTar(ctx, rootIndex, rootName, out, stats);
+        out.close();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (!error.empty()) {
+            return error;
+        }
+
+        std::ostringstream result;
+        result << "\n=== EXPORT ===\n";
+        result << "'" << path << "' exportado a '" << outParam << "'\n";
+        result << "  Archivos: " << stats.files << " (" << stats.bytes << " bytes)\n";
+        result << "  Carpetas: " << stats.folders << "\n";
+        if (stats.skipped > 0) {
+            result << "  Omitidos (ruta demasiado larga): " << stats.skipped << "\n";
+        }
+        result << std::fixed << std::setprecision(3) << "  Tiempo: " << seconds << " s";
+        if (seconds > 0) {
+            result << std::setprecision(1) << " (" << stats.bytes / (1024.0 * 1024.0) / seconds << " MB/s)";
+        }
+        return result.str();
+    }
+
+} // namespace CommandExport
+
+#endif // EXPORT_H
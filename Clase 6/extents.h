@@ -0,0 +1,155 @@
+#ifndef EXTENTS_H
+#define EXTENTS_H
+
+#include <vector>       // Vectores dinámicos
+#include <cstdint>      // Enteros de ancho fijo
+#include <cstring>      // memcpy
+#include <algorithm>    // std::upper_bound
+#include <functional>   // Lector de bloques
+#include "structures.h"
+#include "filesystem.h"
+
+// Formato de los extents: un inodo con INODE_FLAG_EXTENTS no usa i_block como
+// apuntadores directos e indirectos, sino como la raíz de un árbol de tramos
+// (bloque lógico inicial, bloque físico inicial, largo). Cada nodo empieza con
+// una cabecera; en las hojas (profundidad 0) las entradas son tramos y en los
+// nodos internos apuntan al bloque hijo que cubre desde su bloque lógico. La
+// raíz vive en i_block (60 bytes: cabecera y 4 entradas) y los demás nodos en
+// bloques del área de bloques. Este archivo solo lee el formato; la asignación
+// y la escritura están en FileOps
+namespace Extents {
+
+    const uint16_t MAGIC = 0xF30A;
+
+    struct Header {
+        uint16_t magic;
+        uint16_t entries;       // Entradas usadas
+        uint16_t max;           // Entradas que caben en el nodo
+        uint16_t depth;         // 0: hoja
+        uint32_t reserved;
+    };
+
+    // Tramo de una hoja o entrada de un nodo interno (physical = bloque hijo)
+    struct Extent {
+        int32_t logical;
+        int32_t physical;
+        int32_t length;
+    };
+
+    static_assert(sizeof(Header) == sizeof(Extent), "cabecera y entradas deben medir lo mismo");
+
+    // Nodo leído en memoria
+    struct Node {
+        Header header;
+        std::vector<Extent> entries;
+    };
+
+    // Lee un bloque del área de bloques (cada llamador usa su propia E/S)
+    using BlockReader = std::function<FileSystem::Block(int)>;
+
+    // Entradas que caben en la raíz (i_block) y en un bloque
+    inline int rootCapacity() {
+        const size_t rootBytes = sizeof(Inode::i_block);
+        return static_cast<int>(rootBytes / sizeof(Extent)) - 1;
+    }
+
+    inline int blockCapacity(const Superblock& sb) {
+        return sb.s_block_size / static_cast<int>(sizeof(Extent)) - 1;
+    }
+
+    inline bool usesExtents(const Inode& inode) {
+        return (inode.i_flags & INODE_FLAG_EXTENTS) != 0;
+    }
+
+    inline Node parse(const char* raw, int capacity) {
+        Node node;
+        std::memcpy(&node.header, raw, sizeof(Header));
+        if (node.header.magic != MAGIC || node.header.entries > capacity) {
+            node.header.magic = 0;
+            node.header.entries = 0;
+        }
+        node.entries.resize(node.header.entries);
+        for (int k = 0; k < node.header.entries; k++) {
+            std::memcpy(&node.entries[k], raw + (k + 1) * sizeof(Extent), sizeof(Extent));
+        }
+        return node;
+    }
+
+    inline void serialize(const Node& node, char* raw, int capacity) {
+        Header header = node.header;
+        header.magic = MAGIC;
+        header.entries = static_cast<uint16_t>(node.entries.size());
+        header.max = static_cast<uint16_t>(capacity);
+        std::memcpy(raw, &header, sizeof(Header));
+        for (size_t k = 0; k < node.entries.size(); k++) {
+            std::memcpy(raw + (k + 1) * sizeof(Extent), &node.entries[k], sizeof(Extent));
+        }
+    }
+
+    inline Node root(const Inode& inode) {
+        return parse(reinterpret_cast<const char*>(inode.i_block), rootCapacity());
+    }
+
+    inline Node fromBlock(FileSystem::Block& block, const Superblock& sb) {
+        return parse(block.data.data(), blockCapacity(sb));
+    }
+
+    // Raíz vacía para un inodo nuevo
+    inline void initRoot(Inode& inode) {
+        std::memset(inode.i_block, 0, sizeof(inode.i_block));
+        Node empty;
+        empty.header = Header{};
+        serialize(empty, reinterpret_cast<char*>(inode.i_block), rootCapacity());
+        inode.i_flags |= INODE_FLAG_EXTENTS;
+    }
+
+    // Entrada del nodo que cubre 'logical' (la última que empieza antes); -1 si ninguna
+    inline int find(const Node& node, long long logical) {
+        auto next = std::upper_bound(node.entries.begin(), node.entries.end(), logical,
+                                     [](long long value, const Extent& e) { return value < e.logical; });
+        return static_cast<int>(next - node.entries.begin()) - 1;
+    }
+
+    // Bloque físico del bloque lógico 'logical'; -1 si no está asignado.
+    // Lee un bloque por nivel del árbol
+    inline int lookup(const Superblock& sb, const Inode& inode, long long logical, const BlockReader& read) {
+        Node node = root(inode);
+        for (int level = 0; level < 8 && node.header.magic == MAGIC; level++) {
+            int position = find(node, logical);
+            if (position < 0) {
+                return -1;
+            }
+            const Extent& entry = node.entries[position];
+            if (node.header.depth == 0) {
+                return logical < static_cast<long long>(entry.logical) + entry.length
+                       ? entry.physical + static_cast<int>(logical - entry.logical) : -1;
+            }
+            FileSystem::Block block = read(entry.physical);
+            node = fromBlock(block, sb);
+        }
+        return -1;
+    }
+
+    // Todos los tramos del inodo en orden y los bloques que ocupa el árbol
+    inline void collect(const Superblock& sb, const Inode& inode, const BlockReader& read,
+                        std::vector<Extent>& extents, std::vector<int>& treeBlocks) {
+        std::function<void(const Node&, int)> walk = [&](const Node& node, int guard) {
+            if (node.header.magic != MAGIC || guard > 8) {
+                return;
+            }
+            for (const Extent& entry : node.entries) {
+                if (node.header.depth == 0) {
+                    extents.push_back(entry);
+                } else {
+                    treeBlocks.push_back(entry.physical);
+                    FileSystem::Block block = read(entry.physical);
+                    walk(fromBlock(block, sb), guard + 1);
+                }
+            }
+        };
+        walk(root(inode), 0);
+    }
+
+} // namespace Extents
+
+#endif // EXTENTS_H
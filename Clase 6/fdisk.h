@@ -6,7 +6,9 @@
 #include <fstream>   // Proporciona funcionalidades para trabajar con archivos (lectura y escritura).
 #include <cstring>   // Manipula cadenas C-style
 #include <cstdlib>   // funciones generales como el rand() y conversiones de cadenas a números.
+#include <limits>    // std::numeric_limits
 #include "structures.h" // estructuras de datos.
+#include "buffer_cache.h" // Marcos en memoria del disco
 
 
 namespace CommandFdisk {
@@ -296,6 +298,10 @@ namespace CommandFdisk {
             }
             checkFile.close();
 
+            // fdisk escribe el MBR y los EBR directamente: volcar y olvidar los
+            // marcos en memoria del disco para no pisar esos cambios después
+            BufferCache::invalidate(expandedPath, 0, std::numeric_limits<long long>::max());
+
             // Si es operación de eliminación
             if (!deleteName.empty()) {
                 return "Error: La eliminación de particiones no está habilitada";
@@ -0,0 +1,165 @@
+#ifndef FILE_STREAM_H
+#define FILE_STREAM_H
+
+#include <string>       // Manejo de la clase std::string
+#include <vector>       // Buffer de lectura
+#include <deque>        // Tramos pedidos por adelantado
+#include <functional>   // Destino de los datos
+#include <algorithm>    // std::min
+#include <chrono>       // Medición del tiempo
+#include <cstring>      // memset
+#include <fcntl.h>      // open, posix_fadvise
+#include <unistd.h>     // pread, close
+#include "structures.h"
+#include "filesystem.h"
+#include "fileops.h"
+#include "buffer_cache.h"
+
+// Lectura en secuencia del contenido de un archivo sin cargarlo completo en
+// memoria. Los bloques se agrupan en tramos contiguos en el disco y cada tramo
+// se lee con pread grandes que se entregan a la salida por partes. Mientras se
+// lee un tramo, los siguientes ya están pedidos al sistema operativo
+// (posix_fadvise WILLNEED): la ventana de lectura anticipada empieza pequeña,
+// se duplica mientras la lectura siga en orden en el disco y vuelve al mínimo
+// en cada salto
+namespace FileStream {
+
+    const size_t CHUNK_SIZE = 256 * 1024;               // Bytes por pread y por entrega
+    const long long READAHEAD_MIN = 64 * 1024;          // Ventana inicial
+    const long long READAHEAD_MAX = 4 * 1024 * 1024;    // Ventana máxima
+
+    // Destino de los datos; devuelve false para detener la lectura
+    using Sink = std::function<bool(const char*, size_t)>;
+
+    struct Result {
+        long long bytes = 0;
+        long long reads = 0;        // Llamadas a pread
+        long long runs = 0;         // Tramos contiguos leídos
+        long long window = 0;       // Ventana de lectura anticipada al terminar
+        double seconds = 0;
+        std::string error;          // "" si todo salió bien
+    };
+
+    // Tramo en bytes dentro del disco (offset -1: hueco, se entregan ceros)
+    struct Span {
+        long long offset;
+        long long length;
+    };
+
+    // Entregar a 'sink' el contenido completo del archivo
+    inline Result read(FileOps::Context& ctx, const Inode& inode, const Sink& sink) {
+        Result result;
+        auto begin = std::chrono::steady_clock::now();
+        auto finish = [&]() {
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            return result;
+        };
+
+        if (FileSystem::hasInlineData(inode)) {
+            std::string content = FileSystem::readInlineData(inode);
+            if (!sink(content.data(), content.size())) {
+                result.error = "Error: no se pudo escribir la salida";
+            }
+            result.bytes = static_cast<long long>(content.size());
+            return finish();
+        }
+
+        // Los bloques de datos pueden seguir sucios en la caché
+        BufferCache::flush(ctx.path);
+        int fd = ::open(ctx.path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            result.error = "Error: no se pudo abrir el disco '" + ctx.path + "'";
+            return finish();
+        }
+
+        std::vector<char> buffer(CHUNK_SIZE);
+        std::deque<Span> pending;
+        long long pendingBytes = 0;
+        long long window = READAHEAD_MIN;
+        long long lastEnd = -1;
+        bool ok = true;
+
+        // Leer y entregar el primer tramo pedido
+        auto consume = [&]() {
+            Span span = pending.front();
+            pending.pop_front();
+            pendingBytes -= span.length;
+            if (span.offset != -1) {
+                window = span.offset == lastEnd ? std::min(window * 2, READAHEAD_MAX) : READAHEAD_MIN;
+                lastEnd = span.offset + span.length;
+            }
+            for (long long done = 0; done < span.length && ok; ) {
+                size_t piece = static_cast<size_t>(std::min<long long>(CHUNK_SIZE, span.length - done));
+                if (span.offset == -1) {
+                    std::memset(buffer.data(), 0, piece);
+                } else {
+                    ssize_t got = pread(fd, buffer.data(), piece, span.offset + done);
+                    result.reads++;
+                    if (got != static_cast<ssize_t>(piece)) {
+                        result.error = "Error: no se pudo leer el disco '" + ctx.path + "'";
+                        ok = false;
+                        break;
+                    }
+                }
+                if (!sink(buffer.data(), piece)) {
+                    result.error = "Error: no se pudo escribir la salida";
+                    ok = false;
+                    break;
+                }
+                done += piece;
+                result.bytes += piece;
+            }
+            result.runs++;
+        };
+
+        // Pedir un tramo: se une al anterior si sigue en el disco
+        auto request = [&](long long offset, long long length) {
+            if (!pending.empty() && pending.back().offset != -1 && offset != -1 &&
+                pending.back().offset + pending.back().length == offset) {
+                pending.back().length += length;
+            } else if (!pending.empty() && pending.back().offset == -1 && offset == -1) {
+                pending.back().length += length;
+            } else {
+                pending.push_back({offset, length});
+            }
+            pendingBytes += length;
+            if (offset != -1) {
+                posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+            }
+            while (ok && pendingBytes > window && !pending.empty()) {
+                consume();
+            }
+        };
+
+        long long blockSize = ctx.sb.s_block_size;
+        long long blocks = (inode.i_size + blockSize - 1) / blockSize;
+        int perGroup = FileSystem::blocksPerGroup(ctx.sb);
+        FileOps::forEachRun(ctx, inode, blocks, [&](long long logical, int physical, int count) {
+            long long end = std::min(static_cast<long long>(inode.i_size), (logical + count) * blockSize);
+            long long position = logical * blockSize;
+            if (physical == -1) {
+                request(-1, end - position);
+                return ok;
+            }
+            // Números de bloque seguidos en grupos distintos no son contiguos en el disco
+            while (ok && position < end) {
+                int g = FileSystem::blockGroup(ctx.sb, physical);
+                long long inGroup = static_cast<long long>(g + 1) * perGroup - physical;
+                long long length = std::min(end - position, inGroup * blockSize);
+                request(FileSystem::blockOffset(ctx.sb, physical), length);
+                position += length;
+                physical += static_cast<int>(inGroup);
+            }
+            return ok;
+        });
+        while (ok && !pending.empty()) {
+            consume();
+        }
+        close(fd);
+        result.window = window;
+        return finish();
+    }
+
+} // namespace FileStream
+
+#endif // FILE_STREAM_H
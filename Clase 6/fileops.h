@@ -0,0 +1,1439 @@
+#ifndef FILEOPS_H
+#define FILEOPS_H
+
+#include <string>       // Manejo de la clase std::string
+#include <vector>       // Vectores dinámicos
+#include <cstring>      // memcpy, strnlen, strncpy
+#include <ctime>        // Fechas de los inodos
+#include <cstdint>      // uint32_t (hash de nombres)
+#include <algorithm>    // std::sort, std::upper_bound
+#include <functional>   // Recorrido de tramos
+#include "structures.h"
+#include "filesystem.h"
+#include "allocator.h"
+#include "journal.h"
+#include "inode_cache.h"
+#include "buffer_cache.h"
+#include "dentry_cache.h"
+#include "extents.h"
+#include "refcount.h"
+#include "mount.h"
+
+// Operaciones sobre archivos y carpetas de una partición formateada: resolver
+// rutas, leer y escribir inodos y bloques, y crear carpetas y archivos. Todo
+// pasa por la caché de bloques; los metadatos (inodos, bloques de carpeta y de
+// apuntadores) se escriben con Journal::writeMetadata y el contenido de los
+// archivos sin journal
+namespace FileOps {
+
+    // i_block[0..11] son directos; 12, 13 y 14 son indirectos simple, doble y triple
+    const int DIRECT_POINTERS = 12;
+
+    // Largo máximo de un nombre (Content::b_name)
+    const int MAX_NAME = sizeof(Content::b_name);
+
+    // Sistema de archivos abierto para una operación
+    struct Context {
+        std::string path;       // Ruta del disco
+        int partStart = 0;      // Inicio de la partición
+        Superblock sb;
+    };
+
+    // Abrir la partición montada con ID 'id'. Devuelve un mensaje de error o ""
+    inline std::string open(Context& ctx, const std::string& id) {
+        CommandMount::MountedPartition partition;
+        if (!CommandMount::getMountedPartition(id, partition)) {
+            return "Error: la partición con ID '" + id + "' no está montada";
+        }
+        ctx.path = partition.path;
+        ctx.partStart = partition.start;
+        if (!BufferCache::read(ctx.path, ctx.partStart, &ctx.sb, sizeof(Superblock))) {
+            return "Error: no se pudo leer el disco '" + partition.path + "'";
+        }
+        if (ctx.sb.s_magic != 0xEF53) {
+            return "Error: la partición con ID '" + id + "' no está formateada (use mkfs)";
+        }
+        if (!FileSystem::acceptSuperblock(ctx.sb, ctx.partStart, partition.size)) {
+            return "Error: el Superbloque de la partición con ID '" + id + "' no es válido (use mkfs)";
+        }
+        return "";
+    }
+
+    // Separar una ruta absoluta en sus componentes
+    inline std::string splitPath(const std::string& path, std::vector<std::string>& parts) {
+        if (path.empty() || path[0] != '/') {
+            return "Error: la ruta debe ser absoluta (empezar con '/')";
+        }
+        parts.clear();
+        size_t pos = 1;
+        while (pos <= path.size()) {
+            size_t next = path.find('/', pos);
+            if (next == std::string::npos) {
+                next = path.size();
+            }
+            std::string name = path.substr(pos, next - pos);
+            if (!name.empty()) {
+                if (name == "." || name == "..") {
+                    return "Error: la ruta no puede contener '.' ni '..'";
+                }
+                if (static_cast<int>(name.size()) > MAX_NAME) {
+                    return "Error: el nombre '" + name + "' supera los " + std::to_string(MAX_NAME) + " caracteres";
+                }
+                parts.push_back(name);
+            }
+            pos = next + 1;
+        }
+        return "";
+    }
+
+    // Nombre de una entrada de carpeta (b_name no siempre termina en '\0')
+    inline std::string entryName(const Content& content) {
+        return std::string(content.b_name, strnlen(content.b_name, sizeof(content.b_name)));
+    }
+
+    // Los inodos pasan por la caché: solo un fallo lee del disco y las
+    // escrituras se vuelcan después (ver InodeCache)
+    inline Inode readInode(Context& ctx, int i) {
+        Inode inode;
+        if (!InodeCache::lookup(ctx.path, ctx.partStart, i, inode)) {
+            BufferCache::read(ctx.path, FileSystem::inodeOffset(ctx.sb, i), &inode, sizeof(Inode));
+            FileSystem::sanitizeInode(ctx.sb, inode);
+            InodeCache::insert(ctx.path, ctx.partStart, ctx.sb, i, inode, false);
+        }
+        return inode;
+    }
+
+    inline bool writeInode(Context& ctx, int i, const Inode& inode) {
+        InodeCache::insert(ctx.path, ctx.partStart, ctx.sb, i, inode, true);
+        return true;
+    }
+
+    // Generación del inodo i: cambia cada vez que se escribe, así que sirve
+    // para saber si una copia derivada de su contenido sigue vigente
+    inline long long inodeGeneration(Context& ctx, int i) {
+        long long generation = InodeCache::generation(ctx.path, ctx.partStart, i);
+        if (generation == -1) {
+            readInode(ctx, i);
+            generation = InodeCache::generation(ctx.path, ctx.partStart, i);
+        }
+        // Desalojado entre medio: una generación nueva obliga a releer
+        return generation == -1 ? InodeCache::nextGeneration() : generation;
+    }
+
+    inline FileSystem::Block readBlock(Context& ctx, int b) {
+        FileSystem::Block block(ctx.sb.s_block_size);
+        BufferCache::read(ctx.path, FileSystem::blockOffset(ctx.sb, b), block.data.data(), block.size());
+        return block;
+    }
+
+    // Bloques de carpeta y de apuntadores
+    inline bool writeMetadataBlock(Context& ctx, int b, const FileSystem::Block& block) {
+        return Journal::writeMetadata(ctx.path, ctx.partStart, ctx.sb, FileSystem::blockOffset(ctx.sb, b),
+                                      block.data.data(), block.size());
+    }
+
+    // Bloques de contenido de archivos
+    inline bool writeDataBlock(Context& ctx, int b, const FileSystem::Block& block) {
+        return BufferCache::write(ctx.path, FileSystem::blockOffset(ctx.sb, b), block.data.data(), block.size());
+    }
+
+    // Máximo de bloques lógicos que puede direccionar un inodo
+    inline long long maxBlocks(const Superblock& sb) {
+        long long per = FileSystem::pointersPerBlock(sb);
+        return DIRECT_POINTERS + per + per * per + per * per * per;
+    }
+
+    // ¿Caben 'size' bytes en el inodo? Con extents el límite es i_size; con
+    // apuntadores, maxBlocks. Uno en línea pasa a bloques con el formato del
+    // sistema de archivos (ver convertInline)
+    inline bool fitsInInode(const Superblock& sb, const Inode& inode, long long size) {
+        if (size > INT32_MAX) {
+            return false;
+        }
+        bool extents = FileSystem::hasInlineData(inode) ? (sb.s_feature_compat & FS_FEATURE_EXTENTS) != 0
+                                                        : Extents::usesExtents(inode);
+        return extents || (size + sb.s_block_size - 1) / sb.s_block_size <= maxBlocks(sb);
+    }
+
+    // Traducir un bloque lógico a su ranura en i_block y los índices dentro de
+    // cada nivel de bloques de apuntadores. Devuelve false si está fuera de rango
+    inline bool pointerPath(const Superblock& sb, long long logical, int& slot, std::vector<int>& indices) {
+        indices.clear();
+        if (logical < DIRECT_POINTERS) {
+            slot = static_cast<int>(logical);
+            return logical >= 0;
+        }
+        long long per = FileSystem::pointersPerBlock(sb);
+        long long rest = logical - DIRECT_POINTERS;
+        long long span = per;
+        for (int level = 1; level <= 3; level++) {
+            if (rest < span) {
+                slot = DIRECT_POINTERS + level - 1;
+                for (long long divisor = span / per; level > 0; level--, divisor /= per) {
+                    indices.push_back(static_cast<int>((rest / divisor) % per));
+                }
+                return true;
+            }
+            rest -= span;
+            span *= per;
+        }
+        return false;
+    }
+
+    // Lector de bloques para Extents (a través de la caché)
+    inline Extents::BlockReader blockReader(Context& ctx) {
+        return [&ctx](int b) { return readBlock(ctx, b); };
+    }
+
+    // Bloque físico del bloque lógico 'logical' del inodo; -1 si no está asignado
+    inline int blockAt(Context& ctx, const Inode& inode, long long logical) {
+        if (FileSystem::hasInlineData(inode)) {
+            return -1;
+        }
+        if (Extents::usesExtents(inode)) {
+            return Extents::lookup(ctx.sb, inode, logical, blockReader(ctx));
+        }
+        int slot;
+        std::vector<int> indices;
+        if (!pointerPath(ctx.sb, logical, slot, indices)) {
+            return -1;
+        }
+        int b = inode.i_block[slot];
+        for (int index : indices) {
+            if (b == -1) {
+                return -1;
+            }
+            b = readBlock(ctx, b).pointers()[index];
+        }
+        return b;
+    }
+
+    // ---- Extents ----
+
+    // Agregar 'run' a una lista ordenada de tramos: lo que se solape con él se
+    // recorta (el bloque lógico pasa a otro físico) y los vecinos contiguos se unen
+    inline void insertExtent(std::vector<Extents::Extent>& extents, const Extents::Extent& run) {
+        long long runEnd = static_cast<long long>(run.logical) + run.length;
+        std::vector<Extents::Extent> kept;
+        for (const Extents::Extent& e : extents) {
+            long long end = static_cast<long long>(e.logical) + e.length;
+            if (end <= run.logical || e.logical >= runEnd) {
+                kept.push_back(e);
+                continue;
+            }
+            if (e.logical < run.logical) {
+                kept.push_back({e.logical, e.physical, run.logical - e.logical});
+            }
+            if (end > runEnd) {
+                int skip = static_cast<int>(runEnd - e.logical);
+                kept.push_back({static_cast<int>(runEnd), e.physical + skip, e.length - skip});
+            }
+        }
+        auto position = std::upper_bound(kept.begin(), kept.end(), run,
+                                         [](const Extents::Extent& a, const Extents::Extent& b) {
+                                             return a.logical < b.logical;
+                                         });
+        kept.insert(position, run);
+
+        extents.clear();
+        for (const Extents::Extent& e : kept) {
+            if (!extents.empty()) {
+                Extents::Extent& last = extents.back();
+                if (last.logical + last.length == e.logical && last.physical + last.length == e.physical) {
+                    last.length += e.length;
+                    continue;
+                }
+            }
+            extents.push_back(e);
+        }
+    }
+
+    inline void writeExtentNode(Context& ctx, int b, const Extents::Node& node) {
+        FileSystem::Block block(ctx.sb.s_block_size);
+        Extents::serialize(node, block.data.data(), Extents::blockCapacity(ctx.sb));
+        writeMetadataBlock(ctx, b, block);
+    }
+
+    // Reescribir el árbol completo con 'extents', de las hojas hacia la raíz.
+    // Reutiliza los bloques del árbol anterior ('spare') y libera los que sobren;
+    // los que falten se reservan antes de escribir nada
+    inline bool rebuildExtents(Context& ctx, int inodeIndex, Inode& inode,
+                               const std::vector<Extents::Extent>& extents, std::vector<int> spare) {
+        int rootCapacity = Extents::rootCapacity();
+        int capacity = Extents::blockCapacity(ctx.sb);
+        size_t needed = 0;
+        for (size_t count = extents.size(); static_cast<int>(count) > rootCapacity; ) {
+            count = (count + capacity - 1) / capacity;
+            needed += count;
+        }
+        std::vector<int> reserved;
+        while (spare.size() + reserved.size() < needed) {
+            int b = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, inodeIndex);
+            if (b == -1) {
+                for (int unused : reserved) {
+                    Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, unused);
+                }
+                return false;
+            }
+            reserved.push_back(b);
+        }
+        spare.insert(spare.end(), reserved.begin(), reserved.end());
+
+        std::vector<Extents::Extent> level = extents;
+        uint16_t depth = 0;
+        while (static_cast<int>(level.size()) > rootCapacity) {
+            std::vector<Extents::Extent> parents;
+            for (size_t k = 0; k < level.size(); k += capacity) {
+                int b = spare.back();
+                spare.pop_back();
+                Extents::Node node;
+                node.header = Extents::Header{};
+                node.header.depth = depth;
+                node.entries.assign(level.begin() + k, level.begin() + std::min(level.size(), k + capacity));
+                writeExtentNode(ctx, b, node);
+                parents.push_back({node.entries[0].logical, b, 0});
+            }
+            level = parents;
+            depth++;
+        }
+        Extents::Node root;
+        root.header = Extents::Header{};
+        root.header.depth = depth;
+        root.entries = level;
+        Extents::serialize(root, reinterpret_cast<char*>(inode.i_block), rootCapacity);
+        for (int b : spare) {
+            Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, b);
+        }
+        return true;
+    }
+
+    // Asociar 'length' bloques físicos contiguos desde 'physical' a los lógicos
+    // desde 'logical'. El caso común (el tramo sigue al último del archivo)
+    // solo toca la hoja del extremo derecho; lo demás reescribe el árbol
+    inline bool mapExtent(Context& ctx, int inodeIndex, Inode& inode, long long logical, int physical, int length) {
+        Extents::Node node = Extents::root(inode);
+        if (node.header.magic != Extents::MAGIC) {
+            return false;
+        }
+        int b = -1;   // -1: el nodo es la raíz dentro del inodo
+        while (node.header.depth > 0 && !node.entries.empty()) {
+            b = node.entries.back().physical;
+            FileSystem::Block block = readBlock(ctx, b);
+            node = Extents::fromBlock(block, ctx.sb);
+        }
+        int capacity = b == -1 ? Extents::rootCapacity() : Extents::blockCapacity(ctx.sb);
+        long long lastEnd = node.entries.empty() ? 0 : static_cast<long long>(node.entries.back().logical) +
+                                                      node.entries.back().length;
+        bool appended = false;
+        if (!node.entries.empty() && logical == lastEnd &&
+            physical == node.entries.back().physical + node.entries.back().length) {
+            node.entries.back().length += length;
+            appended = true;
+        } else if (logical >= lastEnd && static_cast<int>(node.entries.size()) < capacity &&
+                   (b != -1 || node.header.depth == 0)) {
+            node.entries.push_back({static_cast<int>(logical), physical, length});
+            appended = true;
+        }
+        if (appended) {
+            if (b == -1) {
+                Extents::serialize(node, reinterpret_cast<char*>(inode.i_block), capacity);
+            } else {
+                writeExtentNode(ctx, b, node);
+            }
+            return true;
+        }
+
+        std::vector<Extents::Extent> extents;
+        std::vector<int> treeBlocks;
+        Extents::collect(ctx.sb, inode, blockReader(ctx), extents, treeBlocks);
+        insertExtent(extents, {static_cast<int>(logical), physical, length});
+        return rebuildExtents(ctx, inodeIndex, inode, extents, treeBlocks);
+    }
+
+    // Asociar el bloque físico 'physical' al bloque lógico 'logical' del inodo,
+    // creando los bloques de apuntadores que falten. El inodo se modifica en
+    // memoria; quien llama debe escribirlo
+    inline bool mapBlock(Context& ctx, int inodeIndex, Inode& inode, long long logical, int physical) {
+        if (FileSystem::hasInlineData(inode)) {
+            return false;   // Primero hay que pasarlo a bloques (convertInline)
+        }
+        if (Extents::usesExtents(inode)) {
+            return mapExtent(ctx, inodeIndex, inode, logical, physical, 1);
+        }
+        int slot;
+        std::vector<int> indices;
+        if (!pointerPath(ctx.sb, logical, slot, indices)) {
+            return false;
+        }
+        if (indices.empty()) {
+            inode.i_block[slot] = physical;
+            return true;
+        }
+
+        // Bloque de apuntadores de primer nivel
+        if (inode.i_block[slot] == -1) {
+            int created = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, inodeIndex);
+            if (created == -1) {
+                return false;
+            }
+            FileSystem::Block pointers(ctx.sb.s_block_size);
+            pointers.initPointers();
+            writeMetadataBlock(ctx, created, pointers);
+            inode.i_block[slot] = created;
+        }
+
+        int current = inode.i_block[slot];
+        for (size_t level = 0; level < indices.size(); level++) {
+            FileSystem::Block block = readBlock(ctx, current);
+            int& entry = block.pointers()[indices[level]];
+            if (level + 1 == indices.size()) {
+                entry = physical;
+                return writeMetadataBlock(ctx, current, block);
+            }
+            if (entry == -1) {
+                int created = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, inodeIndex);
+                if (created == -1) {
+                    return false;
+                }
+                FileSystem::Block pointers(ctx.sb.s_block_size);
+                pointers.initPointers();
+                writeMetadataBlock(ctx, created, pointers);
+                entry = created;
+                writeMetadataBlock(ctx, current, block);
+            }
+            current = entry;
+        }
+        return false;
+    }
+
+    // Buscar 'name' en un bloque de carpeta; devuelve la ranura o -1
+    inline int findInBlock(FileSystem::Block& block, int perBlock, const std::string& name) {
+        Content* entries = block.contents();
+        for (int k = 0; k < perBlock; k++) {
+            if (entries[k].b_inodo != -1 && entryName(entries[k]) == name) {
+                return k;
+            }
+        }
+        return -1;
+    }
+
+    // Escribir 'name' -> 'child' en la primera ranura libre; false si está lleno
+    inline bool putEntry(FileSystem::Block& block, int perBlock, const std::string& name, int child) {
+        Content* entries = block.contents();
+        for (int k = 0; k < perBlock; k++) {
+            if (entries[k].b_inodo == -1) {
+                std::memset(entries[k].b_name, 0, sizeof(entries[k].b_name));
+                std::strncpy(entries[k].b_name, name.c_str(), sizeof(entries[k].b_name));
+                entries[k].b_inodo = child;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // ---- Carpetas indexadas ----
+    // Una carpeta con INODE_FLAG_INDEX guarda en su bloque lógico 0 solo "." y
+    // "..", en el bloque lógico 1 la raíz de un árbol ordenado por el hash del
+    // nombre y en los demás nodos del árbol u hojas. Las hojas son bloques de
+    // carpeta comunes con los nombres de un rango de hashes. Los nodos guardan
+    // sus datos en b_name y dejan b_inodo = -1 en todas las ranuras, así que un
+    // lector lineal (como el reporte tree) los ve como bloques vacíos y sigue
+    // encontrando todas las entradas en las hojas
+
+    // Una carpeta lineal con estos bloques o más se indexa cuando se llena
+    const int INDEX_THRESHOLD = 4;
+
+    const uint16_t INDEX_MAGIC = 0x4854;   // "HT"
+
+    // Cabecera de un nodo del árbol (b_name de la ranura 0)
+    struct IndexHeader {
+        uint16_t magic;
+        uint8_t level;          // 0: los hijos son hojas
+        uint8_t reserved;
+        uint32_t count;         // Entradas usadas
+        uint32_t blocks;        // Solo en la raíz: bloques lógicos de la carpeta
+    };
+
+    // Entrada de un nodo (b_name de las ranuras 1..): el hijo cubre los hashes
+    // desde 'hash' hasta el de la entrada siguiente
+    struct IndexEntry {
+        uint32_t hash;
+        int32_t block;          // Bloque físico del hijo
+    };
+
+    static_assert(sizeof(IndexHeader) <= sizeof(Content::b_name), "la cabecera del índice no cabe en b_name");
+    static_assert(sizeof(IndexEntry) <= sizeof(Content::b_name), "la entrada del índice no cabe en b_name");
+
+    // Paso al bajar por el árbol: nodo, entrada elegida y entradas usadas
+    struct IndexStep {
+        int block;
+        int position;
+        int count;
+    };
+
+    inline bool isIndexed(const Inode& dir) {
+        return (dir.i_flags & INODE_FLAG_INDEX) != 0;
+    }
+
+    // Hash FNV-1a del nombre
+    inline uint32_t nameHash(const std::string& name) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : name) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Entradas por nodo (la ranura 0 es la cabecera)
+    inline int indexCapacity(const Superblock& sb) {
+        return FileSystem::contentsPerBlock(sb) - 1;
+    }
+
+    inline IndexHeader readIndexHeader(FileSystem::Block& block) {
+        IndexHeader header;
+        std::memcpy(&header, block.contents()[0].b_name, sizeof(header));
+        return header;
+    }
+
+    inline std::vector<IndexEntry> readIndexEntries(FileSystem::Block& block, const IndexHeader& header) {
+        std::vector<IndexEntry> entries(header.count);
+        for (uint32_t k = 0; k < header.count; k++) {
+            std::memcpy(&entries[k], block.contents()[k + 1].b_name, sizeof(IndexEntry));
+        }
+        return entries;
+    }
+
+    inline void writeIndexNode(Context& ctx, int b, IndexHeader header, const std::vector<IndexEntry>& entries) {
+        FileSystem::Block block(ctx.sb.s_block_size);
+        block.initFolder();
+        header.magic = INDEX_MAGIC;
+        header.count = static_cast<uint32_t>(entries.size());
+        std::memcpy(block.contents()[0].b_name, &header, sizeof(header));
+        for (size_t k = 0; k < entries.size(); k++) {
+            std::memcpy(block.contents()[k + 1].b_name, &entries[k], sizeof(IndexEntry));
+        }
+        writeMetadataBlock(ctx, b, block);
+    }
+
+    // Bajar desde la raíz hasta la hoja que cubre 'hash' (una lectura por
+    // nivel). Devuelve el bloque de la hoja o -1 si el índice está dañado
+    inline int findLeaf(Context& ctx, const Inode& dir, uint32_t hash, std::vector<IndexStep>* path = nullptr) {
+        int capacity = indexCapacity(ctx.sb);
+        int node = dir.i_block[1];
+        for (int depth = 0; node != -1 && depth < 32; depth++) {
+            FileSystem::Block block = readBlock(ctx, node);
+            IndexHeader header = readIndexHeader(block);
+            if (header.magic != INDEX_MAGIC || header.count == 0 || static_cast<int>(header.count) > capacity) {
+                return -1;
+            }
+            std::vector<IndexEntry> entries = readIndexEntries(block, header);
+            auto next = std::upper_bound(entries.begin(), entries.end(), hash,
+                                         [](uint32_t h, const IndexEntry& entry) { return h < entry.hash; });
+            int position = next == entries.begin() ? 0 : static_cast<int>(next - entries.begin()) - 1;
+            if (path) {
+                path->push_back({node, position, static_cast<int>(header.count)});
+            }
+            if (header.level == 0) {
+                return entries[position].block;
+            }
+            node = entries[position].block;
+        }
+        return -1;
+    }
+
+    // Dejar listos 'count' bloques al final de la carpeta indexada y avanzar el
+    // contador de la raíz. Reutiliza los bloques vacíos ya asociados (los que
+    // deja la conversión o una reserva fallida); los nuevos quedan como
+    // bloques de carpeta vacíos
+    inline std::string reserveIndexBlocks(Context& ctx, int dirIndex, Inode& dir, int count, std::vector<int>& out) {
+        int root = dir.i_block[1];
+        FileSystem::Block rootBlock = readBlock(ctx, root);
+        IndexHeader header = readIndexHeader(rootBlock);
+        out.clear();
+        for (int k = 0; k < count; k++) {
+            long long logical = static_cast<long long>(header.blocks) + k;
+            int b = blockAt(ctx, dir, logical);
+            if (b == -1) {
+                b = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, dirIndex);
+                if (b == -1) {
+                    return "Error: no hay bloques libres";
+                }
+                FileSystem::Block empty(ctx.sb.s_block_size);
+                empty.initFolder();
+                writeMetadataBlock(ctx, b, empty);
+                if (!mapBlock(ctx, dirIndex, dir, logical, b)) {
+                    Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, b);
+                    return "Error: la carpeta no admite más entradas";
+                }
+            }
+            out.push_back(b);
+        }
+        header.blocks += count;
+        std::memcpy(rootBlock.contents()[0].b_name, &header, sizeof(header));
+        writeMetadataBlock(ctx, root, rootBlock);
+        return "";
+    }
+
+    // Insertar (hash, child) después de la entrada elegida en el nodo
+    // path[depth], partiendo los nodos llenos hacia arriba. La raíz no se mueve:
+    // si se llena, sus entradas bajan a dos nodos nuevos y el árbol crece un nivel
+    inline void insertIndex(Context& ctx, const std::vector<IndexStep>& path, size_t depth,
+                            uint32_t hash, int child, std::vector<int>& spare) {
+        int node = path[depth].block;
+        FileSystem::Block block = readBlock(ctx, node);
+        IndexHeader header = readIndexHeader(block);
+        std::vector<IndexEntry> entries = readIndexEntries(block, header);
+        entries.insert(entries.begin() + path[depth].position + 1, IndexEntry{hash, child});
+        if (static_cast<int>(entries.size()) <= indexCapacity(ctx.sb)) {
+            writeIndexNode(ctx, node, header, entries);
+            return;
+        }
+
+        size_t half = entries.size() / 2;
+        std::vector<IndexEntry> left(entries.begin(), entries.begin() + half);
+        std::vector<IndexEntry> right(entries.begin() + half, entries.end());
+        IndexHeader inner{};
+        inner.level = header.level;
+        if (depth == 0) {
+            int first = spare.back();
+            spare.pop_back();
+            int second = spare.back();
+            spare.pop_back();
+            writeIndexNode(ctx, first, inner, left);
+            writeIndexNode(ctx, second, inner, right);
+            header.level++;
+            writeIndexNode(ctx, node, header, {IndexEntry{0, first}, IndexEntry{right[0].hash, second}});
+            return;
+        }
+        int sibling = spare.back();
+        spare.pop_back();
+        writeIndexNode(ctx, node, header, left);
+        writeIndexNode(ctx, sibling, inner, right);
+        insertIndex(ctx, path, depth - 1, right[0].hash, sibling, spare);
+    }
+
+    // Agregar 'name' -> 'child' a una carpeta indexada. Si la hoja está llena,
+    // sus entradas se reparten por hash con una hoja nueva
+    inline std::string addIndexedEntry(Context& ctx, int dirIndex, Inode& dir, const std::string& name, int child) {
+        int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+        uint32_t hash = nameHash(name);
+        std::vector<IndexStep> path;
+        int leaf = findLeaf(ctx, dir, hash, &path);
+        if (leaf == -1) {
+            return "Error: el índice de la carpeta está dañado";
+        }
+        FileSystem::Block block = readBlock(ctx, leaf);
+        if (putEntry(block, perBlock, name, child)) {
+            writeMetadataBlock(ctx, leaf, block);
+            return "";
+        }
+
+        // Entradas de la hoja más la nueva, ordenadas por hash. Los nombres con
+        // el mismo hash no se separan, así que el corte se busca desde la mitad
+        std::vector<std::pair<uint32_t, Content>> all;
+        for (int k = 0; k < perBlock; k++) {
+            Content& entry = block.contents()[k];
+            all.push_back({nameHash(entryName(entry)), entry});
+        }
+        Content added;
+        std::strncpy(added.b_name, name.c_str(), sizeof(added.b_name));
+        added.b_inodo = child;
+        all.push_back({hash, added});
+        std::stable_sort(all.begin(), all.end(),
+                         [](const std::pair<uint32_t, Content>& a, const std::pair<uint32_t, Content>& b) {
+                             return a.first < b.first;
+                         });
+        int middle = static_cast<int>(all.size()) / 2;
+        int split = -1;
+        for (int distance = 0; distance < static_cast<int>(all.size()) && split == -1; distance++) {
+            for (int candidate : {middle - distance, middle + distance}) {
+                if (candidate > 0 && candidate < static_cast<int>(all.size()) &&
+                    all[candidate - 1].first != all[candidate].first) {
+                    split = candidate;
+                    break;
+                }
+            }
+        }
+        if (split == -1) {
+            return "Error: demasiados nombres con el mismo hash en la carpeta";
+        }
+
+        // Bloques necesarios: la hoja nueva y uno por cada nodo lleno que se
+        // parte (dos si se parte la raíz). Se reservan antes de tocar el árbol
+        int needed = 1;
+        for (size_t depth = path.size(); depth-- > 0;) {
+            if (path[depth].count < indexCapacity(ctx.sb)) {
+                break;
+            }
+            needed += depth == 0 ? 2 : 1;
+        }
+        std::vector<int> spare;
+        std::string error = reserveIndexBlocks(ctx, dirIndex, dir, needed, spare);
+        if (!error.empty()) {
+            return error;
+        }
+
+        int sibling = spare.back();
+        spare.pop_back();
+        FileSystem::Block lower(ctx.sb.s_block_size);
+        FileSystem::Block upper(ctx.sb.s_block_size);
+        lower.initFolder();
+        upper.initFolder();
+        for (int k = 0; k < static_cast<int>(all.size()); k++) {
+            Content* entries = k < split ? lower.contents() : upper.contents();
+            entries[k < split ? k : k - split] = all[k].second;
+        }
+        writeMetadataBlock(ctx, leaf, lower);
+        writeMetadataBlock(ctx, sibling, upper);
+        insertIndex(ctx, path, path.size() - 1, all[split].first, sibling, spare);
+        return "";
+    }
+
+    // Cota de los bloques de una carpeta indexada con 'entries' entradas:
+    // bloque 0, raíz, hojas y nodos internos. Una hoja o un nodo nace de
+    // partir uno lleno, así que tiene al menos la mitad de su capacidad
+    inline long long indexedBlocksBound(const Superblock& sb, long long entries) {
+        long long leafHalf = std::max(1, (FileSystem::contentsPerBlock(sb) + 1) / 2);
+        long long capacity = indexCapacity(sb);
+        long long fan = std::max(2LL, (capacity + 1) / 2);
+        long long level = std::max(1LL, (entries + leafHalf - 1) / leafHalf);
+        long long total = 2 + level;
+        while (level > capacity) {
+            level = (level + fan - 1) / fan;
+            total += level + 1;     // +1: la raíz se vacía en dos nodos al partirse
+        }
+        return total;
+    }
+
+    // Convertir una carpeta lineal en indexada: "." y ".." quedan solos en el
+    // bloque 0, el bloque 1 pasa a ser la raíz y las demás entradas se vuelven
+    // a insertar en hojas. Antes de tocar nada se agregan a la carpeta (como
+    // bloques lineales vacíos) los que pueda necesitar el índice: si no hay
+    // lugar, la carpeta sigue lineal y completa. Los bloques que sobran
+    // quedan vacíos al final de la carpeta para cuando crezca
+    inline std::string convertToIndexed(Context& ctx, int dirIndex, Inode& dir) {
+        int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+        std::vector<int> blocks;
+        std::vector<Content> moved;
+        int parent = dirIndex;
+        for (long long logical = 0; ; logical++) {
+            int b = blockAt(ctx, dir, logical);
+            if (b == -1) {
+                break;
+            }
+            blocks.push_back(b);
+            FileSystem::Block block = readBlock(ctx, b);
+            for (int k = 0; k < perBlock; k++) {
+                Content& entry = block.contents()[k];
+                std::string name = entryName(entry);
+                if (entry.b_inodo == -1 || name == ".") {
+                    continue;
+                }
+                if (name == "..") {
+                    parent = entry.b_inodo;
+                } else {
+                    moved.push_back(entry);
+                }
+            }
+        }
+        if (blocks.size() < 3) {
+            return "Error: la carpeta es demasiado pequeña para indexarla";
+        }
+        long long needed = indexedBlocksBound(ctx.sb, static_cast<long long>(moved.size()));
+        while (static_cast<long long>(blocks.size()) < needed) {
+            int b = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, dirIndex);
+            if (b == -1) {
+                return "Error: no hay bloques libres";
+            }
+            FileSystem::Block empty(ctx.sb.s_block_size);
+            empty.initFolder();
+            writeMetadataBlock(ctx, b, empty);
+            if (!mapBlock(ctx, dirIndex, dir, static_cast<long long>(blocks.size()), b)) {
+                Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, b);
+                return "Error: la carpeta no admite más entradas";
+            }
+            blocks.push_back(b);
+        }
+
+        FileSystem::Block first(ctx.sb.s_block_size);
+        first.initFolder();
+        std::strncpy(first.contents()[0].b_name, ".", sizeof(first.contents()[0].b_name));
+        first.contents()[0].b_inodo = dirIndex;
+        std::strncpy(first.contents()[1].b_name, "..", sizeof(first.contents()[1].b_name));
+        first.contents()[1].b_inodo = parent;
+        writeMetadataBlock(ctx, blocks[0], first);
+
+        FileSystem::Block empty(ctx.sb.s_block_size);
+        empty.initFolder();
+        for (size_t k = 2; k < blocks.size(); k++) {
+            writeMetadataBlock(ctx, blocks[k], empty);
+        }
+
+        IndexHeader root{};
+        root.blocks = 3;
+        writeIndexNode(ctx, blocks[1], root, {IndexEntry{0, blocks[2]}});
+        dir.i_flags |= INODE_FLAG_INDEX;
+
+        for (const Content& entry : moved) {
+            std::string error = addIndexedEntry(ctx, dirIndex, dir, entryName(entry), entry.b_inodo);
+            if (!error.empty()) {
+                return error;
+            }
+        }
+        return "";
+    }
+
+    // Ubicar 'name' en la carpeta: bloque y ranura, o false si no existe. En
+    // una carpeta indexada solo se lee el camino hasta su hoja
+    inline bool findEntry(Context& ctx, const Inode& dir, const std::string& name, int& b, int& slot) {
+        int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+        if (isIndexed(dir)) {
+            b = findLeaf(ctx, dir, nameHash(name));
+            if (b == -1) {
+                return false;
+            }
+            FileSystem::Block block = readBlock(ctx, b);
+            slot = findInBlock(block, perBlock, name);
+            return slot != -1;
+        }
+        for (long long logical = 0; ; logical++) {
+            b = blockAt(ctx, dir, logical);
+            if (b == -1) {
+                return false;
+            }
+            FileSystem::Block block = readBlock(ctx, b);
+            slot = findInBlock(block, perBlock, name);
+            if (slot != -1) {
+                return true;
+            }
+        }
+    }
+
+    // Buscar 'name' en los bloques de la carpeta; devuelve el inodo o -1
+    inline int scanDirectory(Context& ctx, const Inode& dir, const std::string& name) {
+        int b;
+        int slot;
+        if (!findEntry(ctx, dir, name, b, slot)) {
+            return -1;
+        }
+        return readBlock(ctx, b).contents()[slot].b_inodo;
+    }
+
+    // Buscar 'name' dentro de la carpeta 'dirIndex'; devuelve el inodo o -1.
+    // El resultado, positivo o negativo, queda en la caché de entradas
+    inline int lookup(Context& ctx, int dirIndex, const Inode& dir, const std::string& name) {
+        int inode;
+        if (DentryCache::lookup(ctx.path, ctx.partStart, dirIndex, name, inode)) {
+            return inode == DentryCache::NEGATIVE ? -1 : inode;
+        }
+        inode = scanDirectory(ctx, dir, name);
+        DentryCache::insert(ctx.path, ctx.partStart, dirIndex, name,
+                            inode == -1 ? DentryCache::NEGATIVE : inode);
+        return inode;
+    }
+
+    // Agregar la entrada 'name' -> 'child' a la carpeta 'dirIndex'. Usa la
+    // primera ranura libre o agrega un bloque de carpeta nuevo
+    inline std::string addEntry(Context& ctx, int dirIndex, Inode& dir, const std::string& name, int child) {
+        int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+        if (isIndexed(dir)) {
+            std::string error = addIndexedEntry(ctx, dirIndex, dir, name, child);
+            dir.i_mtime = time(nullptr);
+            writeInode(ctx, dirIndex, dir);
+            if (error.empty()) {
+                DentryCache::insert(ctx.path, ctx.partStart, dirIndex, name, child);
+            }
+            return error;
+        }
+
+        long long logical = 0;
+        for (; ; logical++) {
+            int b = blockAt(ctx, dir, logical);
+            if (b == -1) {
+                break;
+            }
+            FileSystem::Block block = readBlock(ctx, b);
+            if (putEntry(block, perBlock, name, child)) {
+                dir.i_mtime = time(nullptr);
+                writeMetadataBlock(ctx, b, block);
+                writeInode(ctx, dirIndex, dir);
+                DentryCache::insert(ctx.path, ctx.partStart, dirIndex, name, child);
+                return "";
+            }
+        }
+
+        // Carpeta grande y llena: pasa a indexada
+        if ((ctx.sb.s_feature_compat & FS_FEATURE_DIR_INDEX) && logical >= INDEX_THRESHOLD) {
+            if (convertToIndexed(ctx, dirIndex, dir).empty()) {
+                return addEntry(ctx, dirIndex, dir, name, child);
+            }
+            // Sin lugar para el índice la carpeta sigue lineal: la entrada va
+            // al primer bloque vacío que haya quedado agregado o a uno nuevo
+            int b = blockAt(ctx, dir, logical);
+            if (b != -1) {
+                FileSystem::Block block = readBlock(ctx, b);
+                putEntry(block, perBlock, name, child);
+                dir.i_mtime = time(nullptr);
+                writeMetadataBlock(ctx, b, block);
+                writeInode(ctx, dirIndex, dir);
+                DentryCache::insert(ctx.path, ctx.partStart, dirIndex, name, child);
+                return "";
+            }
+        }
+
+        // Carpeta llena: nuevo bloque de carpeta
+        int b = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, dirIndex);
+        if (b == -1) {
+            return "Error: no hay bloques libres";
+        }
+        FileSystem::Block block(ctx.sb.s_block_size);
+        block.initFolder();
+        std::strncpy(block.contents()[0].b_name, name.c_str(), sizeof(block.contents()[0].b_name));
+        block.contents()[0].b_inodo = child;
+        writeMetadataBlock(ctx, b, block);
+        if (!mapBlock(ctx, dirIndex, dir, logical, b)) {
+            Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, b);
+            return "Error: la carpeta no admite más entradas";
+        }
+        dir.i_mtime = time(nullptr);
+        writeInode(ctx, dirIndex, dir);
+        DentryCache::insert(ctx.path, ctx.partStart, dirIndex, name, child);
+        return "";
+    }
+
+    // Sacar del índice la hoja vacía que cubre 'hash': su rango pasa a la hoja
+    // anterior del mismo nodo. El bloque queda vacío en la carpeta; si la hoja
+    // es la única de su nodo, se conserva
+    inline void dropEmptyLeaf(Context& ctx, const Inode& dir, uint32_t hash) {
+        std::vector<IndexStep> path;
+        if (findLeaf(ctx, dir, hash, &path) == -1 || path.back().count < 2) {
+            return;
+        }
+        FileSystem::Block block = readBlock(ctx, path.back().block);
+        IndexHeader header = readIndexHeader(block);
+        std::vector<IndexEntry> entries = readIndexEntries(block, header);
+        entries.erase(entries.begin() + path.back().position);
+        writeIndexNode(ctx, path.back().block, header, entries);
+    }
+
+    // Quitar la entrada 'name' de la carpeta 'dirIndex'. Devuelve su inodo o -1.
+    // En una carpeta indexada, la hoja que queda vacía sale del índice
+    inline int removeEntry(Context& ctx, int dirIndex, Inode& dir, const std::string& name) {
+        int b;
+        int slot;
+        if (!findEntry(ctx, dir, name, b, slot)) {
+            return -1;
+        }
+        FileSystem::Block block = readBlock(ctx, b);
+        int child = block.contents()[slot].b_inodo;
+        block.contents()[slot] = Content();
+        writeMetadataBlock(ctx, b, block);
+        if (isIndexed(dir)) {
+            int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+            bool empty = true;
+            for (int k = 0; k < perBlock && empty; k++) {
+                empty = block.contents()[k].b_inodo == -1;
+            }
+            if (empty) {
+                dropEmptyLeaf(ctx, dir, nameHash(name));
+            }
+        }
+        dir.i_mtime = time(nullptr);
+        writeInode(ctx, dirIndex, dir);
+        DentryCache::insert(ctx.path, ctx.partStart, dirIndex, name, DentryCache::NEGATIVE);
+        return child;
+    }
+
+    // Inodo nuevo con los valores por defecto (propietario root)
+    inline Inode newInode(char type) {
+        Inode inode;
+        inode.i_uid = 1;
+        inode.i_gid = 1;
+        inode.i_size = 0;
+        inode.i_type = type;
+        inode.i_perm = 664;
+        return inode;
+    }
+
+    // Crear la carpeta 'name' dentro de 'parentIndex'. Devuelve el inodo o -1
+    inline int createDirectory(Context& ctx, int parentIndex, Inode& parent,
+                               const std::string& name, std::string& error) {
+        int child = Allocator::allocateInode(ctx.path, ctx.partStart, ctx.sb, parentIndex, true);
+        if (child == -1) {
+            error = "Error: no hay inodos libres";
+            return -1;
+        }
+        int b = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, child);
+        if (b == -1) {
+            Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, child, true);
+            error = "Error: no hay bloques libres";
+            return -1;
+        }
+
+        // Bloque con "." y ".."
+        FileSystem::Block block(ctx.sb.s_block_size);
+        block.initFolder();
+        Content* entries = block.contents();
+        std::strncpy(entries[0].b_name, ".", sizeof(entries[0].b_name));
+        entries[0].b_inodo = child;
+        std::strncpy(entries[1].b_name, "..", sizeof(entries[1].b_name));
+        entries[1].b_inodo = parentIndex;
+        writeMetadataBlock(ctx, b, block);
+
+        Inode inode = newInode('1');
+        inode.i_block[0] = b;
+        writeInode(ctx, child, inode);
+
+        error = addEntry(ctx, parentIndex, parent, name, child);
+        if (!error.empty()) {
+            Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, b);
+            Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, child, true);
+            return -1;
+        }
+        return child;
+    }
+
+    // Resolver una ruta absoluta completa. Devuelve el inodo o -1
+    inline int resolvePath(Context& ctx, const std::string& path, std::string& error) {
+        std::vector<std::string> parts;
+        error = splitPath(path, parts);
+        if (!error.empty()) {
+            return -1;
+        }
+        if (parts.empty()) {
+            return 0;
+        }
+        int current = 0;
+        Inode dir = readInode(ctx, current);
+        for (size_t k = 0; k < parts.size(); k++) {
+            if (dir.i_type != '1') {
+                error = "Error: '" + parts[k - 1] + "' no es una carpeta";
+                return -1;
+            }
+            current = lookup(ctx, current, dir, parts[k]);
+            if (current == -1) {
+                error = "Error: no existe '" + path + "'";
+                return -1;
+            }
+            dir = readInode(ctx, current);
+        }
+        return current;
+    }
+
+    // Resolver las carpetas de 'parts' (todas menos la última), creando las que
+    // falten si 'createParents'. Devuelve el inodo de la carpeta padre o -1
+    inline int resolveParent(Context& ctx, const std::vector<std::string>& parts, bool createParents,
+                             std::string& error, int* created = nullptr) {
+        int current = 0;   // Raíz
+        Inode dir = readInode(ctx, current);
+        for (size_t k = 0; k + 1 < parts.size(); k++) {
+            int next = lookup(ctx, current, dir, parts[k]);
+            if (next == -1) {
+                if (!createParents) {
+                    error = "Error: la carpeta '" + parts[k] + "' no existe (use -p o -r para crearla)";
+                    return -1;
+                }
+                next = createDirectory(ctx, current, dir, parts[k], error);
+                if (next == -1) {
+                    return -1;
+                }
+                if (created) {
+                    (*created)++;
+                }
+            }
+            current = next;
+            dir = readInode(ctx, current);
+            if (dir.i_type != '1') {
+                error = "Error: '" + parts[k] + "' no es una carpeta";
+                return -1;
+            }
+        }
+        return current;
+    }
+
+    // Pasar un archivo con datos en línea a bloques (cuando crece más allá de
+    // i_block). El contenido actual queda en el bloque lógico 0
+    inline std::string convertInline(Context& ctx, int inodeIndex, Inode& inode) {
+        std::string content = FileSystem::readInlineData(inode);
+        inode.i_flags &= ~INODE_FLAG_INLINE_DATA;
+        for (int& b : inode.i_block) {
+            b = -1;
+        }
+        if (ctx.sb.s_feature_compat & FS_FEATURE_EXTENTS) {
+            Extents::initRoot(inode);
+        }
+        if (content.empty()) {
+            return "";
+        }
+
+        int b = Allocator::allocateBlock(ctx.path, ctx.partStart, ctx.sb, inodeIndex);
+        if (b == -1) {
+            FileSystem::writeInlineData(inode, content);
+            return "Error: no hay bloques libres";
+        }
+        FileSystem::Block block(ctx.sb.s_block_size);
+        std::memcpy(block.data.data(), content.data(), content.size());
+        writeDataBlock(ctx, b, block);
+        if (!mapBlock(ctx, inodeIndex, inode, 0, b)) {
+            Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, b);
+            FileSystem::writeInlineData(inode, content);
+            return "Error: no hay bloques libres";
+        }
+        writeInode(ctx, inodeIndex, inode);
+        return "";
+    }
+
+    // Contenido completo de un archivo. Con datos en línea basta el inodo
+    inline std::string readFileData(Context& ctx, const Inode& inode) {
+        if (FileSystem::hasInlineData(inode)) {
+            return FileSystem::readInlineData(inode);
+        }
+        std::string content;
+        content.reserve(inode.i_size);
+        for (long long logical = 0; static_cast<long long>(content.size()) < inode.i_size; logical++) {
+            int b = blockAt(ctx, inode, logical);
+            if (b == -1) {
+                content.append(ctx.sb.s_block_size, '\0');
+            } else {
+                FileSystem::Block block = readBlock(ctx, b);
+                content.append(block.data.data(), block.size());
+            }
+        }
+        content.resize(inode.i_size);
+        return content;
+    }
+
+    // Recorrer los bloques del inodo en orden lógico hasta 'limit', entregando
+    // tramos de bloques físicos consecutivos: fn(lógico, físico, cantidad).
+    // Los huecos llegan con físico -1. Cada bloque de apuntadores se lee una
+    // sola vez. Devuelve false si fn pidió detenerse
+    inline bool forEachRun(Context& ctx, const Inode& inode, long long limit,
+                           const std::function<bool(long long, int, int)>& fn) {
+        long long next = 0;         // Siguiente bloque lógico
+        long long runLogical = 0;
+        int runPhysical = -1;
+        int runCount = 0;
+        bool keepGoing = true;
+
+        auto flush = [&]() {
+            if (runCount > 0 && keepGoing) {
+                keepGoing = fn(runLogical, runPhysical, runCount);
+            }
+            runCount = 0;
+        };
+        // Agregar 'count' bloques desde 'physical' (-1: hueco)
+        auto emit = [&](int physical, long long count) {
+            count = std::min(count, limit - next);
+            while (count > 0 && keepGoing) {
+                bool follows = runCount > 0 && runCount < INT32_MAX &&
+                               (physical == -1 ? runPhysical == -1
+                                               : runPhysical != -1 && physical == runPhysical + runCount);
+                if (!follows) {
+                    flush();
+                    runLogical = next;
+                    runPhysical = physical;
+                }
+                int piece = static_cast<int>(std::min<long long>(count, INT32_MAX - runCount));
+                runCount += piece;
+                next += piece;
+                count -= piece;
+                if (physical != -1) {
+                    physical += piece;
+                }
+            }
+        };
+
+        if (FileSystem::hasInlineData(inode)) {
+            return true;
+        }
+        if (Extents::usesExtents(inode)) {
+            std::vector<Extents::Extent> extents;
+            std::vector<int> treeBlocks;
+            Extents::collect(ctx.sb, inode, blockReader(ctx), extents, treeBlocks);
+            for (const Extents::Extent& e : extents) {
+                if (next >= limit || !keepGoing) {
+                    break;
+                }
+                if (e.logical > next) {
+                    emit(-1, e.logical - next);
+                }
+                emit(e.physical, e.length);
+            }
+        } else {
+            long long per = FileSystem::pointersPerBlock(ctx.sb);
+            std::function<void(int, int)> walk = [&](int b, int level) {
+                long long span = 1;
+                for (int k = 0; k < level; k++) {
+                    span *= per;
+                }
+                if (b == -1 || level == 0) {
+                    emit(b, span);
+                    return;
+                }
+                FileSystem::Block block = readBlock(ctx, b);
+                for (long long k = 0; k < per && next < limit && keepGoing; k++) {
+                    walk(block.pointers()[k], level - 1);
+                }
+            };
+            for (int slot = 0; slot < 15 && next < limit && keepGoing; slot++) {
+                walk(inode.i_block[slot], slot < DIRECT_POINTERS ? 0 : slot - DIRECT_POINTERS + 1);
+            }
+        }
+        if (next < limit) {
+            emit(-1, limit - next);
+        }
+        flush();
+        return keepGoing;
+    }
+
+    // Bloques de apuntadores o nodos del árbol de extents del inodo (no de datos)
+    inline std::vector<int> mappingBlocks(Context& ctx, const Inode& inode) {
+        std::vector<int> blocks;
+        if (FileSystem::hasInlineData(inode)) {
+            return blocks;
+        }
+        if (Extents::usesExtents(inode)) {
+            std::vector<Extents::Extent> extents;
+            Extents::collect(ctx.sb, inode, blockReader(ctx), extents, blocks);
+            return blocks;
+        }
+        int per = FileSystem::pointersPerBlock(ctx.sb);
+        std::function<void(int, int)> walk = [&](int b, int level) {
+            if (b == -1) {
+                return;
+            }
+            blocks.push_back(b);
+            if (level > 1) {
+                FileSystem::Block block = readBlock(ctx, b);
+                for (int k = 0; k < per; k++) {
+                    walk(block.pointers()[k], level - 1);
+                }
+            }
+        };
+        for (int slot = DIRECT_POINTERS; slot < 15; slot++) {
+            walk(inode.i_block[slot], slot - DIRECT_POINTERS + 1);
+        }
+        return blocks;
+    }
+
+    // Bloques que ocupa el inodo en el disco (datos más apuntadores o nodos
+    // del árbol). En un archivo disperso es menos que i_size / tamaño de bloque.
+    // Se recorre todo el mapa: las carpetas no llevan la cuenta en i_size
+    inline long long allocatedBlocks(Context& ctx, const Inode& inode) {
+        if (FileSystem::hasInlineData(inode)) {
+            return 0;
+        }
+        long long blocks = Extents::usesExtents(inode) ? INT32_MAX : maxBlocks(ctx.sb);
+        long long allocated = static_cast<long long>(mappingBlocks(ctx, inode).size());
+        forEachRun(ctx, inode, blocks, [&](long long, int physical, int count) {
+            if (physical != -1) {
+                allocated += count;
+            }
+            return true;
+        });
+        return allocated;
+    }
+
+    // Asociar 'count' bloques físicos contiguos desde 'physical' a los lógicos
+    // desde 'logical', con extents o bloque por bloque según el inodo
+    inline bool mapRun(Context& ctx, int inodeIndex, Inode& inode, long long logical, int physical, int count) {
+        if (Extents::usesExtents(inode)) {
+            return mapExtent(ctx, inodeIndex, inode, logical, physical, count);
+        }
+        for (int k = 0; k < count; k++) {
+            if (!mapBlock(ctx, inodeIndex, inode, logical + k, physical + k)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Soltar todo el contenido del inodo: cada bloque de datos pierde una
+    // referencia (uno compartido con una copia sigue siendo de ella) y los de
+    // apuntadores o del árbol se liberan. El inodo queda vacío con su formato.
+    // De una carpeta se recorre todo el mapa (i_size no cuenta sus bloques)
+    inline void releaseData(Context& ctx, Inode& inode) {
+        if (FileSystem::hasInlineData(inode)) {
+            FileSystem::writeInlineData(inode, "");
+            return;
+        }
+        long long blocks = inode.i_type == '1'
+            ? (Extents::usesExtents(inode) ? INT32_MAX : maxBlocks(ctx.sb))
+            : (static_cast<long long>(inode.i_size) + ctx.sb.s_block_size - 1) / ctx.sb.s_block_size;
+        forEachRun(ctx, inode, blocks, [&](long long, int physical, int count) {
+            if (physical != -1) {
+                Refcount::release(ctx.path, ctx.partStart, ctx.sb, physical, count);
+            }
+            return true;
+        });
+        for (int b : mappingBlocks(ctx, inode)) {
+            Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, b);
+        }
+        bool extents = Extents::usesExtents(inode);
+        for (int& b : inode.i_block) {
+            b = -1;
+        }
+        if (extents) {
+            Extents::initRoot(inode);
+        }
+        inode.i_size = 0;
+    }
+
+    // Escribir 'content' como contenido de un archivo; el contenido anterior
+    // se reemplaza (sus bloques compartidos con una copia quedan para ella,
+    // así que modificar cualquiera de los dos lados no toca al otro). Los
+    // bloques se piden en tramos contiguos (cada uno sigue al anterior si
+    // puede) y cada tramo se escribe de una vez
+    inline std::string writeFileData(Context& ctx, int inodeIndex, Inode& inode, const std::string& content) {
+        int blockSize = ctx.sb.s_block_size;
+        long long count = (static_cast<long long>(content.size()) + blockSize - 1) / blockSize;
+        // Antes de soltar el contenido anterior: si no cabe, el inodo queda como estaba
+        if (!fitsInInode(ctx.sb, inode, static_cast<long long>(content.size()))) {
+            return "Error: el archivo supera el tamaño máximo que admite un inodo";
+        }
+        // Un archivo pequeño se queda dentro del inodo; uno más grande deja de
+        // estar en línea
+        if (FileSystem::hasInlineData(inode)) {
+            if (static_cast<int>(content.size()) <= FileSystem::inlineCapacity()) {
+                FileSystem::writeInlineData(inode, content);
+                inode.i_mtime = time(nullptr);
+                writeInode(ctx, inodeIndex, inode);
+                return "";
+            }
+            FileSystem::writeInlineData(inode, "");
+            std::string error = convertInline(ctx, inodeIndex, inode);
+            if (!error.empty()) {
+                writeInode(ctx, inodeIndex, inode);
+                return error;
+            }
+        } else if (inode.i_size > 0) {
+            releaseData(ctx, inode);
+        }
+
+        int goal = -1;
+        for (long long logical = 0; logical < count; ) {
+            int run = 0;
+            int first = Allocator::allocateRun(ctx.path, ctx.partStart, ctx.sb, inodeIndex, goal,
+                                               static_cast<int>(count - logical), run);
+            if (first == -1) {
+                writeInode(ctx, inodeIndex, inode);
+                return "Error: no hay bloques libres";
+            }
+            size_t offset = static_cast<size_t>(logical * blockSize);
+            size_t length = std::min(static_cast<size_t>(run) * blockSize, content.size() - offset);
+            std::vector<char> data(static_cast<size_t>(run) * blockSize, 0);
+            std::memcpy(data.data(), content.data() + offset, length);
+            BufferCache::write(ctx.path, FileSystem::blockOffset(ctx.sb, first), data.data(), data.size());
+
+            int mapped = 0;
+            if (Extents::usesExtents(inode)) {
+                mapped = mapExtent(ctx, inodeIndex, inode, logical, first, run) ? run : 0;
+            } else {
+                while (mapped < run && mapBlock(ctx, inodeIndex, inode, logical + mapped, first + mapped)) {
+                    mapped++;
+                }
+            }
+            if (mapped < run) {
+                for (int k = mapped; k < run; k++) {
+                    Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, first + k);
+                }
+                inode.i_size = static_cast<int>(std::min(content.size(), offset + static_cast<size_t>(mapped) * blockSize));
+                writeInode(ctx, inodeIndex, inode);
+                return "Error: no hay bloques libres";
+            }
+            inode.i_size = static_cast<int>(offset + length);
+            logical += run;
+            goal = first + run;
+        }
+        inode.i_mtime = time(nullptr);
+        writeInode(ctx, inodeIndex, inode);
+        return "";
+    }
+
+    // Llevar el archivo a 'size' bytes sin asignar bloques: lo agregado es un
+    // hueco que se lee como ceros (archivo disperso). Si todavía cabe en el
+    // inodo, los ceros se guardan en línea
+    inline std::string extendSparse(Context& ctx, int inodeIndex, Inode& inode, long long size) {
+        if (size <= inode.i_size) {
+            return "";
+        }
+        if (FileSystem::hasInlineData(inode)) {
+            if (size <= FileSystem::inlineCapacity()) {
+                std::string content = FileSystem::readInlineData(inode);
+                content.resize(static_cast<size_t>(size), '\0');
+                FileSystem::writeInlineData(inode, content);
+                inode.i_mtime = time(nullptr);
+                writeInode(ctx, inodeIndex, inode);
+                return "";
+            }
+            std::string error = convertInline(ctx, inodeIndex, inode);
+            if (!error.empty()) {
+                return error;
+            }
+        }
+        if (!fitsInInode(ctx.sb, inode, size)) {
+            return "Error: el archivo supera el tamaño máximo que admite un inodo";
+        }
+        inode.i_size = static_cast<int>(size);
+        inode.i_mtime = time(nullptr);
+        writeInode(ctx, inodeIndex, inode);
+        return "";
+    }
+
+    // Inodo de archivo vacío con el formato del sistema de archivos
+    inline Inode newFileInode(const Superblock& sb) {
+        Inode inode = newInode('0');
+        if (sb.s_feature_compat & FS_FEATURE_INLINE_DATA) {
+            FileSystem::writeInlineData(inode, "");
+        } else if (sb.s_feature_compat & FS_FEATURE_EXTENTS) {
+            Extents::initRoot(inode);
+        }
+        return inode;
+    }
+
+    // Crear el archivo 'name' dentro de 'parentIndex' con el contenido dado.
+    // Si el contenido no se puede escribir no queda nada: ni la entrada, ni
+    // el inodo, ni los bloques que llegó a usar
+    inline int createFile(Context& ctx, int parentIndex, Inode& parent, const std::string& name,
+                          const std::string& content, std::string& error) {
+        Inode inode = newFileInode(ctx.sb);
+        if (!fitsInInode(ctx.sb, inode, static_cast<long long>(content.size()))) {
+            error = "Error: el archivo supera el tamaño máximo que admite un inodo";
+            return -1;
+        }
+        int child = Allocator::allocateInode(ctx.path, ctx.partStart, ctx.sb, parentIndex, false);
+        if (child == -1) {
+            error = "Error: no hay inodos libres";
+            return -1;
+        }
+        writeInode(ctx, child, inode);
+
+        error = addEntry(ctx, parentIndex, parent, name, child);
+        if (!error.empty()) {
+            Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, child, false);
+            return -1;
+        }
+        error = writeFileData(ctx, child, inode, content);
+        if (!error.empty()) {
+            removeEntry(ctx, parentIndex, parent, name);
+            releaseData(ctx, inode);
+            writeInode(ctx, child, inode);
+            Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, child, false);
+            return -1;
+        }
+        return child;
+    }
+
+    // Marcar el fin de la operación para el journal (commit agrupado en EXT3).
+    // Si la transacción se va a confirmar, antes entran los inodos sucios
+    inline void finish(Context& ctx) {
+        if (Journal::commitDue(ctx.path, ctx.partStart, ctx.sb)) {
+            InodeCache::flush(ctx.path, ctx.partStart);
+        }
+        Journal::endOperation(ctx.path, ctx.partStart, ctx.sb);
+    }
+
+} // namespace FileOps
+
+#endif // FILEOPS_H
@@ -0,0 +1,302 @@
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+
+#include <iostream>   // Flujos de entrada/salida
+#include <fstream>    // Manejo de archivos
+#include <vector>     // Vectores dinámicos
+#include <cstring>    // memcpy
+#include <string>     // Datos en línea
+#include <algorithm>  // std::min / std::max
+#include <cstddef>    // offsetof
+#include "structures.h"
+
+// Acceso a las estructuras de un sistema de archivos formateado. Los bloques
+// miden s_block_size bytes en disco; FileSystem::Block los lee con vistas de
+// carpeta (Content), de apuntadores o de contenido para cualquier tamaño
+namespace FileSystem {
+
+    // Tamaños de bloque aceptados por mkfs -bs
+    inline bool isValidBlockSize(int blockSize) {
+        return blockSize == 64 || blockSize == 256 || blockSize == 1024 || blockSize == 4096;
+    }
+
+    // Entradas (Content) que caben en un bloque de carpeta
+    inline int contentsPerBlock(const Superblock& sb) {
+        return sb.s_block_size / static_cast<int>(sizeof(Content));
+    }
+
+    // Apuntadores que caben en un bloque de apuntadores
+    inline int pointersPerBlock(const Superblock& sb) {
+        return sb.s_block_size / static_cast<int>(sizeof(int));
+    }
+
+    // Datos en línea: un archivo de hasta sizeof(i_block) bytes puede guardar
+    // su contenido en i_block en vez de usar bloques
+    inline int inlineCapacity() {
+        return static_cast<int>(sizeof(Inode::i_block));
+    }
+
+    inline bool hasInlineData(const Inode& inode) {
+        return (inode.i_flags & INODE_FLAG_INLINE_DATA) != 0;
+    }
+
+    inline std::string readInlineData(const Inode& inode) {
+        int size = std::max(0, std::min(inode.i_size, inlineCapacity()));
+        return std::string(reinterpret_cast<const char*>(inode.i_block), size);
+    }
+
+    // Guardar 'content' (que debe caber) en i_block y marcar el inodo
+    inline void writeInlineData(Inode& inode, const std::string& content) {
+        std::memset(inode.i_block, 0, sizeof(inode.i_block));
+        std::memcpy(inode.i_block, content.data(), content.size());
+        inode.i_size = static_cast<int>(content.size());
+        inode.i_flags = (inode.i_flags & ~INODE_FLAG_EXTENTS) | INODE_FLAG_INLINE_DATA;
+    }
+
+    // Grupos de bloques. La distribución clásica es un único grupo cuyas
+    // áreas son las que indica el Superbloque; con varios grupos, el grupo g
+    // repite esa distribución desplazada g * s_group_size bytes
+    inline bool hasGroups(const Superblock& sb) {
+        return sb.s_groups_count > 1;
+    }
+
+    inline int groupsCount(const Superblock& sb) {
+        return hasGroups(sb) ? sb.s_groups_count : 1;
+    }
+
+    inline int inodesPerGroup(const Superblock& sb) {
+        return hasGroups(sb) ? sb.s_inodes_per_group : sb.s_inodes_count;
+    }
+
+    inline int blocksPerGroup(const Superblock& sb) {
+        return hasGroups(sb) ? sb.s_blocks_per_group : sb.s_blocks_count;
+    }
+
+    inline int inodeGroup(const Superblock& sb, int i) {
+        return hasGroups(sb) ? i / sb.s_inodes_per_group : 0;
+    }
+
+    inline int blockGroup(const Superblock& sb, int b) {
+        return hasGroups(sb) ? b / sb.s_blocks_per_group : 0;
+    }
+
+    // Desplazamiento del grupo g respecto al grupo 0
+    inline long long groupShift(const Superblock& sb, int g) {
+        return hasGroups(sb) ? static_cast<long long>(g) * sb.s_group_size : 0;
+    }
+
+    inline long long groupInodeBitmap(const Superblock& sb, int g) {
+        return sb.s_bm_inode_start + groupShift(sb, g);
+    }
+
+    inline long long groupBlockBitmap(const Superblock& sb, int g) {
+        return sb.s_bm_block_start + groupShift(sb, g);
+    }
+
+    inline long long groupInodeTable(const Superblock& sb, int g) {
+        return sb.s_inode_start + groupShift(sb, g);
+    }
+
+    inline long long groupBlockStart(const Superblock& sb, int g) {
+        return sb.s_block_start + groupShift(sb, g);
+    }
+
+    // Posición en disco del inodo i
+    inline long long inodeOffset(const Superblock& sb, int i) {
+        int g = inodeGroup(sb, i);
+        int local = i - g * inodesPerGroup(sb);
+        return groupInodeTable(sb, g) + static_cast<long long>(local) * sb.s_inode_size;
+    }
+
+    // Posición en disco del bloque b
+    inline long long blockOffset(const Superblock& sb, int b) {
+        int g = blockGroup(sb, b);
+        int local = b - g * blocksPerGroup(sb);
+        return groupBlockStart(sb, g) + static_cast<long long>(local) * sb.s_block_size;
+    }
+
+    // Posición en disco del descriptor del grupo g
+    inline long long groupDescriptorOffset(const Superblock& sb, int g) {
+        return sb.s_gdt_start + static_cast<long long>(g) * sizeof(GroupDescriptor);
+    }
+
+    // Superbloque clásico: los campos hasta s_block_start. Un sistema de
+    // archivos formateado sin la extensión tiene justo después el bitmap de
+    // inodos en ASCII, así que lo que se lea más allá no le pertenece
+    const int CLASSIC_SUPERBLOCK_SIZE = offsetof(Superblock, s_rev_level);
+
+    // Máximo de inodos o de bloques que se acepta al leer un Superbloque
+    const int MAX_OBJECTS = 1 << 28;
+
+    // ¿Trae el Superbloque los campos desde s_rev_level? Tanto s_rev_level
+    // (0 o 1) como s_sb_size tienen bytes que no pueden salir de un bitmap
+    // ASCII ('0' = 0x30, '1' = 0x31)
+    inline bool hasExtension(const Superblock& sb) {
+        return (sb.s_rev_level == FS_REV_ASCII_BITMAPS || sb.s_rev_level == FS_REV_PACKED_BITMAPS) &&
+               sb.s_sb_size == static_cast<int>(sizeof(Superblock));
+    }
+
+    // Bytes que ocupa el Superbloque en disco (los que se deben reescribir)
+    inline int superblockSize(const Superblock& sb) {
+        return hasExtension(sb) ? static_cast<int>(sizeof(Superblock)) : CLASSIC_SUPERBLOCK_SIZE;
+    }
+
+    // Completar un Superbloque recién leído: sin la marca de la extensión se
+    // conservan solo los campos clásicos y el resto toma los valores de la
+    // distribución clásica (un grupo, sin journal ni características)
+    inline void normalizeSuperblock(Superblock& sb) {
+        if (hasExtension(sb)) {
+            return;
+        }
+        Superblock classic;
+        std::memcpy(static_cast<void*>(&classic), &sb, CLASSIC_SUPERBLOCK_SIZE);
+        classic.s_sb_size = CLASSIC_SUPERBLOCK_SIZE;
+        classic.s_itable_group_inodes = classic.s_inodes_count;
+        classic.s_inodes_per_group = classic.s_inodes_count;
+        classic.s_blocks_per_group = classic.s_blocks_count;
+        sb = classic;
+    }
+
+    // ¿Están los valores dentro de rango? Se revisa antes de reservar memoria
+    // o calcular posiciones con ellos. Con 'partSize' (0 si no se conoce) las
+    // áreas deben caber además dentro de la partición
+    inline bool isValidSuperblock(const Superblock& sb, int partStart, long long partSize = 0) {
+        if (sb.s_magic != 0xEF53 || !isValidBlockSize(sb.s_block_size) ||
+            sb.s_inode_size != static_cast<int>(sizeof(Inode)) ||
+            (sb.s_rev_level != FS_REV_ASCII_BITMAPS && sb.s_rev_level != FS_REV_PACKED_BITMAPS)) {
+            return false;
+        }
+        if (sb.s_inodes_count < 2 || sb.s_inodes_count > MAX_OBJECTS ||
+            sb.s_blocks_count < 2 || sb.s_blocks_count > MAX_OBJECTS ||
+            sb.s_free_inodes_count < 0 || sb.s_free_inodes_count > sb.s_inodes_count ||
+            sb.s_free_blocks_count < 0 || sb.s_free_blocks_count > sb.s_blocks_count) {
+            return false;
+        }
+
+        // Áreas del grupo 0 en orden, después del Superbloque
+        long long sbEnd = static_cast<long long>(partStart) + superblockSize(sb);
+        if (sb.s_bm_inode_start < sbEnd || sb.s_bm_block_start <= sb.s_bm_inode_start ||
+            sb.s_inode_start <= sb.s_bm_block_start || sb.s_block_start <= sb.s_inode_start) {
+            return false;
+        }
+        if (sb.s_groups_count < 1 || sb.s_groups_count > sb.s_blocks_count) {
+            return false;
+        }
+        if (hasGroups(sb) &&
+            (sb.s_inodes_per_group < 2 || sb.s_blocks_per_group < 2 || sb.s_group_size <= 0 ||
+             static_cast<long long>(sb.s_inodes_per_group) * sb.s_groups_count != sb.s_inodes_count ||
+             static_cast<long long>(sb.s_blocks_per_group) * sb.s_groups_count != sb.s_blocks_count ||
+             sb.s_gdt_start < sbEnd)) {
+            return false;
+        }
+        if (static_cast<long long>(sb.s_block_start) - sb.s_inode_start <
+            static_cast<long long>(inodesPerGroup(sb)) * sb.s_inode_size) {
+            return false;
+        }
+        if (sb.s_journal_start != -1 && (sb.s_journal_start < sbEnd || sb.s_journal_size <= 0)) {
+            return false;
+        }
+        if (sb.s_itable_groups < 1 || sb.s_itable_groups > 64 || sb.s_itable_group_inodes < 0) {
+            return false;
+        }
+        if ((sb.s_feature_compat & FS_FEATURE_REFLINK) &&
+            (sb.s_refcount_start < sbEnd || sb.s_refcount_size < sb.s_blocks_count)) {
+            return false;
+        }
+
+        if (partSize > 0) {
+            long long end = static_cast<long long>(partStart) + partSize;
+            if (inodeOffset(sb, sb.s_inodes_count - 1) + sb.s_inode_size > end ||
+                blockOffset(sb, sb.s_blocks_count - 1) + sb.s_block_size > end) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Normalizar y revisar un Superbloque leído (sizeof(Superblock) bytes)
+    inline bool acceptSuperblock(Superblock& sb, int partStart, long long partSize = 0) {
+        normalizeSuperblock(sb);
+        return isValidSuperblock(sb, partStart, partSize);
+    }
+
+    // Leer el Superbloque de una partición; false si no está formateada o si
+    // sus valores no son válidos
+    inline bool readSuperblock(std::istream& file, int partStart, Superblock& sb, long long partSize = 0) {
+        file.seekg(partStart, std::ios::beg);
+        file.read(reinterpret_cast<char*>(&sb), sizeof(Superblock));
+        return file.good() && acceptSuperblock(sb, partStart, partSize);
+    }
+
+    // En un sistema de archivos sin la extensión, i_flags era relleno del
+    // inodo clásico: su contenido no significa nada
+    inline void sanitizeInode(const Superblock& sb, Inode& inode) {
+        if (!hasExtension(sb)) {
+            inode.i_flags = 0;
+        }
+    }
+
+    // Bloque de s_block_size bytes con vistas como carpeta, archivo o apuntadores
+    struct Block {
+        std::vector<char> data;
+
+        explicit Block(int blockSize) : data(blockSize, 0) {}
+
+        int size() const { return static_cast<int>(data.size()); }
+
+        Content* contents() { return reinterpret_cast<Content*>(data.data()); }
+        int* pointers() { return reinterpret_cast<int*>(data.data()); }
+
+        // Bloque de carpeta vacío: todas las entradas sin inodo (-1)
+        void initFolder() {
+            Content empty;
+            int count = size() / static_cast<int>(sizeof(Content));
+            for (int i = 0; i < count; i++) {
+                std::memcpy(&data[i * sizeof(Content)], &empty, sizeof(Content));
+            }
+        }
+
+        // Bloque de apuntadores vacío: todos en -1
+        void initPointers() {
+            int count = size() / static_cast<int>(sizeof(int));
+            for (int i = 0; i < count; i++) {
+                pointers()[i] = -1;
+            }
+        }
+    };
+
+    inline Block readBlock(std::istream& file, const Superblock& sb, int b) {
+        Block block(sb.s_block_size);
+        file.seekg(blockOffset(sb, b), std::ios::beg);
+        file.read(block.data.data(), block.size());
+        return block;
+    }
+
+    inline void writeBlock(std::ostream& file, const Superblock& sb, int b, const Block& block) {
+        file.seekp(blockOffset(sb, b), std::ios::beg);
+        file.write(block.data.data(), block.size());
+    }
+
+    inline Inode readInode(std::istream& file, const Superblock& sb, int i) {
+        Inode inode;
+        file.seekg(inodeOffset(sb, i), std::ios::beg);
+        file.read(reinterpret_cast<char*>(&inode), sizeof(Inode));
+        sanitizeInode(sb, inode);
+        return inode;
+    }
+
+    inline void writeInode(std::ostream& file, const Superblock& sb, int i, const Inode& inode) {
+        file.seekp(inodeOffset(sb, i), std::ios::beg);
+        file.write(reinterpret_cast<const char*>(&inode), sizeof(Inode));
+    }
+
+    inline GroupDescriptor readGroupDescriptor(std::istream& file, const Superblock& sb, int g) {
+        GroupDescriptor gd;
+        file.seekg(groupDescriptorOffset(sb, g), std::ios::beg);
+        file.read(reinterpret_cast<char*>(&gd), sizeof(GroupDescriptor));
+        return gd;
+    }
+
+} // namespace FileSystem
+
+#endif // FILESYSTEM_H
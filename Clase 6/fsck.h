@@ -0,0 +1,959 @@
+#ifndef FSCK_H
+#define FSCK_H
+
+#include <string>               // Manejo de la clase std::string
+#include <sstream>              // Construcción del mensaje de resultado
+#include <fstream>              // Lectura de bitmaps, MBR y EBR
+#include <iomanip>              // Formato de los números
+#include <vector>               // Listas de bloques y de problemas
+#include <deque>                // Trozos de la tabla de cada hilo
+#include <map>                  // Problemas por tipo, bloques de cada carpeta
+#include <set>                  // Inodos revisados fuera del bitmap
+#include <memory>               // Arreglos de contadores atómicos
+#include <atomic>               // Contadores compartidos entre hilos
+#include <thread>               // Hilos del chequeo
+#include <mutex>                // Candados de las colas y del informe
+#include <condition_variable>   // Espera de carpetas pendientes
+#include <functional>           // Recorrido de los apuntadores
+#include <algorithm>            // std::min, std::sort
+#include <chrono>               // Medición del tiempo
+#include <cstring>              // memcpy, memset
+#include <cstdint>              // uint16_t
+#include <fcntl.h>              // open
+#include <unistd.h>             // pread, pwrite, close
+#include "structures.h"
+#include "filesystem.h"
+#include "bitmap.h"
+#include "extents.h"
+#include "refcount.h"
+#include "fileops.h"
+#include "allocator.h"
+#include "inode_cache.h"
+#include "dentry_cache.h"
+#include "users.h"
+#include "delalloc.h"
+#include "itable_init.h"
+#include "atime.h"
+#include "buffer_cache.h"
+#include "sync.h"
+#include "mount.h"
+
+// Chequeo de consistencia de una partición formateada. Primero se recorre la
+// tabla de inodos en trozos repartidos entre los hilos (cada hilo empieza con
+// un rango contiguo y, al terminarlo, roba trozos del final de la cola de
+// otro) contando qué bloques usa cada inodo; después varios hilos recorren
+// las carpetas desde la raíz para saber qué inodos son alcanzables. Un inodo
+// válido al que apunta una entrada cuenta como usado aunque el bitmap diga lo
+// contrario (se corrige el bitmap, no se borra la entrada) y los que ninguna
+// carpeta alcanza se cuelgan de /lost+found. Al final se comparan los
+// bitmaps, la tabla de referencias y los contadores del Superbloque y de los
+// grupos con lo encontrado, y con -repair se reescriben
+namespace CommandFsck {
+
+    const int CHUNK_INODES = 2048;      // Inodos por trozo de la tabla
+    const size_t MAX_EXAMPLES = 5;      // Ejemplos que se muestran por tipo de problema
+    const char* const LOST_FOUND = "lost+found";
+
+    // Problemas de un mismo tipo
+    struct Category {
+        long long count = 0;
+        bool repairable = false;
+        std::vector<std::string> examples;
+    };
+
+    // Problemas encontrados (los hilos los agregan a la vez)
+    struct Report {
+        std::mutex mutex;
+        std::map<std::string, Category> categories;
+        long long total = 0;
+
+        void add(const std::string& kind, const std::string& detail, bool repairable) {
+            std::lock_guard<std::mutex> lock(mutex);
+            Category& category = categories[kind];
+            category.count++;
+            category.repairable = repairable;
+            if (category.examples.size() < MAX_EXAMPLES) {
+                category.examples.push_back(detail);
+            }
+            total++;
+        }
+    };
+
+    // Entrada de carpeta que se corrige al reparar
+    struct EntryFix {
+        int block;
+        int slot;
+        int inode;      // Nuevo b_inodo (-1: se borra la entrada)
+    };
+
+    // Entrada que apunta a una carpeta: de todas las de una misma carpeta se
+    // queda la de menor (bloque, ranura)
+    struct DirLink {
+        int block;
+        int slot;
+        int dir;        // Carpeta que contiene la entrada
+        std::string name;
+    };
+
+    // Estado compartido del chequeo
+    struct Check {
+        int fd = -1;
+        Superblock sb;
+        Bitmap::Bits inodeBitmap;
+        Bitmap::Bits blockBitmap;
+        std::vector<unsigned char> refcounts;                   // Tabla de reflink (vacía si no hay)
+        std::unique_ptr<std::atomic<uint16_t>[]> blockRefs;     // Inodos que usan cada bloque
+        std::unique_ptr<std::atomic<int>[]> links;              // Entradas que apuntan a cada inodo
+        std::vector<char> kinds;        // '0' archivo, '1' carpeta, 0 libre o dañado
+        std::map<int, std::vector<int>> dirBlocks;              // Bloques de cada carpeta en orden
+        std::mutex dirMutex;
+        std::set<int> rejected;         // Fuera del bitmap y dañados (protegido por adoptMutex)
+        std::mutex adoptMutex;
+        std::map<int, std::vector<DirLink>> dirLinks;           // Entradas de cada carpeta
+        std::map<int, EntryFix> dotDots;                        // Entrada '..' de cada carpeta
+        std::mutex linkMutex;
+        std::vector<int> lostFound;     // Inodos que se cuelgan de /lost+found
+        std::vector<EntryFix> fixes;
+        std::mutex fixMutex;
+        std::atomic<long long> inodesChecked{0};
+        std::atomic<long long> dirsWalked{0};
+        Report report;
+    };
+
+    inline bool validBlock(const Check& check, int b) {
+        return b >= 0 && b < check.sb.s_blocks_count;
+    }
+
+    inline FileSystem::Block readBlock(const Check& check, int b) {
+        FileSystem::Block block(check.sb.s_block_size);
+        if (validBlock(check, b)) {
+            ssize_t got = pread(check.fd, block.data.data(), block.size(), FileSystem::blockOffset(check.sb, b));
+            (void)got;
+        }
+        return block;
+    }
+
+    // Contar los bloques del inodo (datos, apuntadores y nodos de extents).
+    // Con 'data' se guardan los bloques de datos en orden lógico
+    inline void walkMap(Check& check, int index, const Inode& inode, std::vector<int>* data) {
+        const Superblock& sb = check.sb;
+        long long sizeBlocks = (static_cast<long long>(std::max(0, inode.i_size)) + sb.s_block_size - 1)
+                               / sb.s_block_size;
+        long long beyond = 0;       // Bloques de datos después de i_size
+        auto use = [&](int b, bool isData, long long logical) {
+            if (!validBlock(check, b)) {
+                check.report.add("Apuntadores fuera de la partición",
+                                 "inodo " + std::to_string(index) + " -> bloque " + std::to_string(b), false);
+                return false;
+            }
+            check.blockRefs[b].fetch_add(1, std::memory_order_relaxed);
+            if (isData) {
+                if (data) {
+                    data->push_back(b);
+                }
+                if (inode.i_type == '0' && logical >= sizeBlocks) {
+                    beyond++;
+                }
+            }
+            return true;
+        };
+
+        if (FileSystem::hasInlineData(inode)) {
+            if (inode.i_size < 0 || inode.i_size > FileSystem::inlineCapacity()) {
+                check.report.add("Inodos con tamaño inválido",
+                                 "inodo " + std::to_string(index) + " (en línea, " + std::to_string(inode.i_size) + " bytes)",
+                                 false);
+            }
+            return;
+        }
+        if (Extents::usesExtents(inode)) {
+            if (Extents::root(inode).header.magic != Extents::MAGIC) {
+                check.report.add("Árboles de extents dañados", "inodo " + std::to_string(index), false);
+                return;
+            }
+            std::vector<Extents::Extent> extents;
+            std::vector<int> treeBlocks;
+            Extents::collect(sb, inode, [&](int b) { return readBlock(check, b); }, extents, treeBlocks);
+            for (int b : treeBlocks) {
+                use(b, false, 0);
+            }
+            std::sort(extents.begin(), extents.end(),
+                      [](const Extents::Extent& a, const Extents::Extent& b) { return a.logical < b.logical; });
+            for (const Extents::Extent& e : extents) {
+                for (int k = 0; k < e.length && use(e.physical + k, true, static_cast<long long>(e.logical) + k); k++) {
+                }
+            }
+        } else {
+            long long per = FileSystem::pointersPerBlock(sb);
+            std::function<void(int, int, long long)> walk = [&](int b, int level, long long logical) {
+                if (b == -1 || !use(b, level == 0, logical) || level == 0) {
+                    return;
+                }
+                long long span = 1;
+                for (int k = 1; k < level; k++) {
+                    span *= per;
+                }
+                FileSystem::Block block = readBlock(check, b);
+                for (long long k = 0; k < per; k++) {
+                    walk(block.pointers()[k], level - 1, logical + k * span);
+                }
+            };
+            long long first = FileOps::DIRECT_POINTERS;
+            for (int slot = 0; slot < 15; slot++) {
+                if (slot < FileOps::DIRECT_POINTERS) {
+                    walk(inode.i_block[slot], 0, slot);
+                    continue;
+                }
+                int level = slot - FileOps::DIRECT_POINTERS + 1;
+                walk(inode.i_block[slot], level, first);
+                long long span = 1;
+                for (int k = 0; k < level; k++) {
+                    span *= per;
+                }
+                first += span;
+            }
+        }
+        if (beyond > 0) {
+            check.report.add("Archivos con bloques después de su tamaño",
+                             "inodo " + std::to_string(index) + " (" + std::to_string(beyond) + " bloques)", false);
+        }
+    }
+
+    // Revisar los inodos [first, first + count) de un mismo grupo: se leen
+    // de una vez y solo se miran los marcados en el bitmap
+    inline void scanChunk(Check& check, int first, int count) {
+        if (check.inodeBitmap.findUsedFrom(first) >= first + count) {
+            return;
+        }
+        int inodeSize = check.sb.s_inode_size;
+        std::vector<char> table(static_cast<size_t>(count) * inodeSize);
+        ssize_t got = pread(check.fd, table.data(), table.size(), FileSystem::inodeOffset(check.sb, first));
+        if (got != static_cast<ssize_t>(table.size())) {
+            check.report.add("Tabla de inodos ilegible", "inodos " + std::to_string(first) + " a " +
+                             std::to_string(first + count - 1), false);
+            return;
+        }
+        for (int k = 0; k < count; k++) {
+            int index = first + k;
+            if (!check.inodeBitmap.test(index)) {
+                continue;
+            }
+            Inode inode;
+            std::memcpy(&inode, table.data() + static_cast<size_t>(k) * inodeSize, sizeof(Inode));
+            FileSystem::sanitizeInode(check.sb, inode);
+            check.inodesChecked++;
+            if (inode.i_type != '0' && inode.i_type != '1') {
+                check.report.add("Inodos en uso con tipo inválido", "inodo " + std::to_string(index), true);
+                continue;
+            }
+            if (inode.i_size < 0) {
+                check.report.add("Inodos con tamaño inválido", "inodo " + std::to_string(index), false);
+            }
+            check.kinds[index] = inode.i_type;
+            if (inode.i_type == '1') {
+                std::vector<int> blocks;
+                walkMap(check, index, inode, &blocks);
+                std::lock_guard<std::mutex> lock(check.dirMutex);
+                check.dirBlocks[index] = std::move(blocks);
+            } else {
+                walkMap(check, index, inode, nullptr);
+            }
+        }
+    }
+
+    // Tipo del inodo 'index' para una entrada que apunta a él. Los marcados
+    // en el bitmap quedaron fijos en la fase 1; uno libre en el bitmap pero
+    // con un inodo válido se adopta (el bitmap es lo que está mal)
+    inline char kindOf(Check& check, int index) {
+        if (check.inodeBitmap.test(index)) {
+            return check.kinds[index];
+        }
+        std::lock_guard<std::mutex> lock(check.adoptMutex);
+        if (check.kinds[index] != 0 || check.rejected.count(index)) {
+            return check.kinds[index];
+        }
+        Inode inode;
+        if (pread(check.fd, &inode, sizeof(Inode), FileSystem::inodeOffset(check.sb, index)) != sizeof(Inode)) {
+            check.rejected.insert(index);
+            return 0;
+        }
+        FileSystem::sanitizeInode(check.sb, inode);
+        if ((inode.i_type != '0' && inode.i_type != '1') || inode.i_size < 0) {
+            check.rejected.insert(index);
+            return 0;
+        }
+        check.inodesChecked++;
+        check.report.add("Inodos con entrada marcados como libres", "inodo " + std::to_string(index), true);
+        std::vector<int> blocks;
+        walkMap(check, index, inode, inode.i_type == '1' ? &blocks : nullptr);
+        if (inode.i_type == '1') {
+            std::lock_guard<std::mutex> dirLock(check.dirMutex);
+            check.dirBlocks[index] = std::move(blocks);
+        }
+        check.kinds[index] = inode.i_type;
+        return inode.i_type;
+    }
+
+    // Fase 1: la tabla de inodos en trozos con robo de trabajo
+    inline void scanInodes(Check& check, unsigned threads) {
+        // Trozos sin cruzar grupos (cada uno es contiguo en el disco)
+        std::vector<std::pair<int, int>> chunks;
+        int perGroup = FileSystem::inodesPerGroup(check.sb);
+        for (int g = 0; g < FileSystem::groupsCount(check.sb); g++) {
+            int begin = g * perGroup;
+            int end = std::min(check.sb.s_inodes_count, begin + perGroup);
+            for (int first = begin; first < end; first += CHUNK_INODES) {
+                chunks.push_back({first, std::min(CHUNK_INODES, end - first)});
+            }
+        }
+
+        // Cada hilo arranca con un rango contiguo de trozos
+        struct Queue {
+            std::mutex mutex;
+            std::deque<int> chunks;
+        };
+        std::vector<Queue> queues(threads);
+        for (size_t c = 0; c < chunks.size(); c++) {
+            queues[c * threads / chunks.size()].chunks.push_back(static_cast<int>(c));
+        }
+        auto take = [&](unsigned self, int& chunk) {
+            {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].chunks.empty()) {
+                    chunk = queues[self].chunks.front();
+                    queues[self].chunks.pop_front();
+                    return true;
+                }
+            }
+            // Robar del final de otra cola (lo más lejano a lo que ese hilo lee)
+            for (unsigned k = 1; k < threads; k++) {
+                Queue& victim = queues[(self + k) % threads];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.chunks.empty()) {
+                    chunk = victim.chunks.back();
+                    victim.chunks.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                int chunk;
+                while (take(t, chunk)) {
+                    scanChunk(check, chunks[chunk].first, chunks[chunk].second);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Fase 2: recorrer las carpetas desde 'roots' (ya con su enlace) con
+    // varios hilos. Cada entrada suma un enlace a su inodo; una carpeta se
+    // encola la primera vez. Las entradas que apuntan a carpetas y las '..'
+    // se anotan y se resuelven al final (resolveLinks), cuando ya se vieron todas
+    inline void walkDirectories(Check& check, unsigned threads, const std::vector<int>& roots) {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<int> pending(roots);
+        int active = 0;
+        int perBlock = FileSystem::contentsPerBlock(check.sb);
+
+        auto visit = [&](int dirIndex) {
+            check.dirsWalked++;
+            std::string where = "carpeta " + std::to_string(dirIndex);
+            std::vector<int> blocks;
+            {
+                std::lock_guard<std::mutex> lock(check.dirMutex);
+                blocks = check.dirBlocks[dirIndex];
+            }
+            for (int b : blocks) {
+                FileSystem::Block block = readBlock(check, b);
+                for (int slot = 0; slot < perBlock; slot++) {
+                    const Content& entry = block.contents()[slot];
+                    if (entry.b_inodo == -1) {
+                        continue;
+                    }
+                    std::string name = FileOps::entryName(entry);
+                    int child = entry.b_inodo;
+                    if (name == ".") {
+                        if (child != dirIndex) {
+                            check.report.add("Entradas '.' o '..' incorrectas",
+                                             where + ": '.' -> " + std::to_string(child), true);
+                            std::lock_guard<std::mutex> lock(check.fixMutex);
+                            check.fixes.push_back({b, slot, dirIndex});
+                        }
+                        continue;
+                    }
+                    if (name == "..") {
+                        std::lock_guard<std::mutex> lock(check.linkMutex);
+                        check.dotDots[dirIndex] = {b, slot, child};
+                        continue;
+                    }
+                    char kind = child >= 0 && child < check.sb.s_inodes_count ? kindOf(check, child) : 0;
+                    if (kind == 0) {
+                        check.report.add("Entradas que apuntan a inodos libres o dañados",
+                                         where + ": '" + name + "' -> " + std::to_string(child), true);
+                        std::lock_guard<std::mutex> lock(check.fixMutex);
+                        check.fixes.push_back({b, slot, -1});
+                        continue;
+                    }
+                    int previous = check.links[child].fetch_add(1);
+                    if (kind == '1') {
+                        {
+                            std::lock_guard<std::mutex> lock(check.linkMutex);
+                            check.dirLinks[child].push_back({b, slot, dirIndex, name});
+                        }
+                        if (previous == 0) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            pending.push_back(child);
+                            changed.notify_one();
+                        }
+                    } else if (previous > 0) {
+                        check.report.add("Archivos con más de una entrada",
+                                         where + ": '" + name + "' -> " + std::to_string(child), false);
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&]() {
+                while (true) {
+                    int next;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        changed.wait(lock, [&]() { return !pending.empty() || active == 0; });
+                        if (pending.empty()) {
+                            return;     // Nadie trabaja y no queda nada: terminó
+                        }
+                        next = pending.back();
+                        pending.pop_back();
+                        active++;
+                    }
+                    visit(next);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    active--;
+                    if (active == 0 && pending.empty()) {
+                        changed.notify_all();
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Inodos en uso que ninguna carpeta alcanza: se cuelgan de /lost+found.
+    // Primero las cimas (los que no aparecen en otra carpeta huérfana) y
+    // después se recorre lo que cuelga de ellas; un ciclo de carpetas sin cima
+    // se corta por su inodo menor
+    inline void collectOrphans(Check& check, unsigned threads) {
+        int perBlock = FileSystem::contentsPerBlock(check.sb);
+        while (true) {
+            std::vector<int> orphans;
+            for (int i = 0; i < check.sb.s_inodes_count; i++) {
+                if (check.kinds[i] != 0 && check.links[i].load() == 0) {
+                    orphans.push_back(i);
+                }
+            }
+            if (orphans.empty()) {
+                return;
+            }
+            std::set<int> referenced;
+            for (int i : orphans) {
+                if (check.kinds[i] != '1') {
+                    continue;
+                }
+                for (int b : check.dirBlocks[i]) {
+                    FileSystem::Block block = readBlock(check, b);
+                    for (int slot = 0; slot < perBlock; slot++) {
+                        const Content& entry = block.contents()[slot];
+                        std::string name = FileOps::entryName(entry);
+                        if (entry.b_inodo != -1 && name != "." && name != "..") {
+                            referenced.insert(entry.b_inodo);
+                        }
+                    }
+                }
+            }
+            std::vector<int> tops;
+            for (int i : orphans) {
+                if (!referenced.count(i)) {
+                    tops.push_back(i);
+                }
+            }
+            if (tops.empty()) {
+                tops.push_back(orphans.front());
+            }
+            std::vector<int> roots;
+            for (int i : tops) {
+                check.links[i]++;
+                check.lostFound.push_back(i);
+                check.report.add("Inodos en uso sin entrada en ninguna carpeta (van a /lost+found)",
+                                 "inodo " + std::to_string(i), true);
+                if (check.kinds[i] == '1') {
+                    roots.push_back(i);
+                }
+            }
+            walkDirectories(check, threads, roots);
+        }
+    }
+
+    // Decidir qué entrada se queda para cada carpeta (la de menor bloque y
+    // ranura; ninguna para la raíz y las que van a /lost+found) y revisar
+    // los '..' contra esa carpeta padre
+    inline void resolveLinks(Check& check) {
+        std::set<int> anchored(check.lostFound.begin(), check.lostFound.end());
+        anchored.insert(0);
+        std::map<int, int> parents{{0, 0}};
+        for (auto& [child, entries] : check.dirLinks) {
+            std::sort(entries.begin(), entries.end(), [](const DirLink& a, const DirLink& b) {
+                return a.block != b.block ? a.block < b.block : a.slot < b.slot;
+            });
+            size_t kept = anchored.count(child) ? 0 : 1;
+            if (kept == 1) {
+                parents[child] = entries.front().dir;
+            }
+            for (size_t k = kept; k < entries.size(); k++) {
+                const DirLink& extra = entries[k];
+                check.report.add("Carpetas con más de una entrada", "carpeta " + std::to_string(extra.dir) + ": '" +
+                                 extra.name + "' -> " + std::to_string(child), true);
+                check.fixes.push_back({extra.block, extra.slot, -1});
+            }
+        }
+        for (const auto& [dir, dotDot] : check.dotDots) {
+            auto parent = parents.find(dir);
+            if (parent == parents.end() || dotDot.inode == parent->second) {
+                continue;   // Las de /lost+found se corrigen al colgarlas
+            }
+            check.report.add("Entradas '.' o '..' incorrectas",
+                             "carpeta " + std::to_string(dir) + ": '..' -> " + std::to_string(dotDot.inode), true);
+            check.fixes.push_back({dotDot.block, dotDot.slot, parent->second});
+        }
+    }
+
+    // Colgar de /lost+found (se crea si no existe) los inodos huérfanos con
+    // el nombre "inodo<N>" ("i<N>" si no cabe; '#' empieza un comentario en
+    // la consola); el '..' de una carpeta pasa a ser /lost+found. Se hace con
+    // las operaciones normales, después de la reparación directa
+    inline std::string moveToLostFound(const std::string& id, const Check& check) {
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        Inode root = FileOps::readInode(ctx, 0);
+        int folderIndex = FileOps::lookup(ctx, 0, root, LOST_FOUND);
+        if (folderIndex == -1) {
+            folderIndex = FileOps::createDirectory(ctx, 0, root, LOST_FOUND, error);
+            if (folderIndex == -1) {
+                return error;
+            }
+        } else if (FileOps::readInode(ctx, folderIndex).i_type != '1') {
+            return "Error: '/" + std::string(LOST_FOUND) + "' existe y no es una carpeta";
+        }
+        Inode folder = FileOps::readInode(ctx, folderIndex);
+        int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+        for (int index : check.lostFound) {
+            std::string name = "inodo" + std::to_string(index);
+            if (name.size() > sizeof(Content::b_name)) {
+                name = "i" + std::to_string(index);
+            }
+            error = FileOps::addEntry(ctx, folderIndex, folder, name, index);
+            if (!error.empty()) {
+                break;
+            }
+            if (check.kinds[index] != '1') {
+                continue;
+            }
+            Inode dir = FileOps::readInode(ctx, index);
+            int b = FileOps::blockAt(ctx, dir, 0);
+            if (b == -1) {
+                continue;
+            }
+            FileSystem::Block block = FileOps::readBlock(ctx, b);
+            int slot = FileOps::findInBlock(block, perBlock, "..");
+            if (slot != -1) {
+                block.contents()[slot].b_inodo = folderIndex;
+                FileOps::writeMetadataBlock(ctx, b, block);
+                DentryCache::invalidate(ctx.path, ctx.partStart, index, "..");
+            }
+        }
+        FileOps::finish(ctx);
+        return error;
+    }
+
+    // Particiones del disco: dentro del disco y sin solaparse (MBR y EBR)
+    inline void checkPartitions(Check& check, const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        MBR mbr;
+        if (!file.read(reinterpret_cast<char*>(&mbr), sizeof(MBR))) {
+            check.report.add("MBR ilegible", path, false);
+            return;
+        }
+        struct Range {
+            long long start;
+            long long end;
+            std::string name;
+        };
+        auto partName = [](const char* name) { return std::string(name, strnlen(name, 16)); };
+        auto overlaps = [](const std::vector<Range>& ranges, const Range& range) {
+            for (const Range& other : ranges) {
+                if (range.start < other.end && other.start < range.end) {
+                    return other.name;
+                }
+            }
+            return std::string();
+        };
+
+        std::vector<Range> primaries;
+        for (const Partition& p : mbr.mbr_partitions) {
+            if (p.part_status != '1') {
+                continue;
+            }
+            Range range{p.part_start, static_cast<long long>(p.part_start) + p.part_size, partName(p.part_name)};
+            if (range.start < static_cast<long long>(sizeof(MBR)) || range.end > mbr.mbr_size || p.part_size <= 0) {
+                check.report.add("Particiones fuera del disco", range.name, false);
+            }
+            std::string other = overlaps(primaries, range);
+            if (!other.empty()) {
+                check.report.add("Particiones solapadas", range.name + " y " + other, false);
+            }
+            primaries.push_back(range);
+
+            if (p.part_type != 'E') {
+                continue;
+            }
+            std::vector<Range> logicals;
+            long long position = p.part_start;
+            for (int guard = 0; position != -1 && guard < 1024; guard++) {
+                EBR ebr;
+                if (position < range.start || position >= range.end) {
+                    check.report.add("Cadena de EBR fuera de la extendida",
+                                     range.name + " -> " + std::to_string(position), false);
+                    break;
+                }
+                file.seekg(position, std::ios::beg);
+                if (!file.read(reinterpret_cast<char*>(&ebr), sizeof(EBR))) {
+                    check.report.add("Cadena de EBR ilegible", range.name, false);
+                    break;
+                }
+                if (ebr.part_status == '1') {
+                    Range logical{ebr.part_start, static_cast<long long>(ebr.part_start) + ebr.part_size,
+                                  partName(ebr.part_name)};
+                    if (logical.start < position + static_cast<long long>(sizeof(EBR)) ||
+                        logical.end > range.end || ebr.part_size <= 0) {
+                        check.report.add("Particiones lógicas fuera de la extendida", logical.name, false);
+                    }
+                    std::string other = overlaps(logicals, logical);
+                    if (!other.empty()) {
+                        check.report.add("Particiones solapadas", logical.name + " y " + other, false);
+                    }
+                    logicals.push_back(logical);
+                }
+                if (ebr.part_next != -1 && ebr.part_next <= position) {
+                    check.report.add("Cadena de EBR con ciclo", range.name, false);
+                    break;
+                }
+                position = ebr.part_next;
+            }
+        }
+    }
+
+    // Bloques del grupo g de un bitmap completo
+    inline Bitmap::Bits slice(const Bitmap::Bits& all, int first, int count) {
+        Bitmap::Bits part(count);
+        for (int i = 0; i < count && first + i < all.count; i++) {
+            if (all.test(first + i)) {
+                part.set(i);
+            }
+        }
+        return part;
+    }
+
+    // Reescribir lo que se puede corregir: entradas de carpeta, bitmaps,
+    // tabla de referencias y contadores. La partición se escribe directo
+    // (como mkfs) con las cachés ya vaciadas; los huérfanos se cuelgan de
+    // /lost+found después (moveToLostFound)
+    inline long long repair(Check& check, const CommandMount::MountedPartition& partition,
+                            const Bitmap::Bits& inodesUsed, const Bitmap::Bits& blocksUsed,
+                            const std::vector<int>& dirsPerGroup) {
+        const Superblock& sb = check.sb;
+        int fd = ::open(partition.path.c_str(), O_RDWR);
+        if (fd < 0) {
+            return -1;
+        }
+        long long writes = 0;
+        auto put = [&](long long offset, const void* data, size_t length) {
+            if (pwrite(fd, data, length, offset) == static_cast<ssize_t>(length)) {
+                writes++;
+            }
+        };
+
+        for (const EntryFix& fix : check.fixes) {
+            FileSystem::Block block = readBlock(check, fix.block);
+            Content& entry = block.contents()[fix.slot];
+            if (fix.inode == -1) {
+                entry = Content();
+            } else {
+                entry.b_inodo = fix.inode;
+            }
+            put(FileSystem::blockOffset(sb, fix.block) + static_cast<long long>(fix.slot) * sizeof(Content),
+                &entry, sizeof(Content));
+        }
+
+        for (int g = 0; g < FileSystem::groupsCount(sb); g++) {
+            int inodesFirst = g * FileSystem::inodesPerGroup(sb);
+            int blocksFirst = g * FileSystem::blocksPerGroup(sb);
+            std::vector<char> raw = Bitmap::encode(slice(inodesUsed, inodesFirst, FileSystem::inodesPerGroup(sb)),
+                                                   sb.s_rev_level);
+            put(FileSystem::groupInodeBitmap(sb, g), raw.data(), raw.size());
+            raw = Bitmap::encode(slice(blocksUsed, blocksFirst, FileSystem::blocksPerGroup(sb)), sb.s_rev_level);
+            put(FileSystem::groupBlockBitmap(sb, g), raw.data(), raw.size());
+
+            if (FileSystem::hasGroups(sb)) {
+                GroupDescriptor gd;
+                if (pread(fd, &gd, sizeof(gd), FileSystem::groupDescriptorOffset(sb, g)) == sizeof(gd)) {
+                    int inodes = std::min(FileSystem::inodesPerGroup(sb), sb.s_inodes_count - inodesFirst);
+                    int blocks = std::min(FileSystem::blocksPerGroup(sb), sb.s_blocks_count - blocksFirst);
+                    gd.bg_free_inodes_count = inodes - slice(inodesUsed, inodesFirst, inodes).countUsed();
+                    gd.bg_free_blocks_count = blocks - slice(blocksUsed, blocksFirst, blocks).countUsed();
+                    gd.bg_used_dirs_count = dirsPerGroup[g];
+                    put(FileSystem::groupDescriptorOffset(sb, g), &gd, sizeof(gd));
+                }
+            }
+        }
+
+        if (!check.refcounts.empty()) {
+            std::vector<unsigned char> table(check.refcounts.size(), 0);
+            for (int b = 0; b < sb.s_blocks_count && b < static_cast<int>(table.size()); b++) {
+                int refs = check.blockRefs[b].load();
+                table[b] = static_cast<unsigned char>(std::min(std::max(refs - 1, 0), Refcount::MAX_SHARES));
+            }
+            put(sb.s_refcount_start, table.data(), table.size());
+        }
+
+        Superblock fixed = sb;
+        fixed.s_free_inodes_count = sb.s_inodes_count - inodesUsed.countUsed();
+        fixed.s_free_blocks_count = sb.s_blocks_count - blocksUsed.countUsed();
+        put(partition.start, &fixed, FileSystem::superblockSize(fixed));
+        fdatasync(fd);
+        close(fd);
+        return writes;
+    }
+
+    // Comando fsck: revisar la partición montada -id y, con -repair, corregir
+    // lo que se pueda
+    inline std::string execute(const std::string& id, bool repairParam) {
+        if (id.empty()) {
+            return "Error: fsck requiere el parámetro -id";
+        }
+        CommandMount::MountedPartition partition;
+        if (!CommandMount::getMountedPartition(id, partition)) {
+            return "Error: la partición con ID '" + id + "' no está montada";
+        }
+
+        // El chequeo lee el disco directamente: primero se escribe todo lo
+        // que sigue en memoria
+        CommandSync::syncAll();
+        auto begin = std::chrono::steady_clock::now();
+
+        Check check;
+        {
+            std::ifstream file(partition.path, std::ios::binary);
+            if (!file.is_open()) {
+                return "Error: no se pudo abrir el disco '" + partition.path + "'";
+            }
+            if (!FileSystem::readSuperblock(file, partition.start, check.sb, partition.size)) {
+                return "Error: la partición con ID '" + id + "' no está formateada o su Superbloque "
+                       "no es válido (use mkfs)";
+            }
+            check.inodeBitmap = Bitmap::readInodes(file, check.sb);
+            check.blockBitmap = Bitmap::readBlocks(file, check.sb);
+        }
+        const Superblock& sb = check.sb;
+        check.fd = ::open(partition.path.c_str(), O_RDONLY);
+        if (check.fd < 0) {
+            return "Error: no se pudo abrir el disco '" + partition.path + "'";
+        }
+        if (Refcount::enabled(sb)) {
+            check.refcounts.resize(sb.s_refcount_size);
+            ssize_t got = pread(check.fd, check.refcounts.data(), check.refcounts.size(), sb.s_refcount_start);
+            (void)got;
+        }
+        check.blockRefs.reset(new std::atomic<uint16_t>[sb.s_blocks_count]());
+        check.links.reset(new std::atomic<int>[sb.s_inodes_count]());
+        check.kinds.assign(sb.s_inodes_count, 0);
+
+        // La partición y el sistema de archivos dentro del disco
+        checkPartitions(check, partition.path);
+        int lastGroup = FileSystem::groupsCount(sb) - 1;
+        long long fsEnd = FileSystem::groupBlockStart(sb, lastGroup) +
+                          static_cast<long long>(sb.s_blocks_count - lastGroup * FileSystem::blocksPerGroup(sb)) *
+                          sb.s_block_size;
+        if (fsEnd > static_cast<long long>(partition.start) + partition.size) {
+            check.report.add("Sistema de archivos más grande que la partición",
+                             std::to_string(fsEnd - partition.start) + " de " + std::to_string(partition.size) +
+                             " bytes", false);
+        }
+
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        scanInodes(check, threads);
+        double scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        bool rootOk = kindOf(check, 0) == '1';
+        if (rootOk) {
+            check.links[0]++;
+            walkDirectories(check, threads, {0});
+            collectOrphans(check, threads);
+            resolveLinks(check);
+        } else {
+            check.report.add("Raíz dañada", "el inodo 0 no es una carpeta en uso", false);
+        }
+
+        // En uso: lo alcanzable desde la raíz o desde /lost+found
+        Bitmap::Bits inodesUsed(sb.s_inodes_count);
+        std::vector<int> dirsPerGroup(FileSystem::groupsCount(sb), 0);
+        for (int i = 0; i < sb.s_inodes_count; i++) {
+            if (check.links[i].load() > 0 && check.kinds[i] != 0) {
+                inodesUsed.set(i);
+                if (check.kinds[i] == '1') {
+                    dirsPerGroup[FileSystem::inodeGroup(sb, i)]++;
+                }
+            }
+        }
+
+        // Bloques: bitmap y tabla de referencias contra lo encontrado
+        Bitmap::Bits blocksUsed(sb.s_blocks_count);
+        bool reflink = !check.refcounts.empty();
+        for (int b = 0; b < sb.s_blocks_count; b++) {
+            int refs = check.blockRefs[b].load();
+            bool marked = check.blockBitmap.test(b);
+            if (refs > 0) {
+                blocksUsed.set(b);
+            }
+            if (refs > 0 && !marked) {
+                check.report.add("Bloques en uso marcados como libres", "bloque " + std::to_string(b), true);
+            } else if (refs == 0 && marked) {
+                check.report.add("Bloques marcados sin ningún inodo que los use", "bloque " + std::to_string(b), true);
+            }
+            int extra = reflink && b < static_cast<int>(check.refcounts.size()) ? check.refcounts[b] : 0;
+            if (refs > 1 && !reflink) {
+                check.report.add("Bloques usados por más de un inodo",
+                                 "bloque " + std::to_string(b) + " (" + std::to_string(refs) + " inodos)", false);
+            } else if (reflink && extra != std::max(refs - 1, 0)) {
+                check.report.add("Referencias de reflink incorrectas",
+                                 "bloque " + std::to_string(b) + " (tabla " + std::to_string(extra + 1) +
+                                 ", inodos " + std::to_string(refs) + ")", refs - 1 <= Refcount::MAX_SHARES);
+            }
+        }
+
+        // Contadores del Superbloque y de los grupos
+        int freeInodes = sb.s_inodes_count - inodesUsed.countUsed();
+        int freeBlocks = sb.s_blocks_count - blocksUsed.countUsed();
+        if (sb.s_free_inodes_count != freeInodes) {
+            check.report.add("Contadores del Superbloque", "inodos libres " + std::to_string(sb.s_free_inodes_count) +
+                             ", deberían ser " + std::to_string(freeInodes), true);
+        }
+        if (sb.s_free_blocks_count != freeBlocks) {
+            check.report.add("Contadores del Superbloque", "bloques libres " + std::to_string(sb.s_free_blocks_count) +
+                             ", deberían ser " + std::to_string(freeBlocks), true);
+        }
+        if (FileSystem::hasGroups(sb)) {
+            std::ifstream file(partition.path, std::ios::binary);
+            for (int g = 0; g < sb.s_groups_count; g++) {
+                GroupDescriptor gd = FileSystem::readGroupDescriptor(file, sb, g);
+                int inodesFirst = g * sb.s_inodes_per_group;
+                int blocksFirst = g * sb.s_blocks_per_group;
+                int inodes = std::min(sb.s_inodes_per_group, sb.s_inodes_count - inodesFirst);
+                int blocks = std::min(sb.s_blocks_per_group, sb.s_blocks_count - blocksFirst);
+                int groupFreeInodes = inodes - slice(inodesUsed, inodesFirst, inodes).countUsed();
+                int groupFreeBlocks = blocks - slice(blocksUsed, blocksFirst, blocks).countUsed();
+                if (gd.bg_free_inodes_count != groupFreeInodes || gd.bg_free_blocks_count != groupFreeBlocks ||
+                    gd.bg_used_dirs_count != dirsPerGroup[g]) {
+                    check.report.add("Contadores de los grupos", "grupo " + std::to_string(g), true);
+                }
+            }
+        }
+        close(check.fd);
+
+        // Reparar: la partición se escribe directo, así que las cachés de
+        // esta partición se olvidan antes
+        long long writes = 0;
+        std::string lostFoundError;
+        bool repairable = false;
+        for (const auto& [kind, category] : check.report.categories) {
+            repairable = repairable || category.repairable;
+        }
+        if (repairParam && repairable) {
+            ItableInit::stop(partition.path, partition.start);
+            Allocator::discard(partition.path, partition.start);
+            DelayedAlloc::discard(partition.path, partition.start);
+            Atime::discard(partition.path, partition.start);
+            InodeCache::discard(partition.path, partition.start);
+            Users::discard(partition.path, partition.start);
+            DentryCache::invalidateAll(partition.path, partition.start);
+            BufferCache::invalidate(partition.path, partition.start,
+                                    static_cast<long long>(partition.start) + partition.size);
+            check.fd = ::open(partition.path.c_str(), O_RDONLY);
+            writes = repair(check, partition, inodesUsed, blocksUsed, dirsPerGroup);
+            close(check.fd);
+            if (writes < 0) {
+                return "Error: no se pudo abrir el disco '" + partition.path + "' para escribir";
+            }
+            if (!check.lostFound.empty()) {
+                lostFoundError = moveToLostFound(id, check);
+            }
+            ItableInit::start(partition.path, partition.start);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        std::ostringstream result;
+        result << "\n=== FSCK ===\n";
+        result << "Partición '" << id << "' (EXT" << sb.s_filesystem_type << ", " << sb.s_inodes_count
+               << " inodos, " << sb.s_blocks_count << " bloques de " << sb.s_block_size << " bytes)\n";
+        result << "  Inodos revisados: " << check.inodesChecked.load() << "\n";
+        result << "  Carpetas recorridas: " << check.dirsWalked.load() << "\n";
+        result << std::fixed << std::setprecision(3) << "  Tiempo: " << seconds << " s con " << threads
+               << " hilo(s) (tabla de inodos " << scanSeconds << " s)\n";
+        if (check.report.total == 0) {
+            result << "Sin problemas";
+            return result.str();
+        }
+        result << "Problemas: " << check.report.total << "\n";
+        for (const auto& [kind, category] : check.report.categories) {
+            result << "  " << kind << ": " << category.count;
+            if (repairParam) {
+                result << (category.repairable ? " (reparado)" : " (sin reparar)");
+            }
+            result << "\n";
+            for (const std::string& example : category.examples) {
+                result << "    - " << example << "\n";
+            }
+            if (category.count > static_cast<long long>(category.examples.size())) {
+                result << "    - ...\n";
+            }
+        }
+        if (repairParam) {
+            result << "Escrituras de reparación: " << writes;
+            if (!lostFoundError.empty()) {
+                result << "\n" << lostFoundError;
+            }
+        } else if (repairable) {
+            result << "Use -repair para corregir los problemas reparables";
+        }
+        std::string text = result.str();
+        if (text.back() == '\n') {
+            text.pop_back();
+        }
+        return text;
+    }
+
+} // namespace CommandFsck
+
+#endif // FSCK_H
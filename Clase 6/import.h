@@ -0,0 +1,378 @@
+#ifndef IMPORT_H
+#define IMPORT_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <fstream>      // Lectura de los archivos del host
+#include <iomanip>      // Formato de los números
+#include <vector>       // Lotes de archivos
+#include <algorithm>    // std::sort, std::min
+#include <chrono>       // Medición del tiempo
+#include <cstring>      // memcpy
+#include <filesystem>   // Recorrido de la carpeta del host
+#include "structures.h"
+#include "filesystem.h"
+#include "fileops.h"
+#include "allocator.h"
+#include "buffer_cache.h"
+#include "mount.h"
+#include "sync.h"
+#include "users.h"
+
+// Importación masiva de una carpeta del host. Los archivos de cada carpeta se
+// crean por lotes: los inodos del lote se reservan juntos (una escritura del
+// bitmap), el contenido de todos los archivos se empaqueta uno tras otro en
+// tramos de bloques contiguos que se escriben con una sola escritura cada uno
+// y el lote completo es una sola operación del journal
+namespace CommandImport {
+
+    const int BATCH_FILES = 128;                      // Archivos por lote
+    const long long BATCH_BYTES = 4 * 1024 * 1024;    // Contenido por lote
+
+    // Archivo del host pendiente de importar
+    struct HostFile {
+        std::string hostPath;
+        std::string name;
+        long long size;
+    };
+
+    struct Stats {
+        int files = 0;
+        int folders = 0;
+        int skipped = 0;
+        int batches = 0;
+        int runs = 0;           // Tramos de bloques escritos
+        long long bytes = 0;
+    };
+
+    // Parte contigua del contenido de un archivo dentro de un tramo
+    struct Piece {
+        long long logical;
+        int physical;
+        int length;
+    };
+
+    inline bool readHostFile(const std::string& hostPath, std::string& content) {
+        std::ifstream source(hostPath, std::ios::binary);
+        if (!source.is_open()) {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << source.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+    // Devolver al asignador lo reservado para un lote que no se pudo crear
+    inline void releaseBatch(FileOps::Context& ctx, const std::vector<int>& inodes,
+                             const std::vector<std::vector<Piece>>& pieces, size_t from) {
+        for (size_t k = from; k < inodes.size(); k++) {
+            for (const Piece& piece : pieces[k]) {
+                for (int b = 0; b < piece.length; b++) {
+                    Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, piece.physical + b);
+                }
+            }
+            Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, inodes[k], false);
+        }
+    }
+
+    // Crear en la carpeta 'dirIndex' los archivos de un lote
+    inline std::string importBatch(FileOps::Context& ctx, int dirIndex, Inode& dir,
+                                   const std::vector<HostFile>& batch, Stats& stats) {
+        int blockSize = ctx.sb.s_block_size;
+        bool inlineData = (ctx.sb.s_feature_compat & FS_FEATURE_INLINE_DATA) != 0;
+        bool extents = (ctx.sb.s_feature_compat & FS_FEATURE_EXTENTS) != 0;
+
+        // Contenido del lote; los que no se pueden leer o no caben se omiten
+        std::vector<const HostFile*> files;
+        std::vector<std::string> contents;
+        std::vector<long long> blocks;
+        long long totalBlocks = 0;
+        for (const HostFile& file : batch) {
+            std::string content;
+            if (!readHostFile(file.hostPath, content)) {
+                stats.skipped++;
+                continue;
+            }
+            long long count = (static_cast<long long>(content.size()) + blockSize - 1) / blockSize;
+            if (inlineData && static_cast<int>(content.size()) <= FileSystem::inlineCapacity()) {
+                count = 0;
+            } else if ((!extents && count > FileOps::maxBlocks(ctx.sb)) || count > INT32_MAX) {
+                stats.skipped++;
+                continue;
+            }
+            files.push_back(&file);
+            contents.push_back(std::move(content));
+            blocks.push_back(count);
+            totalBlocks += count;
+        }
+        if (files.empty()) {
+            return "";
+        }
+
+        // Inodos del lote en una sola reserva
+        std::vector<int> inodes;
+        int wanted = static_cast<int>(files.size());
+        std::vector<std::vector<Piece>> pieces(files.size());
+        if (Allocator::allocateInodes(ctx.path, ctx.partStart, ctx.sb, dirIndex, wanted, inodes) < wanted) {
+            releaseBatch(ctx, inodes, pieces, 0);
+            return "Error: no hay inodos libres";
+        }
+
+        // Contenido empaquetado en tramos contiguos: cada archivo empieza en el
+        // bloque siguiente al final del anterior
+        size_t current = 0;
+        long long logical = 0;
+        int goal = -1;
+        for (long long remaining = totalBlocks; remaining > 0; ) {
+            int run = 0;
+            int first = Allocator::allocateRun(ctx.path, ctx.partStart, ctx.sb, inodes[0], goal,
+                                               static_cast<int>(std::min<long long>(remaining, INT32_MAX)), run);
+            if (first == -1) {
+                releaseBatch(ctx, inodes, pieces, 0);
+                return "Error: no hay bloques libres";
+            }
+            std::vector<char> data(static_cast<size_t>(run) * blockSize, 0);
+            for (int used = 0; used < run; ) {
+                while (blocks[current] == logical) {
+                    current++;
+                    logical = 0;
+                }
+                int length = static_cast<int>(std::min<long long>(run - used, blocks[current] - logical));
+                size_t offset = static_cast<size_t>(logical * blockSize);
+                size_t bytes = std::min(static_cast<size_t>(length) * blockSize, contents[current].size() - offset);
+                std::memcpy(data.data() + static_cast<size_t>(used) * blockSize, contents[current].data() + offset, bytes);
+                pieces[current].push_back({logical, first + used, length});
+                used += length;
+                logical += length;
+            }
+            BufferCache::write(ctx.path, FileSystem::blockOffset(ctx.sb, first), data.data(), data.size());
+            stats.runs++;
+            remaining -= run;
+            goal = first + run;
+        }
+
+        // Inodos y entradas de la carpeta
+        for (size_t k = 0; k < files.size(); k++) {
+            Inode inode = FileOps::newInode('0');
+            if (blocks[k] == 0 && inlineData) {
+                FileSystem::writeInlineData(inode, contents[k]);
+            } else if (extents) {
+                Extents::initRoot(inode);
+            }
+            bool mapped = true;
+            for (const Piece& piece : pieces[k]) {
+                if (Extents::usesExtents(inode)) {
+                    mapped = FileOps::mapExtent(ctx, inodes[k], inode, piece.logical, piece.physical, piece.length);
+                } else {
+                    for (int b = 0; b < piece.length && mapped; b++) {
+                        mapped = FileOps::mapBlock(ctx, inodes[k], inode, piece.logical + b, piece.physical + b);
+                    }
+                }
+                if (!mapped) {
+                    break;
+                }
+            }
+            inode.i_size = static_cast<int>(contents[k].size());
+            std::string error = mapped ? FileOps::addEntry(ctx, dirIndex, dir, files[k]->name, inodes[k])
+                                       : "Error: no hay bloques libres";
+            if (!error.empty()) {
+                // El archivo k ya puede tener bloques asociados y bloques de
+                // punteros o nodos de extents: esos los libera releaseData,
+                // los que no llegaron a asociarse se liberan aquí
+                for (const Piece& piece : pieces[k]) {
+                    for (int b = 0; b < piece.length; b++) {
+                        if (FileOps::blockAt(ctx, inode, piece.logical + b) != piece.physical + b) {
+                            Allocator::freeBlock(ctx.path, ctx.partStart, ctx.sb, piece.physical + b);
+                        }
+                    }
+                }
+                FileOps::releaseData(ctx, inode);
+                FileOps::writeInode(ctx, inodes[k], inode);
+                Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, inodes[k], false);
+                releaseBatch(ctx, inodes, pieces, k + 1);
+                return error;
+            }
+            FileOps::writeInode(ctx, inodes[k], inode);
+            stats.files++;
+            stats.bytes += static_cast<long long>(contents[k].size());
+        }
+        stats.batches++;
+        return "";
+    }
+
+    // Importar el contenido de la carpeta del host 'hostDir' en la carpeta 'dirIndex'
+    inline std::string importFolder(FileOps::Context& ctx, const std::filesystem::path& hostDir,
+                                    int dirIndex, Stats& stats) {
+        std::vector<std::filesystem::directory_entry> entries;
+        std::error_code code;
+        for (const auto& entry : std::filesystem::directory_iterator(hostDir, code)) {
+            entries.push_back(entry);
+        }
+        if (code) {
+            return "Error: no se pudo leer la carpeta '" + hostDir.string() + "'";
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const auto& a, const auto& b) { return a.path().filename() < b.path().filename(); });
+
+        Inode dir = FileOps::readInode(ctx, dirIndex);
+        std::vector<HostFile> batch;
+        std::vector<std::filesystem::path> folders;
+        long long batchBytes = 0;
+        std::string error;
+        auto flushBatch = [&]() {
+            error = importBatch(ctx, dirIndex, dir, batch, stats);
+            FileOps::finish(ctx);
+            batch.clear();
+            batchBytes = 0;
+            return error.empty();
+        };
+
+        for (const auto& entry : entries) {
+            std::string name = entry.path().filename().string();
+            bool folder = entry.is_directory(code);
+            bool regular = !folder && entry.is_regular_file(code);
+            if ((!folder && !regular) || static_cast<int>(name.size()) > FileOps::MAX_NAME) {
+                stats.skipped++;
+                continue;
+            }
+            if (folder) {
+                folders.push_back(entry.path());
+                continue;
+            }
+            if (FileOps::lookup(ctx, dirIndex, dir, name) != -1) {
+                stats.skipped++;
+                continue;
+            }
+            long long size = static_cast<long long>(entry.file_size(code));
+            if (!batch.empty() && (static_cast<int>(batch.size()) >= BATCH_FILES || batchBytes + size > BATCH_BYTES)) {
+                if (!flushBatch()) {
+                    return error;
+                }
+            }
+            batch.push_back({entry.path().string(), name, size});
+            batchBytes += size;
+        }
+        if (!batch.empty() && !flushBatch()) {
+            return error;
+        }
+
+        // Subcarpetas después de los archivos; una que ya existe se reutiliza
+        for (const auto& hostFolder : folders) {
+            std::string name = hostFolder.filename().string();
+            int child = FileOps::lookup(ctx, dirIndex, dir, name);
+            if (child != -1) {
+                if (FileOps::readInode(ctx, child).i_type != '1') {
+                    stats.skipped++;
+                    continue;
+                }
+            } else {
+                child = FileOps::createDirectory(ctx, dirIndex, dir, name, error);
+                FileOps::finish(ctx);
+                if (child == -1) {
+                    return error;
+                }
+                stats.folders++;
+            }
+            error = importFolder(ctx, hostFolder, child, stats);
+            if (!error.empty()) {
+                return error;
+            }
+            dir = FileOps::readInode(ctx, dirIndex);
+        }
+        return "";
+    }
+
+    // Comando import: copiar una carpeta del host (-src) dentro de la carpeta
+    // -dest de la partición montada, creando -dest si no existe
+    inline std::string execute(const std::string& id, const std::string& src, const std::string& dest) {
+        if (id.empty()) {
+            return "Error: import requiere el parámetro -id";
+        }
+        if (src.empty()) {
+            return "Error: import requiere el parámetro -src";
+        }
+        if (dest.empty()) {
+            return "Error: import requiere el parámetro -dest";
+        }
+
+        std::filesystem::path hostDir(CommandMount::expandPath(src));
+        std::error_code code;
+        if (!std::filesystem::is_directory(hostDir, code)) {
+            return "Error: '" + src + "' no es una carpeta del host";
+        }
+
+        std::vector<std::string> parts;
+        std::string error = FileOps::splitPath(dest, parts);
+        if (!error.empty()) {
+            return error;
+        }
+
+        FileOps::Context ctx;
+        error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+
+        error = Users::checkCreate(ctx, parts, dest, true);
+        if (!error.empty()) {
+            return error;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        Stats stats;
+
+        // Carpeta destino (se crea junto con sus padres si falta)
+        int destIndex = 0;
+        if (!parts.empty()) {
+            int parentIndex = FileOps::resolveParent(ctx, parts, true, error, &stats.folders);
+            if (parentIndex == -1) {
+                FileOps::finish(ctx);
+                return error;
+            }
+            Inode parent = FileOps::readInode(ctx, parentIndex);
+            destIndex = FileOps::lookup(ctx, parentIndex, parent, parts.back());
+            if (destIndex == -1) {
+                destIndex = FileOps::createDirectory(ctx, parentIndex, parent, parts.back(), error);
+                if (destIndex != -1) {
+                    stats.folders++;
+                }
+            } else if (FileOps::readInode(ctx, destIndex).i_type != '1') {
+                error = "Error: '" + dest + "' no es una carpeta";
+                destIndex = -1;
+            }
+            FileOps::finish(ctx);
+            if (destIndex == -1) {
+                return error;
+            }
+        }
+
+        error = importFolder(ctx, hostDir, destIndex, stats);
+
+        // Los metadatos del import salen en escrituras grandes y ordenadas
+        CommandSync::syncAll();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        std::ostringstream result;
+        result << "\n=== IMPORT ===\n";
+        if (!error.empty()) {
+            result << error << "\n";
+        }
+        result << "Carpeta '" << src << "' importada en '" << dest << "'\n";
+        result << "  Archivos: " << stats.files << " (" << stats.bytes << " bytes)\n";
+        result << "  Carpetas creadas: " << stats.folders << "\n";
+        if (stats.skipped > 0) {
+            result << "  Omitidos: " << stats.skipped << "\n";
+        }
+        result << "  Lotes: " << stats.batches << " (" << stats.runs << " tramos de bloques)\n";
+        result << std::fixed << std::setprecision(3) << "  Tiempo: " << seconds << " s";
+        if (seconds > 0) {
+            result << std::setprecision(1) << " (" << stats.files / seconds << " archivos/s, "
+                   << stats.bytes / (1024.0 * 1024.0) / seconds << " MB/s)";
+        }
+        return result.str();
+    }
+
+} // namespace CommandImport
+
+#endif // IMPORT_H
@@ -0,0 +1,245 @@
+#ifndef INODE_CACHE_H
+#define INODE_CACHE_H
+
+#include <string>         // Manejo de la clase std::string
+#include <list>           // Orden LRU de cada fragmento
+#include <unordered_map>  // Índice (montaje, inodo) -> entrada
+#include <map>            // Registro de sistemas de archivos
+#include <memory>         // std::shared_ptr
+#include <mutex>          // Un candado por fragmento
+#include <atomic>         // Contadores de aciertos y fallos
+#include <vector>         // Volcado ordenado
+#include <algorithm>      // std::sort
+#include <functional>     // std::hash
+#include "structures.h"
+#include "filesystem.h"
+#include "journal.h"
+
+// Caché LRU de inodos para los sistemas de archivos montados, con clave
+// (montaje, número de inodo). Se divide en fragmentos con su propio candado
+// para que operaciones concurrentes no compitan por una sola lista. Las
+// escrituras quedan en memoria (entrada sucia) y se vuelcan al desalojarlas,
+// antes de cada commit del journal, en sync o al salir
+namespace InodeCache {
+
+    const int SHARDS = 16;                 // Fragmentos independientes
+    const size_t CAPACITY = 8192;          // Inodos en memoria en total
+    const size_t SHARD_CAPACITY = CAPACITY / SHARDS;
+
+    // Sistema de archivos dueño de las entradas (para escribirlas de vuelta)
+    struct Mount {
+        std::string path;
+        int partStart;
+        Superblock sb;
+    };
+
+    struct Entry {
+        std::string mount;                  // path:partStart
+        int inode;
+        Inode data;
+        bool dirty;
+        std::shared_ptr<Mount> owner;
+        long long generation;               // Cambia con cada escritura del inodo
+    };
+
+    struct KeyHash {
+        size_t operator()(const std::pair<std::string, int>& key) const {
+            return std::hash<std::string>()(key.first) * 31 + std::hash<int>()(key.second);
+        }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;               // Más reciente al frente
+        std::unordered_map<std::pair<std::string, int>, std::list<Entry>::iterator, KeyHash> index;
+    };
+
+    // Estadísticas globales (comando stats)
+    struct Stats {
+        std::atomic<long long> hits{0};
+        std::atomic<long long> misses{0};
+        std::atomic<long long> writebacks{0};
+        std::atomic<long long> evictions{0};
+    };
+
+    inline Shard* shards() {
+        static auto* all = new Shard[SHARDS];
+        return all;
+    }
+
+    inline Stats& stats() {
+        static auto* counters = new Stats();
+        return *counters;
+    }
+
+    inline std::map<std::string, std::shared_ptr<Mount>>& mounts() {
+        static auto* registered = new std::map<std::string, std::shared_ptr<Mount>>();
+        return *registered;
+    }
+
+    inline std::mutex& mountsMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    // Generaciones: un contador global que no se repite entre montajes ni
+    // formateos. Una entrada recibe uno nuevo al escribirse y al cargarse
+    // (tras desalojarla no se sabe si cambió en el disco)
+    inline long long nextGeneration() {
+        static auto* counter = new std::atomic<long long>(0);
+        return ++*counter;
+    }
+
+    inline std::string key(const std::string& path, int partStart) {
+        return path + ":" + std::to_string(partStart);
+    }
+
+    inline Shard& shardFor(const std::string& mount, int inode) {
+        return shards()[KeyHash()({mount, inode}) % SHARDS];
+    }
+
+    inline std::shared_ptr<Mount> mountFor(const std::string& path, int partStart, const Superblock& sb) {
+        std::lock_guard<std::mutex> lock(mountsMutex());
+        auto& mount = mounts()[key(path, partStart)];
+        if (!mount) {
+            mount = std::make_shared<Mount>(Mount{path, partStart, sb});
+        }
+        return mount;
+    }
+
+    // Escribir un inodo sucio en su posición (a través del journal en EXT3)
+    inline void writeBack(const Entry& entry) {
+        const Mount& mount = *entry.owner;
+        Journal::writeMetadata(mount.path, mount.partStart, mount.sb,
+                               FileSystem::inodeOffset(mount.sb, entry.inode), &entry.data, sizeof(Inode));
+        stats().writebacks++;
+    }
+
+    // Desalojar las entradas menos usadas mientras el fragmento esté lleno
+    // (llamar con el candado del fragmento tomado)
+    inline void evictLocked(Shard& shard) {
+        while (shard.lru.size() > SHARD_CAPACITY) {
+            Entry& victim = shard.lru.back();
+            if (victim.dirty) {
+                writeBack(victim);
+            }
+            shard.index.erase({victim.mount, victim.inode});
+            shard.lru.pop_back();
+            stats().evictions++;
+        }
+    }
+
+    // Buscar un inodo en la caché; false si hay que leerlo del disco
+    inline bool lookup(const std::string& path, int partStart, int i, Inode& out) {
+        std::string mount = key(path, partStart);
+        Shard& shard = shardFor(mount, i);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find({mount, i});
+        if (it == shard.index.end()) {
+            stats().misses++;
+            return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        out = it->second->data;
+        stats().hits++;
+        return true;
+    }
+
+    // Generación del inodo en la caché (-1 si no está en memoria)
+    inline long long generation(const std::string& path, int partStart, int i) {
+        std::string mount = key(path, partStart);
+        Shard& shard = shardFor(mount, i);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find({mount, i});
+        return it == shard.index.end() ? -1 : it->second->generation;
+    }
+
+    // Guardar un inodo: leído del disco (limpio) o modificado (sucio)
+    inline void insert(const std::string& path, int partStart, const Superblock& sb,
+                       int i, const Inode& inode, bool dirty) {
+        std::string mount = key(path, partStart);
+        std::shared_ptr<Mount> owner = mountFor(path, partStart, sb);
+        Shard& shard = shardFor(mount, i);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find({mount, i});
+        if (it != shard.index.end()) {
+            it->second->data = inode;
+            it->second->dirty = it->second->dirty || dirty;
+            if (dirty) {
+                it->second->generation = nextGeneration();
+            }
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+        shard.lru.push_front(Entry{mount, i, inode, dirty, owner, nextGeneration()});
+        shard.index[{mount, i}] = shard.lru.begin();
+        evictLocked(shard);
+    }
+
+    // Volcar los inodos sucios de un sistema de archivos (o de todos si 'mount'
+    // está vacío), en orden de número de inodo para escribir la tabla en secuencia
+    inline void flushMount(const std::string& mount) {
+        std::vector<Entry> dirty;
+        for (int s = 0; s < SHARDS; s++) {
+            Shard& shard = shards()[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (Entry& entry : shard.lru) {
+                if (entry.dirty && (mount.empty() || entry.mount == mount)) {
+                    dirty.push_back(entry);
+                    entry.dirty = false;
+                }
+            }
+        }
+        std::sort(dirty.begin(), dirty.end(), [](const Entry& a, const Entry& b) {
+            return a.mount != b.mount ? a.mount < b.mount : a.inode < b.inode;
+        });
+        for (const Entry& entry : dirty) {
+            writeBack(entry);
+        }
+    }
+
+    inline void flush(const std::string& path, int partStart) {
+        flushMount(key(path, partStart));
+    }
+
+    inline void flushAll() {
+        flushMount("");
+    }
+
+    // Olvidar los inodos de un sistema de archivos sin escribirlos
+    // (antes de volver a formatear la partición)
+    inline void discard(const std::string& path, int partStart) {
+        std::string mount = key(path, partStart);
+        for (int s = 0; s < SHARDS; s++) {
+            Shard& shard = shards()[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.lru.begin(); it != shard.lru.end();) {
+                if (it->mount == mount) {
+                    shard.index.erase({it->mount, it->inode});
+                    it = shard.lru.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(mountsMutex());
+        mounts().erase(mount);
+    }
+
+    // Inodos en memoria y cuántos están sucios
+    inline void usage(size_t& entries, size_t& dirty) {
+        entries = 0;
+        dirty = 0;
+        for (int s = 0; s < SHARDS; s++) {
+            Shard& shard = shards()[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            entries += shard.lru.size();
+            for (const Entry& entry : shard.lru) {
+                if (entry.dirty) dirty++;
+            }
+        }
+    }
+
+} // namespace InodeCache
+
+#endif // INODE_CACHE_H
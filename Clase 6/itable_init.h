@@ -0,0 +1,263 @@
+#ifndef ITABLE_INIT_H
+#define ITABLE_INIT_H
+
+#include <string>       // Manejo de la clase std::string
+#include <map>          // Registro de sistemas de archivos con inicialización pendiente
+#include <memory>       // std::shared_ptr
+#include <mutex>        // Exclusión entre el hilo de fondo y el asignador
+#include <thread>       // Hilo de inicialización en segundo plano
+#include <atomic>       // Banderas de cancelación
+#include <chrono>       // Pausas entre grupos
+#include <vector>       // Buffers de ceros
+#include <algorithm>    // std::min
+#include <cstddef>      // offsetof
+#include <fcntl.h>      // open
+#include <unistd.h>     // pread, pwrite, close
+#include <sys/syscall.h>      // syscall(SYS_gettid / SYS_ioprio_set)
+#include <sys/resource.h>     // setpriority
+#include "structures.h"
+#include "filesystem.h"
+#include "buffer_cache.h"
+#include "journal.h"
+
+// Inicialización diferida de la tabla de inodos (estilo lazy_itable_init de ext4).
+// mkfs deja los grupos de la tabla marcados en s_itable_uninit y un hilo de baja
+// prioridad los pone a cero; si el asignador llega antes a un grupo, lo inicializa
+// en el momento con ensureInodeReady()
+namespace ItableInit {
+
+    // Máximo de grupos: uno por bit de Superblock::s_itable_uninit
+    const int MAX_GROUPS = 64;
+
+    // Tamaño mínimo de un grupo de la tabla (256 KB)
+    const long long MIN_GROUP_BYTES = 256 * 1024;
+
+    // Estado compartido por sistema de archivos (disco + inicio de partición)
+    struct State {
+        std::mutex mutex;                 // Serializa la limpieza de grupos
+        std::atomic<bool> running{false}; // Hay un hilo de fondo activo
+        std::atomic<bool> cancel{false};  // Pedir al hilo que termine
+    };
+
+    // Registro global; se reserva en el heap y nunca se destruye porque el hilo
+    // de fondo puede seguir vivo mientras el programa termina
+    inline std::map<std::string, std::shared_ptr<State>>& registry() {
+        static auto* states = new std::map<std::string, std::shared_ptr<State>>();
+        return *states;
+    }
+
+    inline std::mutex& registryMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    inline std::string key(const std::string& path, int partStart) {
+        return path + ":" + std::to_string(partStart);
+    }
+
+    inline std::shared_ptr<State> getState(const std::string& path, int partStart) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto& state = registry()[key(path, partStart)];
+        if (!state) {
+            state = std::make_shared<State>();
+        }
+        return state;
+    }
+
+    // Calcular cuántos grupos usar para una tabla de 'inodes' inodos
+    inline int computeGroups(int inodes) {
+        long long tableBytes = static_cast<long long>(inodes) * sizeof(Inode);
+        long long groups = (tableBytes + MIN_GROUP_BYTES - 1) / MIN_GROUP_BYTES;
+        return static_cast<int>(std::max(1LL, std::min<long long>(MAX_GROUPS, groups)));
+    }
+
+    // Leer/escribir solo la máscara de grupos pendientes, para no pisar el
+    // resto del Superbloque que otros componentes pueden estar actualizando.
+    // Pasa por la caché de bloques, que también guarda el Superbloque; en
+    // EXT3 la escritura se registra en el journal como cualquier metadato
+    inline unsigned long long readMask(const std::string& path, int partStart) {
+        unsigned long long mask = 0;
+        if (!BufferCache::read(path, partStart + offsetof(Superblock, s_itable_uninit), &mask, sizeof(mask))) {
+            return 0;
+        }
+        return mask;
+    }
+
+    inline bool writeMask(const std::string& path, int partStart, const Superblock& sb, unsigned long long mask) {
+        return Journal::writeMetadata(path, partStart, sb, partStart + offsetof(Superblock, s_itable_uninit),
+                                      &mask, sizeof(mask));
+    }
+
+    // Poner a cero el rango de la tabla de inodos que corresponde al grupo g.
+    // Los ceros van directo al disco (sin llenar la caché), pero antes se
+    // aplican a los marcos que ya estén en memoria para que no los pisen
+    inline bool zeroGroup(const std::string& path, int fd, const Superblock& sb, int g) {
+        long long firstInode = static_cast<long long>(g) * sb.s_itable_group_inodes;
+        long long lastInode = std::min<long long>(sb.s_inodes_count, firstInode + sb.s_itable_group_inodes);
+        if (firstInode >= lastInode) {
+            return true;
+        }
+
+        // Con grupos de bloques la tabla no es contigua: se limpia por tramos,
+        // uno por cada grupo de bloques que toque el rango
+        std::vector<char> zeros(static_cast<size_t>(MIN_GROUP_BYTES), 0);
+        int perBlockGroup = FileSystem::inodesPerGroup(sb);
+        while (firstInode < lastInode) {
+            long long segmentEnd = std::min<long long>(lastInode, (firstInode / perBlockGroup + 1) * perBlockGroup);
+            long long begin = FileSystem::inodeOffset(sb, static_cast<int>(firstInode));
+            long long end = begin + (segmentEnd - firstInode) * sb.s_inode_size;
+
+            BufferCache::zeroCached(path, begin, end - begin);
+            for (long long pos = begin; pos < end; pos += zeros.size()) {
+                size_t len = static_cast<size_t>(std::min<long long>(zeros.size(), end - pos));
+                if (pwrite(fd, zeros.data(), len, pos) != static_cast<ssize_t>(len)) {
+                    return false;
+                }
+            }
+            firstInode = segmentEnd;
+        }
+        return true;
+    }
+
+    // Inicializar un grupo si sigue pendiente (llamar con state->mutex tomado)
+    inline bool initGroupLocked(const std::string& path, int fd, int partStart, int g) {
+        Superblock sb;
+        if (!BufferCache::read(path, partStart, &sb, sizeof(Superblock)) ||
+            !FileSystem::acceptSuperblock(sb, partStart)) {
+            return false;
+        }
+        if (g < 0 || g >= MAX_GROUPS || !(sb.s_itable_uninit & (1ULL << g))) {
+            return true;  // Ya inicializado
+        }
+        if (!zeroGroup(path, fd, sb, g)) {
+            return false;
+        }
+        return writeMask(path, partStart, sb, sb.s_itable_uninit & ~(1ULL << g));
+    }
+
+    // Bajar la prioridad de CPU e I/O del hilo actual
+    inline void lowerPriority() {
+        pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+        setpriority(PRIO_PROCESS, tid, 19);
+#ifdef SYS_ioprio_set
+        const int IOPRIO_WHO_PROCESS = 1;
+        const int IOPRIO_CLASS_IDLE = 3;
+        const int IOPRIO_CLASS_SHIFT = 13;
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+#endif
+    }
+
+    // Hilo de fondo: limpia los grupos pendientes uno por uno, del primero al último
+    inline void backgroundWorker(std::string path, int partStart, std::shared_ptr<State> state) {
+        lowerPriority();
+
+        int fd = open(path.c_str(), O_RDWR);
+        if (fd >= 0) {
+            while (!state->cancel) {
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    unsigned long long mask = readMask(path, partStart);
+                    if (mask == 0 || !initGroupLocked(path, fd, partStart, __builtin_ctzll(mask))) {
+                        break;
+                    }
+                }
+                // La máscara queda en la transacción en curso; la confirma la
+                // siguiente operación del hilo principal (o sync), nunca este
+                // hilo, que podría cortar una operación a medias
+                // Ceder el disco a las operaciones interactivas entre grupos
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            close(fd);
+        }
+        state->running = false;
+    }
+
+    // Arrancar (o reanudar) la inicialización en segundo plano si hay grupos pendientes
+    inline void start(const std::string& path, int partStart) {
+        Superblock sb;
+        bool formatted = BufferCache::read(path, partStart, &sb, sizeof(Superblock)) &&
+                         FileSystem::acceptSuperblock(sb, partStart);
+        if (!formatted || sb.s_itable_uninit == 0) {
+            return;
+        }
+
+        auto state = getState(path, partStart);
+        bool expected = false;
+        if (!state->running.compare_exchange_strong(expected, true)) {
+            return;  // Ya hay un hilo trabajando en este sistema de archivos
+        }
+        state->cancel = false;
+        std::thread(backgroundWorker, path, partStart, state).detach();
+    }
+
+    // Detener el hilo de fondo (por ejemplo antes de volver a formatear)
+    inline void stop(const std::string& path, int partStart) {
+        auto state = getState(path, partStart);
+        state->cancel = true;
+        while (state->running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        state->cancel = false;
+    }
+
+    // Detener los hilos de fondo de todo un disco (rmdisk) o, con 'path'
+    // vacío, de todos (antes de salir)
+    inline void stopDisk(const std::string& path) {
+        std::vector<std::shared_ptr<State>> states;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for (const auto& [name, state] : registry()) {
+                if (path.empty() || name.compare(0, path.size() + 1, path + ":") == 0) {
+                    states.push_back(state);
+                }
+            }
+        }
+        for (const auto& state : states) {
+            state->cancel = true;
+        }
+        for (const auto& state : states) {
+            while (state->running) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            state->cancel = false;
+        }
+    }
+
+    inline void stopAll() {
+        stopDisk("");
+    }
+
+    // Garantizar que el grupo del inodo 'inodeIndex' esté en ceros antes de usarlo
+    inline bool ensureInodeReady(const std::string& path, int partStart,
+                                 const Superblock& sb, int inodeIndex) {
+        if (sb.s_itable_group_inodes <= 0) {
+            return true;
+        }
+        int g = inodeIndex / sb.s_itable_group_inodes;
+        if (g >= MAX_GROUPS || !(sb.s_itable_uninit & (1ULL << g))) {
+            return true;  // Los grupos solo pasan de pendiente a listo
+        }
+
+        auto state = getState(path, partStart);
+        std::lock_guard<std::mutex> lock(state->mutex);
+
+        int fd = open(path.c_str(), O_RDWR);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = true;
+        if (readMask(path, partStart) & (1ULL << g)) {
+            ok = initGroupLocked(path, fd, partStart, g);
+        }
+        close(fd);
+        return ok;
+    }
+
+    // Grupos que siguen pendientes de inicializar
+    inline int pendingGroups(const std::string& path, int partStart) {
+        return __builtin_popcountll(readMask(path, partStart));
+    }
+
+} // namespace ItableInit
+
+#endif // ITABLE_INIT_H
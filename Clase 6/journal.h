@@ -0,0 +1,407 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>       // Manejo de la clase std::string
+#include <map>          // Registro de journals abiertos
+#include <memory>       // std::shared_ptr
+#include <mutex>        // Exclusión entre operaciones concurrentes
+#include <vector>       // Registros pendientes
+#include <chrono>       // Intervalo de commit
+#include <cstring>      // memcpy
+#include <fcntl.h>      // open
+#include <unistd.h>     // pread, pwrite, fdatasync, close
+#include "structures.h"
+#include "buffer_cache.h"
+
+// Journal de metadatos para EXT3 con commit agrupado (group commit).
+// Cada actualización de metadatos se escribe en su posición (en la caché de
+// bloques, sin fsync) y se agrega a la transacción en curso. Muchas
+// operaciones se agrupan en una sola transacción, que se escribe de forma
+// secuencial en el journal con un único fdatasync. Los marcos que tocó la
+// transacción quedan fijados en la caché hasta ese fdatasync, así que ni el
+// desalojo ni un volcado escriben en su posición metadatos sin commit. El
+// checkpoint (volcar la caché y fdatasync de las posiciones reales, y
+// reinicio del journal) se hace de forma diferida, solo cuando el journal se
+// llena o en sync
+namespace Journal {
+
+    // Una transacción se confirma al llegar a estas operaciones, bytes o segundos
+    const int COMMIT_MAX_OPERATIONS = 64;
+    const size_t COMMIT_MAX_BYTES = 64 * 1024;
+    const int COMMIT_INTERVAL_SECONDS = 5;
+
+    // Registro pendiente dentro de la transacción en curso
+    struct Record {
+        long long offset;
+        std::vector<char> data;
+        std::vector<char> before;       // Contenido previo a la transacción
+    };
+
+    // Estado en memoria del journal de un sistema de archivos
+    struct Log {
+        std::mutex mutex;
+        int fd = -1;
+        std::string path;
+        int partStart = 0;
+        long long journalStart = 0;     // Inicio del área (JournalHeader)
+        long long journalSize = 0;      // Tamaño total del área
+        long long writePos = 0;         // Siguiente posición libre dentro del área
+        int firstSeq = 1;               // Primera secuencia válida del journal
+        int nextSeq = 1;                // Secuencia de la próxima transacción
+
+        std::vector<Record> pending;    // Transacción en curso
+        std::map<std::pair<long long, int>, size_t> pendingIndex;  // (offset, largo) -> registro
+        size_t pendingBytes = 0;
+        int pendingOperations = 0;
+        std::chrono::steady_clock::time_point lastCommit = std::chrono::steady_clock::now();
+
+        // Estadísticas
+        long long commits = 0;
+        long long checkpoints = 0;
+        long long recordsLogged = 0;
+        long long bytesLogged = 0;
+        long long operations = 0;
+    };
+
+    inline std::map<std::string, std::shared_ptr<Log>>& registry() {
+        static auto* logs = new std::map<std::string, std::shared_ptr<Log>>();
+        return *logs;
+    }
+
+    inline std::mutex& registryMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    inline std::string key(const std::string& path, int partStart) {
+        return path + ":" + std::to_string(partStart);
+    }
+
+    // Suma de verificación FNV-1a de 32 bits
+    inline unsigned int checksum(const char* data, size_t length) {
+        unsigned int hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    inline bool writeHeader(Log& log) {
+        JournalHeader header;
+        header.j_first_seq = log.firstSeq;
+        header.j_size = static_cast<int>(log.journalSize);
+        return pwrite(log.fd, &header, sizeof(header), log.journalStart) == sizeof(header);
+    }
+
+    // Crear un journal vacío (lo usa mkfs -fs=3fs)
+    inline bool format(const std::string& path, long long journalStart, long long journalSize) {
+        int fd = open(path.c_str(), O_RDWR);
+        if (fd < 0) {
+            return false;
+        }
+        JournalHeader header;
+        header.j_size = static_cast<int>(journalSize);
+        bool ok = pwrite(fd, &header, sizeof(header), journalStart) == sizeof(header) &&
+                  fdatasync(fd) == 0;
+        close(fd);
+        return ok;
+    }
+
+    // Checkpoint: hacer durables las escrituras confirmadas en su posición real y
+    // vaciar el journal. Los marcos de la transacción en curso se escriben con
+    // su contenido anterior a ella
+    inline bool checkpointLocked(Log& log) {
+        std::vector<BufferCache::Image> open;
+        for (const Record& record : log.pending) {
+            open.push_back({record.offset, &record.before});
+        }
+        if (!BufferCache::checkpoint(log.path, open) || fdatasync(log.fd) != 0) {
+            return false;
+        }
+        log.firstSeq = log.nextSeq;
+        log.writePos = log.journalStart + sizeof(JournalHeader);
+        log.checkpoints++;
+        return writeHeader(log) && fdatasync(log.fd) == 0;
+    }
+
+    // Soltar los marcos de la transacción en curso y olvidarla
+    inline void releaseLocked(Log& log) {
+        for (const Record& record : log.pending) {
+            BufferCache::unpin(log.path, record.offset, record.data.size());
+        }
+        log.pending.clear();
+        log.pendingIndex.clear();
+        log.pendingBytes = 0;
+        log.pendingOperations = 0;
+    }
+
+    // Confirmar la transacción en curso: una escritura secuencial + un fdatasync.
+    // Solo después se sueltan sus marcos para que vayan a su posición
+    inline bool commitLocked(Log& log) {
+        if (log.pending.empty()) {
+            log.pendingOperations = 0;
+            return true;
+        }
+
+        JournalTransaction tx;
+        tx.t_seq = log.nextSeq;
+        tx.t_records = static_cast<int>(log.pending.size());
+
+        std::vector<char> buffer(sizeof(JournalTransaction));
+        for (const Record& record : log.pending) {
+            JournalRecord header;
+            header.r_offset = record.offset;
+            header.r_length = static_cast<int>(record.data.size());
+            const char* raw = reinterpret_cast<const char*>(&header);
+            buffer.insert(buffer.end(), raw, raw + sizeof(JournalRecord));
+            buffer.insert(buffer.end(), record.data.begin(), record.data.end());
+        }
+        tx.t_bytes = static_cast<int>(buffer.size() - sizeof(JournalTransaction));
+        tx.t_checksum = checksum(buffer.data() + sizeof(JournalTransaction), tx.t_bytes);
+        std::memcpy(buffer.data(), &tx, sizeof(JournalTransaction));
+
+        long long journalEnd = log.journalStart + log.journalSize;
+        long long capacity = log.journalSize - static_cast<long long>(sizeof(JournalHeader));
+        bool ok;
+        if (static_cast<long long>(buffer.size()) > capacity) {
+            // No cabe ni en un journal vacío: hacer durables las escrituras directamente
+            releaseLocked(log);
+            ok = checkpointLocked(log);
+        } else {
+            if (log.writePos + static_cast<long long>(buffer.size()) > journalEnd) {
+                // Journal lleno: checkpoint diferido hasta este momento
+                checkpointLocked(log);
+            }
+            ok = pwrite(log.fd, buffer.data(), buffer.size(), log.writePos) ==
+                     static_cast<ssize_t>(buffer.size()) &&
+                 fdatasync(log.fd) == 0;
+            if (ok) {
+                log.writePos += buffer.size();
+                log.nextSeq++;
+                log.commits++;
+            }
+        }
+
+        releaseLocked(log);
+        log.lastCommit = std::chrono::steady_clock::now();
+        return ok;
+    }
+
+    // Reaplicar las transacciones confirmadas (tras una caída) y dejar el journal vacío.
+    // Devuelve el número de transacciones reaplicadas o -1 si hubo error
+    inline int replay(int fd, const Superblock& sb) {
+        JournalHeader header;
+        if (pread(fd, &header, sizeof(header), sb.s_journal_start) != sizeof(header) ||
+            header.j_magic != JOURNAL_MAGIC) {
+            return -1;
+        }
+
+        long long pos = sb.s_journal_start + sizeof(JournalHeader);
+        long long end = static_cast<long long>(sb.s_journal_start) + sb.s_journal_size;
+        int expectedSeq = header.j_first_seq;
+        int replayed = 0;
+
+        while (pos + static_cast<long long>(sizeof(JournalTransaction)) <= end) {
+            JournalTransaction tx;
+            if (pread(fd, &tx, sizeof(tx), pos) != sizeof(tx) || tx.t_magic != JOURNAL_TX_MAGIC ||
+                tx.t_seq != expectedSeq || tx.t_bytes < 0 ||
+                pos + static_cast<long long>(sizeof(tx)) + tx.t_bytes > end) {
+                break;
+            }
+
+            std::vector<char> payload(tx.t_bytes);
+            if (pread(fd, payload.data(), payload.size(), pos + sizeof(tx)) != tx.t_bytes ||
+                checksum(payload.data(), payload.size()) != tx.t_checksum) {
+                break;  // Transacción incompleta: se descarta
+            }
+
+            size_t cursor = 0;
+            for (int r = 0; r < tx.t_records && cursor + sizeof(JournalRecord) <= payload.size(); r++) {
+                JournalRecord record;
+                std::memcpy(&record, payload.data() + cursor, sizeof(JournalRecord));
+                cursor += sizeof(JournalRecord);
+                if (record.r_length < 0 || cursor + record.r_length > payload.size()) {
+                    break;
+                }
+                pwrite(fd, payload.data() + cursor, record.r_length, record.r_offset);
+                cursor += record.r_length;
+            }
+
+            pos += sizeof(tx) + tx.t_bytes;
+            expectedSeq++;
+            replayed++;
+        }
+
+        // Journal vacío a partir de la siguiente secuencia
+        header.j_first_seq = expectedSeq;
+        fdatasync(fd);
+        pwrite(fd, &header, sizeof(header), sb.s_journal_start);
+        fdatasync(fd);
+        return replayed;
+    }
+
+    // Abrir (o reutilizar) el journal de un sistema de archivos EXT3
+    inline std::shared_ptr<Log> getLog(const std::string& path, int partStart, const Superblock& sb) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto& log = registry()[key(path, partStart)];
+        if (log && log->journalStart == sb.s_journal_start) {
+            return log;
+        }
+
+        auto fresh = std::make_shared<Log>();
+        fresh->fd = open(path.c_str(), O_RDWR);
+        if (fresh->fd < 0) {
+            return nullptr;
+        }
+        JournalHeader header;
+        pread(fresh->fd, &header, sizeof(header), sb.s_journal_start);
+        fresh->path = path;
+        fresh->partStart = partStart;
+        fresh->journalStart = sb.s_journal_start;
+        fresh->journalSize = sb.s_journal_size;
+        fresh->writePos = sb.s_journal_start + sizeof(JournalHeader);
+        fresh->firstSeq = header.j_first_seq;
+        fresh->nextSeq = header.j_first_seq;
+
+        if (log && log->fd >= 0) {
+            close(log->fd);  // Journal de un formateo anterior
+        }
+        log = fresh;
+        return log;
+    }
+
+    // Olvidar el journal en memoria (antes de volver a formatear la partición)
+    inline void discard(const std::string& path, int partStart) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(key(path, partStart));
+        if (it != registry().end()) {
+            std::lock_guard<std::mutex> logLock(it->second->mutex);
+            releaseLocked(*it->second);
+            if (it->second->fd >= 0) {
+                close(it->second->fd);
+                it->second->fd = -1;
+            }
+            registry().erase(it);
+        }
+    }
+
+    // Escribir una estructura de metadatos. En EXT3 se registra además en la
+    // transacción en curso; en EXT2 solo se escribe en su posición
+    inline bool writeMetadata(const std::string& path, int partStart, const Superblock& sb,
+                              long long offset, const void* data, size_t length) {
+        if (sb.s_filesystem_type != 3 || sb.s_journal_start < 0) {
+            return BufferCache::write(path, offset, data, length);
+        }
+
+        auto log = getLog(path, partStart, sb);
+        if (!log) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(log->mutex);
+
+        // Una misma estructura escrita varias veces en la transacción ocupa un
+        // solo registro. Uno nuevo fija sus marcos antes de escribir en ellos
+        const char* bytes = static_cast<const char*>(data);
+        auto found = log->pendingIndex.find({offset, static_cast<int>(length)});
+        if (found != log->pendingIndex.end()) {
+            if (!BufferCache::write(path, offset, data, length)) {
+                return false;
+            }
+            std::memcpy(log->pending[found->second].data.data(), bytes, length);
+        } else {
+            std::vector<char> before(length);
+            if (!BufferCache::pin(path, offset, length)) {
+                return false;
+            }
+            if (!BufferCache::read(path, offset, before.data(), length) ||
+                !BufferCache::write(path, offset, data, length)) {
+                BufferCache::unpin(path, offset, length);
+                return false;
+            }
+            log->pendingIndex[{offset, static_cast<int>(length)}] = log->pending.size();
+            log->pending.push_back({offset, std::vector<char>(bytes, bytes + length), std::move(before)});
+            log->pendingBytes += sizeof(JournalRecord) + length;
+            log->recordsLogged++;
+            log->bytesLogged += length;
+        }
+        return true;
+    }
+
+    // La transacción debe confirmarse al acumular suficientes operaciones, bytes o tiempo
+    inline bool commitDueLocked(const Log& log, int operations) {
+        auto elapsed = std::chrono::steady_clock::now() - log.lastCommit;
+        long long halfJournal = log.journalSize / 2;
+        return operations >= COMMIT_MAX_OPERATIONS ||
+               log.pendingBytes >= COMMIT_MAX_BYTES ||
+               BufferCache::pinnedFrames() >= BufferCache::MAX_PINNED_FRAMES ||
+               static_cast<long long>(log.pendingBytes) >= halfJournal ||
+               elapsed >= std::chrono::seconds(COMMIT_INTERVAL_SECONDS);
+    }
+
+    // ¿Confirmará endOperation() la transacción al terminar la operación en curso?
+    // Las cachés con escritura diferida lo usan para volcar sus metadatos antes
+    inline bool commitDue(const std::string& path, int partStart, const Superblock& sb) {
+        if (sb.s_filesystem_type != 3 || sb.s_journal_start < 0) {
+            return false;
+        }
+        auto log = getLog(path, partStart, sb);
+        if (!log) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(log->mutex);
+        return commitDueLocked(*log, log->pendingOperations + 1);
+    }
+
+    // Marcar el fin de una operación (mkdir, mkfile, ...). La transacción se
+    // confirma cuando se acumulan suficientes operaciones, bytes o tiempo
+    inline bool endOperation(const std::string& path, int partStart, const Superblock& sb) {
+        if (sb.s_filesystem_type != 3 || sb.s_journal_start < 0) {
+            return true;
+        }
+        auto log = getLog(path, partStart, sb);
+        if (!log) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(log->mutex);
+        log->pendingOperations++;
+        log->operations++;
+
+        if (commitDueLocked(*log, log->pendingOperations)) {
+            return commitLocked(*log);
+        }
+        return true;
+    }
+
+    // Confirmar y hacer checkpoint de todos los journals abiertos (sync / salida)
+    inline bool flushAll() {
+        bool ok = true;
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (auto& [name, log] : registry()) {
+            std::lock_guard<std::mutex> logLock(log->mutex);
+            if (log->fd >= 0) {
+                ok = commitLocked(*log) && checkpointLocked(*log) && ok;
+            }
+        }
+        return ok;
+    }
+
+    // Resumen del journal para los reportes
+    inline std::string stats(const std::string& path, int partStart) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(key(path, partStart));
+        if (it == registry().end()) {
+            return "sin actividad";
+        }
+        Log& log = *it->second;
+        std::lock_guard<std::mutex> logLock(log.mutex);
+        return std::to_string(log.operations) + " operaciones, " +
+               std::to_string(log.commits) + " commits, " +
+               std::to_string(log.recordsLogged) + " registros (" +
+               std::to_string(log.bytesLogged) + " bytes), " +
+               std::to_string(log.checkpoints) + " checkpoints";
+    }
+
+} // namespace Journal
+
+#endif // JOURNAL_H
@@ -0,0 +1,67 @@
+#ifndef LOGIN_H
+#define LOGIN_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include "structures.h"
+#include "fileops.h"
+#include "users.h"
+
+namespace CommandLogin {
+
+    // Comando login: abrir la sesión de -user en la partición -id. El usuario
+    // se busca en la tabla ya interpretada de users.txt
+    inline std::string execute(const std::string& user, const std::string& pass, const std::string& id) {
+        if (user.empty() || pass.empty() || id.empty()) {
+            return "Error: login requiere los parámetros -user, -pass y -id";
+        }
+        Users::Session& session = Users::session();
+        if (session.active) {
+            return "Error: ya hay una sesión activa ('" + session.user + "'); use logout primero";
+        }
+
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        std::shared_ptr<const Users::Table> table = Users::table(ctx);
+        auto found = table->users.find(user);
+        if (found == table->users.end() || found->second.password != pass) {
+            return "Error: usuario o contraseña incorrectos";
+        }
+        auto group = table->groups.find(found->second.group);
+        if (group == table->groups.end()) {
+            return "Error: el grupo '" + found->second.group + "' del usuario no existe";
+        }
+
+        session.active = true;
+        session.id = id;
+        session.path = ctx.path;
+        session.partStart = ctx.partStart;
+        session.user = user;
+        session.group = found->second.group;
+        session.uid = found->second.uid;
+        session.gid = group->second.gid;
+
+        std::ostringstream result;
+        result << "\n=== LOGIN ===\n";
+        result << "Sesión iniciada: '" << user << "' (uid " << session.uid << ", grupo '"
+               << session.group << "', gid " << session.gid << ") en " << id;
+        return result.str();
+    }
+
+    // Comando logout: cerrar la sesión activa
+    inline std::string logout() {
+        Users::Session& session = Users::session();
+        if (!session.active) {
+            return "Error: no hay una sesión activa";
+        }
+        std::string user = session.user;
+        session = Users::Session();
+        return "\n=== LOGOUT ===\nSesión de '" + user + "' cerrada";
+    }
+
+} // namespace CommandLogin
+
+#endif // LOGIN_H
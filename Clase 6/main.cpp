@@ -13,7 +13,21 @@
 #include "fdisk.h"     
 #include "mount.h"
 #include "mkfs.h"
-#include "rep.h"     
+#include "rep.h"
+#include "mkdir.h"
+#include "mkfile.h"
+#include "append.h"
+#include "cat.h"
+#include "import.h"
+#include "export.h"
+#include "copy.h"
+#include "remove.h"
+#include "stats.h"
+#include "sync.h"
+#include "fsck.h"
+#include "login.h"
+#include "mkusr.h"
+#include "rmusr.h"
 
 
 // Función para convertir string a minúsculas
@@ -76,6 +90,19 @@ std::string parseParameter(const std::string& commandLine, const std::string& pa
     }
 }
 
+// Función para detectar parámetros sin valor (por ejemplo -p o -r)
+bool hasFlag(const std::string& commandLine, const std::string& flagName) {
+    std::istringstream iss(commandLine);
+    std::string token;
+    std::string lowerFlagName = toLowerCase(flagName);
+    while (iss >> token) {
+        if (toLowerCase(token) == lowerFlagName) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Función para parsear y ejecutar comandos
 std::string executeCommand(const std::string& commandLine) {
     std::istringstream iss(commandLine);
@@ -205,24 +232,141 @@ std::string executeCommand(const std::string& commandLine) {
     } else if (cmd == "mount") {
         std::string path = parseParameter(commandLine, "-path");
         std::string name = parseParameter(commandLine, "-name");
+        std::string opts = parseParameter(commandLine, "-opts");
         
         if (path.empty() || name.empty()) {
             return "Error: mount requiere parámetros -path y -name\n"
-                   "Uso: mount -path=ruta -name=nombre";
+                   "Uso: mount -path=ruta -name=nombre [-opts=noatime|relatime|strictatime]";
         }
         
-        return CommandMount::execute(path, name);
+        return CommandMount::execute(path, name, opts);
 
     } else if (cmd == "mkfs") {
         std::string id = parseParameter(commandLine, "-id");
         std::string type = parseParameter(commandLine, "-type");
+        std::string rev = parseParameter(commandLine, "-rev");
+        std::string lazy = parseParameter(commandLine, "-lazy");
+        std::string bs = parseParameter(commandLine, "-bs");
+        std::string inodes = parseParameter(commandLine, "-inodes");
+        std::string ratio = parseParameter(commandLine, "-ratio");
+        std::string fs = parseParameter(commandLine, "-fs");
+        std::string groups = parseParameter(commandLine, "-groups");
+        std::string dirIndex = parseParameter(commandLine, "-dirindex");
+        std::string extents = parseParameter(commandLine, "-extents");
+        std::string inlineData = parseParameter(commandLine, "-inline");
+        std::string reflink = parseParameter(commandLine, "-reflink");
         
         if (id.empty()) {
             return "Error: mkfs requiere el parámetro -id\n"
-                   "Uso: mkfs -id=id [-type=full]";
+                   "Uso: mkfs -id=id [-type=full|fast] [-fs=2fs|3fs] [-rev=0|1] [-lazy=0|1]\n"
+                   "            [-bs=64|256|1024|4096] [-inodes=N | -ratio=bytes_por_inodo] [-groups=N]\n"
+                   "            [-dirindex=0|1] [-extents=0|1] [-inline=0|1] [-reflink=0|1]";
+        }
+        
+        return CommandMkfs::execute(id, type, rev, lazy, bs, inodes, ratio, fs, groups, dirIndex, extents, inlineData,
+                                    reflink);
+
+    } else if (cmd == "mkdir") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::string path = parseParameter(commandLine, "-path");
+        
+        if (id.empty() || path.empty()) {
+            return "Error: mkdir requiere parámetros -id y -path\n"
+                   "Uso: mkdir -id=id -path=ruta [-p]";
         }
         
-        return CommandMkfs::execute(id, type);
+        return CommandMkdir::execute(id, path, hasFlag(commandLine, "-p"));
+
+    } else if (cmd == "mkfile") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::string path = parseParameter(commandLine, "-path");
+        std::string size = parseParameter(commandLine, "-size");
+        std::string cont = parseParameter(commandLine, "-cont");
+        
+        if (id.empty() || path.empty()) {
+            return "Error: mkfile requiere parámetros -id y -path\n"
+                   "Uso: mkfile -id=id -path=ruta [-size=N] [-cont=ruta_host] [-r]";
+        }
+        
+        return CommandMkfile::execute(id, path, size, cont, hasFlag(commandLine, "-r"));
+
+    } else if (cmd == "append") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::string path = parseParameter(commandLine, "-path");
+        std::string size = parseParameter(commandLine, "-size");
+        std::string cont = parseParameter(commandLine, "-cont");
+
+        if (id.empty() || path.empty() || (size.empty() && cont.empty())) {
+            return "Error: append requiere parámetros -id, -path y -size o -cont\n"
+                   "Uso: append -id=id -path=ruta [-size=N] [-cont=ruta_host]";
+        }
+
+        return CommandAppend::execute(id, path, size, cont);
+
+    } else if (cmd == "import") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::string src = parseParameter(commandLine, "-src");
+        std::string dest = parseParameter(commandLine, "-dest");
+
+        if (id.empty() || src.empty() || dest.empty()) {
+            return "Error: import requiere parámetros -id, -src y -dest\n"
+                   "Uso: import -id=id -src=carpeta_host -dest=ruta";
+        }
+
+        return CommandImport::execute(id, src, dest);
+
+    } else if (cmd == "export") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::string path = parseParameter(commandLine, "-path");
+        std::string out = parseParameter(commandLine, "-out");
+
+        if (id.empty() || out.empty()) {
+            return "Error: export requiere parámetros -id y -out\n"
+                   "Uso: export -id=id [-path=ruta] -out=archivo.tar";
+        }
+
+        return CommandExport::execute(id, path, out);
+
+    } else if (cmd == "copy") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::string path = parseParameter(commandLine, "-path");
+        std::string destino = parseParameter(commandLine, "-destino");
+
+        if (id.empty() || path.empty() || destino.empty()) {
+            return "Error: copy requiere parámetros -id, -path y -destino\n"
+                   "Uso: copy -id=id -path=ruta -destino=carpeta";
+        }
+
+        return CommandCopy::execute(id, path, destino);
+
+    } else if (cmd == "remove") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::string path = parseParameter(commandLine, "-path");
+
+        if (id.empty() || path.empty()) {
+            return "Error: remove requiere parámetros -id y -path\n"
+                   "Uso: remove -id=id -path=ruta";
+        }
+
+        return CommandRemove::execute(id, path);
+
+    } else if (cmd == "cat") {
+        std::string id = parseParameter(commandLine, "-id");
+        std::vector<std::string> files;
+        for (int n = 1; ; n++) {
+            std::string file = parseParameter(commandLine, "-file" + std::to_string(n));
+            if (file.empty()) {
+                break;
+            }
+            files.push_back(file);
+        }
+
+        if (id.empty() || files.empty()) {
+            return "Error: cat requiere parámetros -id y -file1\n"
+                   "Uso: cat -id=id -file1=ruta [-file2=ruta ...]";
+        }
+
+        return CommandCat::execute(id, files);
 
     } else if (cmd == "rep") {
         std::string name = parseParameter(commandLine, "-name");
@@ -243,6 +387,62 @@ std::string executeCommand(const std::string& commandLine) {
         
         return CommandRep::execute(name, path, id, pathFileLs);
 
+    } else if (cmd == "fsck") {
+        // Revisar la consistencia de una partición (-repair corrige)
+        std::string id = parseParameter(commandLine, "-id");
+
+        if (id.empty()) {
+            return "Error: fsck requiere el parámetro -id\n"
+                   "Uso: fsck -id=id [-repair]";
+        }
+
+        return CommandFsck::execute(id, hasFlag(commandLine, "-repair"));
+
+    } else if (cmd == "login") {
+        std::string user = parseParameter(commandLine, "-user");
+        std::string pass = parseParameter(commandLine, "-pass");
+        std::string id = parseParameter(commandLine, "-id");
+
+        if (user.empty() || pass.empty() || id.empty()) {
+            return "Error: login requiere parámetros -user, -pass y -id\n"
+                   "Uso: login -user=usuario -pass=contraseña -id=id";
+        }
+
+        return CommandLogin::execute(user, pass, id);
+
+    } else if (cmd == "logout") {
+        return CommandLogin::logout();
+
+    } else if (cmd == "mkusr") {
+        std::string user = parseParameter(commandLine, "-user");
+        std::string pass = parseParameter(commandLine, "-pass");
+        std::string grp = parseParameter(commandLine, "-grp");
+
+        if (user.empty() || pass.empty() || grp.empty()) {
+            return "Error: mkusr requiere parámetros -user, -pass y -grp\n"
+                   "Uso: mkusr -user=usuario -pass=contraseña -grp=grupo";
+        }
+
+        return CommandMkusr::execute(user, pass, grp);
+
+    } else if (cmd == "rmusr") {
+        std::string user = parseParameter(commandLine, "-user");
+
+        if (user.empty()) {
+            return "Error: rmusr requiere el parámetro -user\n"
+                   "Uso: rmusr -user=usuario";
+        }
+
+        return CommandRmusr::execute(user);
+
+    } else if (cmd == "sync") {
+        // Escribir al disco todo lo que sigue en las cachés
+        return CommandSync::execute();
+
+    } else if (cmd == "stats") {
+        // Contadores de las cachés
+        return CommandStats::execute();
+
     } else if (cmd == "mounted") {
         // Mostrar todas las particiones montadas
         return CommandMount::listMountedPartitions();
@@ -331,6 +531,17 @@ void executeMultipleCommands(const std::string& commands) {
     }
 }
 
+// Escribir lo pendiente antes de salir (con los hilos de fondo ya detenidos);
+// si algo no llegó al disco se avisa y el programa termina con error
+int syncAtExit() {
+    ItableInit::stopAll();
+    std::string error = CommandSync::syncAll();
+    if (!error.empty()) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
     // Inicializar semilla para números aleatorios
@@ -347,13 +558,13 @@ int main(int argc, char* argv[]) {
             std::cout << "C++ DISK\n";
             std::cout << "MIA Proyecto 1 - 2026\n\n";
             executeFromFile(argv[2]);
-            return 0;
+            return syncAtExit();
         } else if (arg1 == "-e" && argc > 2) {
             // Ejecutar comando(s) desde argumento
             std::cout << "C++ DISK\n";
             std::cout << "MIA Proyecto 1 - 2026\n\n";
             executeMultipleCommands(argv[2]);
-            return 0;
+            return syncAtExit();
         } else {
             std::cerr << "Error: Opción no reconocida\n";
             return 1;
@@ -397,5 +608,6 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    return 0;
+    // Escribir los metadatos pendientes antes de salir
+    return syncAtExit();
 }
@@ -0,0 +1,75 @@
+#ifndef MKDIR_H
+#define MKDIR_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <vector>       // Componentes de la ruta
+#include "structures.h"
+#include "fileops.h"
+#include "users.h"
+
+namespace CommandMkdir {
+
+    // Comando mkdir: crear una carpeta; con -p crea también las carpetas padre
+    inline std::string execute(const std::string& id, const std::string& path, bool parents) {
+        if (id.empty()) {
+            return "Error: mkdir requiere el parámetro -id";
+        }
+        if (path.empty()) {
+            return "Error: mkdir requiere el parámetro -path";
+        }
+
+        std::vector<std::string> parts;
+        std::string error = FileOps::splitPath(path, parts);
+        if (!error.empty()) {
+            return error;
+        }
+        if (parts.empty()) {
+            return "Error: la carpeta raíz ya existe";
+        }
+
+        FileOps::Context ctx;
+        error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+
+        error = Users::checkCreate(ctx, parts, path);
+        if (!error.empty()) {
+            return error;
+        }
+
+        int created = 0;
+        int parentIndex = FileOps::resolveParent(ctx, parts, parents, error, &created);
+        if (parentIndex == -1) {
+            FileOps::finish(ctx);
+            return error;
+        }
+
+        Inode parent = FileOps::readInode(ctx, parentIndex);
+        if (FileOps::lookup(ctx, parentIndex, parent, parts.back()) != -1) {
+            FileOps::finish(ctx);
+            if (parents) {
+                return "La carpeta '" + path + "' ya existe";
+            }
+            return "Error: ya existe '" + parts.back() + "' en la carpeta destino";
+        }
+
+        int inodeIndex = FileOps::createDirectory(ctx, parentIndex, parent, parts.back(), error);
+        FileOps::finish(ctx);
+        if (inodeIndex == -1) {
+            return error;
+        }
+
+        std::ostringstream result;
+        result << "\n=== MKDIR ===\n";
+        result << "Carpeta '" << path << "' creada exitosamente (inodo " << inodeIndex << ")";
+        if (created > 0) {
+            result << "\n  Carpetas padre creadas: " << created;
+        }
+        return result.str();
+    }
+
+} // namespace CommandMkdir
+
+#endif // MKDIR_H
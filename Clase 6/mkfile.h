@@ -0,0 +1,128 @@
+#ifndef MKFILE_H
+#define MKFILE_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <fstream>      // Lectura del archivo de contenido (-cont)
+#include <vector>       // Componentes de la ruta
+#include "structures.h"
+#include "fileops.h"
+#include "users.h"
+#include "mount.h"
+
+namespace CommandMkfile {
+
+    // Contenido de un archivo de 'size' bytes: "0123456789" repetido
+    inline std::string generateContent(int size) {
+        std::string content(size, '0');
+        for (int i = 0; i < size; i++) {
+            content[i] = static_cast<char>('0' + i % 10);
+        }
+        return content;
+    }
+
+    // Comando mkfile: crear un archivo con el contenido de un archivo del host
+    // (-cont, tiene prioridad sobre -size) o uno disperso de -size bytes en
+    // ceros, que no ocupa bloques hasta que se escriba; con -r crea también
+    // las carpetas padre
+    inline std::string execute(const std::string& id, const std::string& path, const std::string& sizeParam,
+                               const std::string& cont, bool recursive) {
+        if (id.empty()) {
+            return "Error: mkfile requiere el parámetro -id";
+        }
+        if (path.empty()) {
+            return "Error: mkfile requiere el parámetro -path";
+        }
+
+        // Contenido del archivo
+        std::string content;
+        long long size = 0;
+        if (!cont.empty()) {
+            std::string hostPath = CommandMount::expandPath(cont);
+            std::ifstream source(hostPath, std::ios::binary);
+            if (!source.is_open()) {
+                return "Error: no se pudo abrir el archivo de contenido '" + cont + "'";
+            }
+            std::ostringstream buffer;
+            buffer << source.rdbuf();
+            content = buffer.str();
+            size = static_cast<long long>(content.size());
+        } else if (!sizeParam.empty()) {
+            try {
+                size = std::stoll(sizeParam);
+            } catch (const std::exception& e) {
+                size = -1;
+            }
+            if (size < 0) {
+                return "Error: size debe ser un número entero no negativo";
+            }
+        }
+
+        std::vector<std::string> parts;
+        std::string error = FileOps::splitPath(path, parts);
+        if (!error.empty()) {
+            return error;
+        }
+        if (parts.empty()) {
+            return "Error: mkfile requiere la ruta de un archivo";
+        }
+
+        FileOps::Context ctx;
+        error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+
+        // El hueco de -size también debe caber en el inodo (antes de crear nada)
+        if (content.empty() && !FileOps::fitsInInode(ctx.sb, FileOps::newFileInode(ctx.sb), size)) {
+            return "Error: el archivo supera el tamaño máximo que admite un inodo";
+        }
+
+        error = Users::checkCreate(ctx, parts, path);
+        if (!error.empty()) {
+            return error;
+        }
+
+        int created = 0;
+        int parentIndex = FileOps::resolveParent(ctx, parts, recursive, error, &created);
+        if (parentIndex == -1) {
+            FileOps::finish(ctx);
+            return error;
+        }
+
+        Inode parent = FileOps::readInode(ctx, parentIndex);
+        if (FileOps::lookup(ctx, parentIndex, parent, parts.back()) != -1) {
+            FileOps::finish(ctx);
+            return "Error: ya existe '" + parts.back() + "' en la carpeta destino";
+        }
+
+        int inodeIndex = FileOps::createFile(ctx, parentIndex, parent, parts.back(), content, error);
+        bool sparse = false;
+        if (inodeIndex != -1 && error.empty() && content.empty()) {
+            // Sin -cont el archivo es un hueco de -size bytes
+            Inode inode = FileOps::readInode(ctx, inodeIndex);
+            error = FileOps::extendSparse(ctx, inodeIndex, inode, size);
+            sparse = size > 0 && !FileSystem::hasInlineData(inode);
+        }
+        FileOps::finish(ctx);
+        if (inodeIndex == -1 || !error.empty()) {
+            return error;
+        }
+
+        std::ostringstream result;
+        result << "\n=== MKFILE ===\n";
+        result << "Archivo '" << path << "' creado exitosamente (inodo " << inodeIndex << ", "
+               << size << " bytes";
+        if (sparse) {
+            result << ", disperso";
+        }
+        result << ")";
+        if (created > 0) {
+            result << "\n  Carpetas padre creadas: " << created;
+        }
+        return result.str();
+    }
+
+} // namespace CommandMkfile
+
+#endif // MKFILE_H
@@ -8,7 +8,21 @@
 #include <cstring>    // Funciones para manejo de cadenas
 #include <cmath>      // Funciones matemáticas
 #include <algorithm>  // Algoritmos estándar
+#include <chrono>     // Medición del tiempo de formateo
+#include <iomanip>    // Formato de números decimales
 #include "structures.h"
+#include "bitmap.h"
+#include "filesystem.h"
+#include "diskio.h"
+#include "itable_init.h"
+#include "journal.h"
+#include "allocator.h"
+#include "inode_cache.h"
+#include "dentry_cache.h"
+#include "buffer_cache.h"
+#include "delalloc.h"
+#include "users.h"
+#include "atime.h"
 #include "mount.h"    
 
 namespace CommandMkfs {
@@ -19,7 +33,158 @@ namespace CommandMkfs {
         return result;
     }
     
-    inline std::string execute(const std::string& id, const std::string& type) {
+    // Calcular n (número de estructuras) para que Superbloque ('sbBytes' en
+    // disco), bitmaps, n inodos y 3n bloques de 'blockSize' bytes quepan
+    // dentro de la partición
+    inline int computeStructureCount(int partitionSize, int revLevel, int blockSize, int sbBytes) {
+        long long available = partitionSize - static_cast<long long>(sbBytes);
+        if (available <= 0) {
+            return 0;
+        }
+        
+        long long perInode = sizeof(Inode) + 3LL * blockSize;  // 1 inodo y sus 3 bloques
+        if (revLevel < FS_REV_PACKED_BITMAPS) {
+            // 4 bytes para bitmaps, 1 inodo, 3 bloques por inodo
+            return available / (4 + perInode);
+        }
+        
+        // Bitmaps empaquetados: 4 bits (medio byte) por cada inodo y sus 3 bloques
+        long long n = (2 * available) / (1 + 2 * perInode);
+        while (n > 0 && Bitmap::diskBytes(n, revLevel) + Bitmap::diskBytes(3 * n, revLevel) +
+                        n * perInode > available) {
+            n--;  // Ajustar por el redondeo de los bytes de bitmap
+        }
+        return static_cast<int>(n);
+    }
+    
+    // Bloques que caben junto a 'inodes' inodos: cada bloque cuesta sus bytes
+    // de datos más su entrada en el bitmap de bloques
+    inline int computeBlockCount(int partitionSize, int revLevel, int blockSize, int inodes, int sbBytes) {
+        long long available = partitionSize - static_cast<long long>(sbBytes) -
+                              Bitmap::diskBytes(inodes, revLevel) -
+                              static_cast<long long>(inodes) * sizeof(Inode);
+        if (available <= 0) {
+            return 0;
+        }
+        
+        if (revLevel < FS_REV_PACKED_BITMAPS) {
+            return available / (1 + blockSize);
+        }
+        
+        long long blocks = (8 * available) / (1 + 8LL * blockSize);
+        while (blocks > 0 && Bitmap::diskBytes(blocks, revLevel) + blocks * blockSize > available) {
+            blocks--;
+        }
+        return static_cast<int>(blocks);
+    }
+    
+    // Tamaño del journal EXT3: 1/32 de la partición, entre 64 KB y 32 MB,
+    // sin pasar de la cuarta parte de la partición
+    inline int computeJournalSize(int partitionSize) {
+        long long size = std::max(64LL * 1024, std::min(32LL * 1024 * 1024, partitionSize / 32LL));
+        return static_cast<int>(std::min<long long>(size, partitionSize / 4));
+    }
+    
+    // Distribución elegida para la partición
+    struct Layout {
+        int inodes;               // Inodos en la tabla
+        int blocks;               // Bloques de datos
+        long long metadataBytes;  // Superbloque + bitmaps + tabla de inodos
+        int groups;               // Grupos de bloques (1 = distribución clásica)
+        int inodesPerGroup;
+        int blocksPerGroup;
+        long long groupSize;      // Bytes por grupo
+    };
+    
+    // Bytes de un grupo con 'inodes' inodos y 'blocks' bloques
+    inline long long groupBytes(int inodes, int blocks, int revLevel, int blockSize) {
+        return Bitmap::diskBytes(inodes, revLevel) + Bitmap::diskBytes(blocks, revLevel) +
+               static_cast<long long>(inodes) * sizeof(Inode) +
+               static_cast<long long>(blocks) * blockSize;
+    }
+    
+    // Repartir inodos y bloques en 'groups' grupos iguales que quepan en
+    // 'available' bytes; cada grupo tiene sus propios bitmaps (que se redondean
+    // por separado), así que se quitan bloques hasta que todo quepa
+    inline std::string splitIntoGroups(Layout& layout, int groups, long long available,
+                                       int revLevel, int blockSize, int sbBytes) {
+        layout.groups = groups;
+        layout.inodesPerGroup = layout.inodes / groups;
+        layout.blocksPerGroup = layout.blocks / groups;
+        if (layout.inodesPerGroup < 2 || layout.blocksPerGroup < 2) {
+            return "Error: demasiados grupos para el tamaño de la partición";
+        }
+        
+        while (layout.blocksPerGroup > 2 &&
+               groups * groupBytes(layout.inodesPerGroup, layout.blocksPerGroup, revLevel, blockSize) > available) {
+            layout.blocksPerGroup--;
+        }
+        layout.groupSize = groupBytes(layout.inodesPerGroup, layout.blocksPerGroup, revLevel, blockSize);
+        if (groups * layout.groupSize > available) {
+            return "Error: demasiados grupos para el tamaño de la partición";
+        }
+        
+        layout.inodes = layout.inodesPerGroup * groups;
+        layout.blocks = layout.blocksPerGroup * groups;
+        layout.metadataBytes = static_cast<long long>(sbBytes) +
+                               static_cast<long long>(groups) * sizeof(GroupDescriptor) +
+                               groups * (Bitmap::diskBytes(layout.inodesPerGroup, revLevel) +
+                                         Bitmap::diskBytes(layout.blocksPerGroup, revLevel)) +
+                               static_cast<long long>(layout.inodes) * sizeof(Inode);
+        return "";
+    }
+    
+    // Calcular la distribución: con -inodes o -ratio se fija el número de inodos
+    // y el resto del espacio se reparte en bloques; sin ellos se usa n inodos y 3n bloques
+    inline std::string computeLayout(int partitionSize, int revLevel, int blockSize, int sbBytes,
+                                     const std::string& inodesParam, const std::string& ratioParam,
+                                     Layout& layout) {
+        if (!inodesParam.empty() && !ratioParam.empty()) {
+            return "Error: use solo uno de -inodes o -ratio";
+        }
+        
+        if (inodesParam.empty() && ratioParam.empty()) {
+            layout.inodes = computeStructureCount(partitionSize, revLevel, blockSize, sbBytes);
+            layout.blocks = 3 * layout.inodes;
+        } else {
+            long long value;
+            try {
+                value = std::stoll(inodesParam.empty() ? ratioParam : inodesParam);
+            } catch (const std::exception& e) {
+                value = 0;
+            }
+            if (value <= 0) {
+                return inodesParam.empty() ? "Error: ratio debe ser un número positivo de bytes por inodo"
+                                           : "Error: inodes debe ser un número entero positivo";
+            }
+            
+            long long inodes = inodesParam.empty() ? partitionSize / value : value;
+            if (inodes > partitionSize) {
+                return "Error: demasiados inodos para el tamaño de la partición";
+            }
+            layout.inodes = static_cast<int>(inodes);
+            layout.blocks = computeBlockCount(partitionSize, revLevel, blockSize, layout.inodes, sbBytes);
+        }
+        
+        // Se necesitan al menos 2 inodos y 2 bloques (raíz y users.txt)
+        if (layout.inodes < 2 || layout.blocks < 2) {
+            return "Error: la partición es muy pequeña para crear un sistema de archivos con esa distribución";
+        }
+        
+        layout.metadataBytes = static_cast<long long>(sbBytes) +
+                               Bitmap::diskBytes(layout.inodes, revLevel) +
+                               Bitmap::diskBytes(layout.blocks, revLevel) +
+                               static_cast<long long>(layout.inodes) * sizeof(Inode);
+        return "";
+    }
+    
+    inline std::string execute(const std::string& id, const std::string& type,
+                               const std::string& rev = "", const std::string& lazy = "",
+                               const std::string& bs = "", const std::string& inodesParam = "",
+                               const std::string& ratioParam = "", const std::string& fs = "",
+                               const std::string& groupsParam = "", const std::string& dirIndex = "",
+                               const std::string& extentsParam = "", const std::string& inlineParam = "",
+                               const std::string& reflinkParam = "") {
         // Validar parámetros
         if (id.empty()) {
             return "Error: mkfs requiere el parámetro -id";
@@ -30,12 +195,105 @@ namespace CommandMkfs {
             formatType = "full";  // Por defecto formateo completo
         }
         
-        if (formatType != "full") {
-            return "Error: type debe ser 'full'";
+        if (formatType != "full" && formatType != "fast") {
+            return "Error: type debe ser 'full' o 'fast'";
+        }
+        
+        // Revisión del formato: por defecto bitmaps empaquetados
+        int revLevel = FS_REV_PACKED_BITMAPS;
+        if (!rev.empty()) {
+            if (rev == "0") {
+                revLevel = FS_REV_ASCII_BITMAPS;
+            } else if (rev != "1") {
+                return "Error: rev debe ser 0 (bitmaps ASCII) o 1 (bitmaps empaquetados)";
+            }
+        }
+        
+        // Inicialización diferida de la tabla de inodos (por defecto activada)
+        bool lazyItable = true;
+        if (!lazy.empty()) {
+            if (lazy == "0") {
+                lazyItable = false;
+            } else if (lazy != "1") {
+                return "Error: lazy debe ser 0 o 1";
+            }
+        }
+        
+        // Índice por hash en carpetas grandes (por defecto activado)
+        bool indexDirs = true;
+        if (!dirIndex.empty()) {
+            if (dirIndex == "0") {
+                indexDirs = false;
+            } else if (dirIndex != "1") {
+                return "Error: dirindex debe ser 0 o 1";
+            }
+        }
+        
+        // Archivos nuevos con extents en vez de apuntadores (por defecto no)
+        bool extents = false;
+        if (!extentsParam.empty()) {
+            if (extentsParam == "1") {
+                extents = true;
+            } else if (extentsParam != "0") {
+                return "Error: extents debe ser 0 o 1";
+            }
+        }
+        
+        // Archivos pequeños dentro del inodo (por defecto activado)
+        bool inlineData = true;
+        if (!inlineParam.empty()) {
+            if (inlineParam == "0") {
+                inlineData = false;
+            } else if (inlineParam != "1") {
+                return "Error: inline debe ser 0 o 1";
+            }
         }
         
-        // Siempre se formatea como ext2
-        std::string fsType = "ext2";
+        // Copias que comparten bloques con una tabla de referencias (por defecto no)
+        bool reflink = false;
+        if (!reflinkParam.empty()) {
+            if (reflinkParam == "1") {
+                reflink = true;
+            } else if (reflinkParam != "0") {
+                return "Error: reflink debe ser 0 o 1";
+            }
+        }
+        
+        // Tamaño de bloque (por defecto 64 bytes, el formato clásico)
+        int blockSize = 64;
+        if (!bs.empty()) {
+            try {
+                blockSize = std::stoi(bs);
+            } catch (const std::exception& e) {
+                blockSize = 0;
+            }
+            if (!FileSystem::isValidBlockSize(blockSize)) {
+                return "Error: bs debe ser 64, 256, 1024 o 4096";
+            }
+        }
+        
+        // Grupos de bloques (por defecto 1: distribución clásica)
+        int groups = 1;
+        if (!groupsParam.empty()) {
+            try {
+                groups = std::stoi(groupsParam);
+            } catch (const std::exception& e) {
+                groups = 0;
+            }
+            if (groups < 1) {
+                return "Error: groups debe ser un número entero positivo";
+            }
+        }
+        
+        // Sistema de archivos: 2fs (EXT2, por defecto) o 3fs (EXT3 con journal)
+        std::string fsType = toLowerCase(fs);
+        if (fsType.empty()) {
+            fsType = "2fs";
+        }
+        if (fsType != "2fs" && fsType != "3fs") {
+            return "Error: fs debe ser '2fs' o '3fs'";
+        }
+        bool ext3 = fsType == "3fs";
         
         // Buscar la partición montada
         CommandMount::MountedPartition partition;
@@ -43,6 +301,22 @@ namespace CommandMkfs {
             return "Error: la partición con ID '" + id + "' no está montada";
         }
         
+        // Detener una inicialización en segundo plano de un formateo anterior
+        // y olvidar su journal
+        ItableInit::stop(partition.path, partition.start);
+        Journal::discard(partition.path, partition.start);
+        Allocator::discard(partition.path, partition.start);
+        DelayedAlloc::discard(partition.path, partition.start);
+        Atime::discard(partition.path, partition.start);
+        InodeCache::discard(partition.path, partition.start);
+        Users::discard(partition.path, partition.start);
+        DentryCache::invalidateAll(partition.path, partition.start);
+        
+        // mkfs escribe la partición directamente: se vuelcan los marcos
+        // pendientes del disco y se olvidan los de la partición
+        BufferCache::invalidate(partition.path, partition.start,
+                                static_cast<long long>(partition.start) + partition.size);
+        
         // Abrir el disco
         std::fstream file(partition.path, std::ios::binary | std::ios::in | std::ios::out);
         if (!file.is_open()) {
@@ -52,53 +326,203 @@ namespace CommandMkfs {
         // Calcular el número de estructuras según el tamaño de la partición
         int partitionSize = partition.size;
         
-        // Calcular n (número de estructuras)
-        // donde 4 bytes para bitmaps, 1 inodo, 3 bloques por inodo
-        int numerator = partitionSize - sizeof(Superblock);
-        int denominator = 4 + sizeof(Inode) + 3 * 64;  // 64 es el tamaño de un bloque
-        int n = numerator / denominator;
+        // En EXT3 el journal se reserva justo después del Superbloque
+        int journalSize = ext3 ? computeJournalSize(partitionSize) : 0;
+        
+        // Con grupos, la tabla de descriptores va después del journal
+        int gdtSize = groups > 1 ? groups * static_cast<int>(sizeof(GroupDescriptor)) : 0;
+        
+        // Si el formato no usa nada de la extensión del Superbloque (revisión
+        // 0, un grupo, EXT2, sin características ni tabla diferida), se
+        // escriben solo los 80 bytes clásicos y el resto queda igual que en
+        // el formato original: bitmaps ASCII justo después del Superbloque
+        bool classic = revLevel == FS_REV_ASCII_BITMAPS && groups == 1 && !ext3 && !indexDirs &&
+                       !extents && !inlineData && !reflink;
+        int sbBytes = classic ? FileSystem::CLASSIC_SUPERBLOCK_SIZE : static_cast<int>(sizeof(Superblock));
+        
+        // Calcular n (número de inodos) y el número de bloques dejando fuera
+        // 'reserved' bytes de metadatos extra
+        Layout layout;
+        auto plan = [&](int reserved) {
+            int space = partitionSize - journalSize - gdtSize - reserved;
+            std::string error = computeLayout(space, revLevel, blockSize, sbBytes, inodesParam, ratioParam, layout);
+            if (error.empty()) {
+                if (groups > 1) {
+                    long long available = static_cast<long long>(space) - sbBytes;
+                    error = splitIntoGroups(layout, groups, available, revLevel, blockSize, sbBytes);
+                } else {
+                    layout.groups = 1;
+                    layout.inodesPerGroup = layout.inodes;
+                    layout.blocksPerGroup = layout.blocks;
+                    layout.groupSize = groupBytes(layout.inodes, layout.blocks, revLevel, blockSize);
+                }
+            }
+            return error;
+        };
         
-        if (n <= 0) {
+        // Con reflink, la tabla de referencias (un byte por bloque) va después
+        // de la tabla de descriptores: se mide con la distribución sin ella y
+        // luego se reparte lo que queda, que nunca tiene más bloques
+        std::string layoutError = plan(0);
+        int refcountSize = 0;
+        if (layoutError.empty() && reflink) {
+            refcountSize = layout.blocks;
+            layoutError = plan(refcountSize);
+        }
+        // La tabla diferida se anota en la extensión del Superbloque, pero solo
+        // hace falta si la tabla da para más de un grupo; si no, el formato
+        // sigue siendo el clásico
+        if (layoutError.empty() && classic && formatType == "full" && lazyItable &&
+            ItableInit::computeGroups(layout.inodes) > 1) {
+            classic = false;
+            sbBytes = static_cast<int>(sizeof(Superblock));
+            layoutError = plan(0);
+        }
+        if (!layoutError.empty()) {
             file.close();
-            return "Error: la partición es muy pequeña para crear un sistema de archivos";
+            return layoutError;
         }
+        layout.metadataBytes += journalSize + refcountSize;
+        int n = layout.inodes;
+        int blocks = layout.blocks;
         
         // Crear el Superbloque
         Superblock sb;
-        sb.s_filesystem_type = 2;  // ext2
+        sb.s_filesystem_type = ext3 ? 3 : 2;
         sb.s_inodes_count = n;
-        sb.s_blocks_count = 3 * n;
-        sb.s_free_blocks_count = 3 * n - 2;  // Se usan 2 bloques: raíz y users.txt
+        sb.s_blocks_count = blocks;
+        int usedBlocks = inlineData ? 1 : 2;  // Raíz y, sin datos en línea, users.txt
+        sb.s_free_blocks_count = blocks - usedBlocks;
         sb.s_free_inodes_count = n - 2;      // Se usan 2 inodos: raíz y users.txt
         sb.s_mtime = time(nullptr);
         sb.s_umtime = time(nullptr);
         sb.s_mnt_count = 1;
         sb.s_magic = 0xEF53;
         sb.s_inode_size = sizeof(Inode);
-        sb.s_block_size = 64;
+        sb.s_block_size = blockSize;
         sb.s_first_ino = 2;  // Primer inodo libre (0=raíz, 1=users.txt)
-        sb.s_first_blo = 2;  // Primer bloque libre (0=raíz, 1=users.txt)
-        sb.s_bm_inode_start = partition.start + sizeof(Superblock);
-        sb.s_bm_block_start = sb.s_bm_inode_start + n;
-        sb.s_inode_start = sb.s_bm_block_start + 3 * n;
-        sb.s_block_start = sb.s_inode_start + n * sizeof(Inode);
+        sb.s_first_blo = usedBlocks;  // Primer bloque libre (0=raíz, 1=users.txt si no va en línea)
+        sb.s_journal_start = ext3 ? partition.start + sbBytes : -1;
+        sb.s_journal_size = journalSize;
+        sb.s_groups_count = layout.groups;
+        sb.s_inodes_per_group = layout.inodesPerGroup;
+        sb.s_blocks_per_group = layout.blocksPerGroup;
+        sb.s_group_size = static_cast<int>(layout.groupSize);
+        sb.s_gdt_start = groups > 1 ? partition.start + sbBytes + journalSize : -1;
+        
+        // Áreas del grupo 0 (en la distribución clásica, las únicas)
+        sb.s_refcount_start = reflink ? partition.start + sbBytes + journalSize + gdtSize : -1;
+        sb.s_refcount_size = refcountSize;
+        sb.s_bm_inode_start = partition.start + sbBytes + journalSize + gdtSize + refcountSize;
+        sb.s_bm_block_start = sb.s_bm_inode_start + Bitmap::diskBytes(layout.inodesPerGroup, revLevel);
+        sb.s_inode_start = sb.s_bm_block_start + Bitmap::diskBytes(layout.blocksPerGroup, revLevel);
+        sb.s_block_start = sb.s_inode_start + layout.inodesPerGroup * sizeof(Inode);
+        sb.s_rev_level = revLevel;
+        sb.s_sb_size = sbBytes;
+        sb.s_itable_groups = classic ? 1 : ItableInit::computeGroups(n);
+        sb.s_itable_group_inodes = (n + sb.s_itable_groups - 1) / sb.s_itable_groups;
+        sb.s_itable_uninit = 0;
+        sb.s_feature_compat = (indexDirs ? FS_FEATURE_DIR_INDEX : 0) | (extents ? FS_FEATURE_EXTENTS : 0) |
+                              (inlineData ? FS_FEATURE_INLINE_DATA : 0) | (reflink ? FS_FEATURE_REFLINK : 0);
+        
+        // Con inicialización diferida, el grupo 0 (raíz y users.txt) se limpia
+        // ahora y el resto de la tabla queda en manos del hilo de fondo
+        bool deferItable = !classic && formatType == "full" && lazyItable && sb.s_itable_groups > 1;
+        if (deferItable) {
+            for (int g = 1; g < sb.s_itable_groups; g++) {
+                sb.s_itable_uninit |= (1ULL << g);
+            }
+        }
+        
+        // Formateo completo: limpiar tabla de inodos y área de bloques de cada
+        // grupo para que no queden estructuras de un formateo anterior. Se hace
+        // antes de escribir los metadatos nuevos (raíz y users.txt viven ahí).
+        // La inicialización diferida solo aplaza la tabla de inodos
+        long long zeroBytes = 0;
+        double zeroSeconds = 0;
+        DiskIO::ZeroMethod zeroMethod = DiskIO::ZeroMethod::None;
+        if (formatType == "full") {
+            auto begin = std::chrono::steady_clock::now();
+            if (deferItable) {
+                // De la tabla de inodos solo se limpia ahora el grupo 0 diferido
+                int fd = open(partition.path.c_str(), O_WRONLY);
+                if (fd >= 0) {
+                    ItableInit::zeroGroup(partition.path, fd, sb, 0);
+                    close(fd);
+                }
+                zeroBytes += static_cast<long long>(sb.s_itable_group_inodes) * sizeof(Inode);
+            }
+            long long tableBytes = static_cast<long long>(layout.inodesPerGroup) * sizeof(Inode);
+            long long areaBytes = static_cast<long long>(layout.blocksPerGroup) * blockSize;
+            for (int g = 0; g < layout.groups && zeroMethod != DiskIO::ZeroMethod::Failed; g++) {
+                if (!deferItable) {
+                    zeroMethod = DiskIO::zeroRange(partition.path, FileSystem::groupInodeTable(sb, g), tableBytes);
+                    zeroBytes += tableBytes;
+                }
+                if (zeroMethod != DiskIO::ZeroMethod::Failed) {
+                    zeroMethod = DiskIO::zeroRange(partition.path, FileSystem::groupBlockStart(sb, g), areaBytes);
+                    zeroBytes += areaBytes;
+                }
+            }
+            zeroSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            
+            if (zeroMethod == DiskIO::ZeroMethod::Failed) {
+                file.close();
+                return "Error: no se pudo limpiar el área de inodos y bloques";
+            }
+        }
+        
+        // Journal vacío: se limpia el área para que no se confundan
+        // transacciones de un formateo anterior con las nuevas
+        if (ext3) {
+            DiskIO::zeroRange(partition.path, sb.s_journal_start, journalSize);
+            if (!Journal::format(partition.path, sb.s_journal_start, journalSize)) {
+                file.close();
+                return "Error: no se pudo crear el journal";
+            }
+        }
+        
+        // Tabla de referencias en ceros: ningún bloque compartido
+        if (reflink &&
+            DiskIO::zeroRange(partition.path, sb.s_refcount_start, refcountSize) == DiskIO::ZeroMethod::Failed) {
+            file.close();
+            return "Error: no se pudo crear la tabla de referencias";
+        }
         
         // Escribir el Superbloque
         file.seekp(partition.start, std::ios::beg);
-        file.write(reinterpret_cast<const char*>(&sb), sizeof(Superblock));
+        file.write(reinterpret_cast<const char*>(&sb), FileSystem::superblockSize(sb));
         
-        // Inicializar bitmap de inodos
-        file.seekp(sb.s_bm_inode_start, std::ios::beg);
-        for (int i = 0; i < n; i++) {
-            char bit = (i == 0 || i == 1) ? '1' : '0';  // Marcar inodo 0 (raíz) y 1 (users.txt) como usados
-            file.write(&bit, 1);
+        // Inicializar bitmaps de cada grupo: inodo/bloque 0 (raíz) y 1 (users.txt)
+        // usados, ambos en el grupo 0
+        for (int g = 0; g < layout.groups; g++) {
+            Bitmap::Bits inodeBitmap(layout.inodesPerGroup);
+            Bitmap::Bits blockBitmap(layout.blocksPerGroup);
+            if (g == 0) {
+                inodeBitmap.set(0);
+                inodeBitmap.set(1);
+                for (int b = 0; b < usedBlocks; b++) {
+                    blockBitmap.set(b);
+                }
+            }
+            Bitmap::write(file, FileSystem::groupInodeBitmap(sb, g), inodeBitmap, revLevel);
+            Bitmap::write(file, FileSystem::groupBlockBitmap(sb, g), blockBitmap, revLevel);
         }
         
-        // Inicializar bitmap de bloques
-        file.seekp(sb.s_bm_block_start, std::ios::beg);
-        for (int i = 0; i < 3 * n; i++) {
-            char bit = (i == 0 || i == 1) ? '1' : '0';  // Marcar bloque 0 (raíz) y 1 (users.txt) como usados
-            file.write(&bit, 1);
+        // Tabla de descriptores de grupo
+        if (layout.groups > 1) {
+            for (int g = 0; g < layout.groups; g++) {
+                GroupDescriptor gd;
+                gd.bg_inode_bitmap = static_cast<int>(FileSystem::groupInodeBitmap(sb, g));
+                gd.bg_block_bitmap = static_cast<int>(FileSystem::groupBlockBitmap(sb, g));
+                gd.bg_inode_table = static_cast<int>(FileSystem::groupInodeTable(sb, g));
+                gd.bg_block_start = static_cast<int>(FileSystem::groupBlockStart(sb, g));
+                gd.bg_free_inodes_count = layout.inodesPerGroup - (g == 0 ? 2 : 0);
+                gd.bg_free_blocks_count = layout.blocksPerGroup - (g == 0 ? usedBlocks : 0);
+                gd.bg_used_dirs_count = (g == 0) ? 1 : 0;
+                file.seekp(FileSystem::groupDescriptorOffset(sb, g), std::ios::beg);
+                file.write(reinterpret_cast<const char*>(&gd), sizeof(GroupDescriptor));
+            }
         }
         
         // Crear inodo raíz (inodo 0 - directorio "/")
@@ -113,64 +537,112 @@ namespace CommandMkfs {
         rootInode.i_perm = 664;
         rootInode.i_block[0] = 0;  // Apunta al bloque 0
         
-        file.seekp(sb.s_inode_start, std::ios::beg);
-        file.write(reinterpret_cast<const char*>(&rootInode), sizeof(Inode));
+        FileSystem::writeInode(file, sb, 0, rootInode);
         
         // Crear inodo para users.txt (inodo 1 - archivo)
         Inode usersInode;
         usersInode.i_uid = 1;
         usersInode.i_gid = 1;
+        std::string usersContent = "1,G,root\n1,U,root,root,123\n";
         usersInode.i_size = 27;  // Tamaño del contenido inicial "1,G,root\n1,U,root,root,123\n"
         usersInode.i_atime = time(nullptr);
         usersInode.i_ctime = time(nullptr);
         usersInode.i_mtime = time(nullptr);
         usersInode.i_type = '0';  // Es archivo
         usersInode.i_perm = 664;
-        usersInode.i_block[0] = 1;  // Apunta al bloque 1
+        if (inlineData) {
+            FileSystem::writeInlineData(usersInode, usersContent);
+        } else {
+            usersInode.i_block[0] = 1;  // Apunta al bloque 1
+        }
         
-        file.seekp(sb.s_inode_start + sizeof(Inode), std::ios::beg);
-        file.write(reinterpret_cast<const char*>(&usersInode), sizeof(Inode));
+        FileSystem::writeInode(file, sb, 1, usersInode);
         
-        // Crear bloque de carpeta raíz (bloque 0)
-        FolderBlock rootBlock;
+        // Crear bloque de carpeta raíz (bloque 0); un bloque de carpeta tiene
+        // s_block_size / sizeof(Content) entradas, todas vacías al inicio
+        FileSystem::Block rootBlock(blockSize);
+        rootBlock.initFolder();
+        Content* entries = rootBlock.contents();
         
         // Entrada "." (directorio actual)
-        std::strncpy(rootBlock.b_content[0].b_name, ".", 12);
-        rootBlock.b_content[0].b_inodo = 0;  // Apunta a sí mismo
+        std::strncpy(entries[0].b_name, ".", 12);
+        entries[0].b_inodo = 0;  // Apunta a sí mismo
         
         // Entrada ".." (directorio padre)
-        std::strncpy(rootBlock.b_content[1].b_name, "..", 12);
-        rootBlock.b_content[1].b_inodo = 0;  // En raíz, padre es sí mismo
+        std::strncpy(entries[1].b_name, "..", 12);
+        entries[1].b_inodo = 0;  // En raíz, padre es sí mismo
         
         // Entrada "users.txt"
-        std::strncpy(rootBlock.b_content[2].b_name, "users.txt", 12);
-        rootBlock.b_content[2].b_inodo = 1;  // Apunta al inodo 1
-        
-        // Entrada 3 vacía
-        rootBlock.b_content[3].b_inodo = -1;
+        std::strncpy(entries[2].b_name, "users.txt", 12);
+        entries[2].b_inodo = 1;  // Apunta al inodo 1
         
-        file.seekp(sb.s_block_start, std::ios::beg);
-        file.write(reinterpret_cast<const char*>(&rootBlock), sizeof(FolderBlock));
+        FileSystem::writeBlock(file, sb, 0, rootBlock);
         
         // Crear bloque de contenido para users.txt (bloque 1)
-        FileBlock usersBlock;
-        std::string usersContent = "1,G,root\n1,U,root,root,123\n";
-        std::strncpy(usersBlock.b_content, usersContent.c_str(), 64);
-        
-        file.seekp(sb.s_block_start + 64, std::ios::beg);  // 64 bytes = sizeof(FolderBlock)
-        file.write(reinterpret_cast<const char*>(&usersBlock), sizeof(FileBlock));
+        if (!inlineData) {
+            FileSystem::Block usersBlock(blockSize);
+            std::memcpy(usersBlock.data.data(), usersContent.c_str(), usersContent.size());
+            FileSystem::writeBlock(file, sb, 1, usersBlock);
+        }
         
         file.close();
         
+        // Arrancar la limpieza en segundo plano de los grupos pendientes
+        if (deferItable) {
+            ItableInit::start(partition.path, partition.start);
+        }
+        
         std::ostringstream result;
         result << "\n=== MKFS ===\n";
-        result << "Sistema de archivos EXT2 creado exitosamente\n";
+        result << "Sistema de archivos " << (ext3 ? "EXT3" : "EXT2") << " creado exitosamente\n";
         result << "  ID: " << id << "\n";
         result << "  Disco: " << partition.path << "\n";
         result << "  Partición: " << partition.name << "\n";
         result << "  Tamaño: " << partitionSize << " bytes\n";
         result << "  Inodos: " << n << "\n";
-        result << "  Bloques: " << (3 * n) << "\n";
+        result << "  Bloques: " << blocks << " de " << blockSize << " bytes\n";
+        if (ext3) {
+            result << "  Journal: " << journalSize << " bytes (commit agrupado cada "
+                   << Journal::COMMIT_MAX_OPERATIONS << " operaciones o "
+                   << Journal::COMMIT_INTERVAL_SECONDS << " s)\n";
+        }
+        if (layout.groups > 1) {
+            result << "  Grupos: " << layout.groups << " (" << layout.inodesPerGroup << " inodos y "
+                   << layout.blocksPerGroup << " bloques por grupo)\n";
+        }
+        result << "  Bytes por inodo: " << (partitionSize / n) << "\n";
+        result << "  Metadatos: " << layout.metadataBytes << " bytes ("
+               << std::fixed << std::setprecision(2) << (layout.metadataBytes * 100.0 / partitionSize)
+               << "% de la partición)\n";
+        result << "  Carpetas: " << (indexDirs ? "indexadas por hash al crecer" : "lineales") << "\n";
+        result << "  Archivos: " << (extents ? "extents (tramos contiguos)" : "apuntadores directos e indirectos");
+        if (inlineData) {
+            result << "; hasta " << FileSystem::inlineCapacity() << " bytes dentro del inodo";
+        }
+        result << "\n";
+        if (reflink) {
+            result << "  Copias: reflink (bloques compartidos; tabla de referencias de " << refcountSize << " bytes)\n";
+        }
+        result << "  Bitmaps: " << (revLevel >= FS_REV_PACKED_BITMAPS ? "empaquetados (1 bit por objeto)" : "ASCII (1 byte por objeto)") << "\n";
+        result << "  Superbloque: " << sbBytes << " bytes"
+               << (classic ? " (formato clásico, sin extensión)" : " (con extensión)") << "\n";
+        if (formatType == "full") {
+            double megabytes = zeroBytes / (1024.0 * 1024.0);
+            result << "  Formateo: completo (" << DiskIO::methodName(zeroMethod) << ")\n";
+            result << "  Limpiado: " << std::fixed << std::setprecision(2) << megabytes << " MB en "
+                   << std::setprecision(3) << zeroSeconds << " s";
+            if (zeroSeconds > 0) {
+                result << " (" << std::setprecision(1) << (megabytes / zeroSeconds) << " MB/s)";
+            }
+            result << "\n";
+            if (deferItable) {
+                result << "  Tabla de inodos: inicialización diferida ("
+                       << (sb.s_itable_groups - 1) << " de " << sb.s_itable_groups
+                       << " grupos en segundo plano)\n";
+            }
+        } else {
+            result << "  Formateo: rápido (solo metadatos)\n";
+        }
         result << "  Archivo users.txt creado en la raíz";
         
         return result.str();
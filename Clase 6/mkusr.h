@@ -0,0 +1,54 @@
+#ifndef MKUSR_H
+#define MKUSR_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include "structures.h"
+#include "fileops.h"
+#include "users.h"
+
+namespace CommandMkusr {
+
+    // Comando mkusr: crear el usuario -user con contraseña -pass en el grupo
+    // -grp de la partición de la sesión. Solo root
+    inline std::string execute(const std::string& user, const std::string& pass, const std::string& grp) {
+        if (user.empty() || pass.empty() || grp.empty()) {
+            return "Error: mkusr requiere los parámetros -user, -pass y -grp";
+        }
+        const Users::Session& session = Users::session();
+        if (!session.active) {
+            return "Error: mkusr requiere una sesión activa";
+        }
+        if (session.uid != Users::ROOT_UID) {
+            return "Error: solo root puede crear usuarios";
+        }
+        if (user.size() > Users::MAX_NAME || pass.size() > Users::MAX_NAME || grp.size() > Users::MAX_NAME) {
+            return "Error: usuario, contraseña y grupo admiten como máximo " +
+                   std::to_string(Users::MAX_NAME) + " caracteres";
+        }
+        if (user.find(',') != std::string::npos || pass.find(',') != std::string::npos ||
+            grp.find(',') != std::string::npos) {
+            return "Error: usuario, contraseña y grupo no pueden contener ','";
+        }
+
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, session.id);
+        if (!error.empty()) {
+            return error;
+        }
+        error = Users::addUser(ctx, user, pass, grp);
+        if (!error.empty()) {
+            return error;
+        }
+
+        std::shared_ptr<const Users::Table> table = Users::table(ctx);
+        std::ostringstream result;
+        result << "\n=== MKUSR ===\n";
+        result << "Usuario '" << user << "' creado en el grupo '" << grp << "' (uid "
+               << table->users.at(user).uid << ")";
+        return result.str();
+    }
+
+} // namespace CommandMkusr
+
+#endif // MKUSR_H
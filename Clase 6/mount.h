@@ -9,10 +9,21 @@
 #include <fstream>
 #include <cstring>
 #include <algorithm>
+#include <limits>
 #include "structures.h"
+#include "itable_init.h"
+#include "journal.h"
+#include "buffer_cache.h"
 
 namespace CommandMount {
     
+    // Cuándo se guarda i_atime al leer (opción -opts de mount)
+    enum class AtimeMode {
+        NoAtime,        // Nunca
+        Relatime,       // Si es anterior a i_mtime o tiene más de un día; en lotes
+        StrictAtime     // En cada lectura
+    };
+    
     // Estructura para almacenar información de particiones montadas
     struct MountedPartition {
         std::string path;          // Ruta del disco
@@ -21,6 +32,7 @@ namespace CommandMount {
         char type;                 // Tipo de partición (P, E, L)
         int start;                 // Byte donde inicia la partición
         int size;                  // Tamaño de la partición
+        AtimeMode atime = AtimeMode::Relatime;  // Actualización de i_atime
     };
     
     // Mapa global para almacenar particiones montadas
@@ -111,6 +123,67 @@ namespace CommandMount {
         return false;
     }
     
+    // Recuperar el journal de una partición EXT3: reaplica las transacciones
+    // confirmadas que no llegaron a su checkpoint. Devuelve -1 si no es EXT3
+    inline int recoverJournal(const std::string& path, int start) {
+        int fd = open(path.c_str(), O_RDWR);
+        if (fd < 0) {
+            return -1;
+        }
+        Superblock sb;
+        int replayed = -1;
+        if (pread(fd, &sb, sizeof(Superblock), start) == sizeof(Superblock) &&
+            FileSystem::acceptSuperblock(sb, start) && sb.s_filesystem_type == 3 && sb.s_journal_start >= 0) {
+            replayed = Journal::replay(fd, sb);
+        }
+        close(fd);
+        if (replayed > 0) {
+            // La reaplicación escribe directo al disco
+            BufferCache::invalidate(path, 0, std::numeric_limits<long long>::max());
+        }
+        return replayed;
+    }
+    
+    // Interpretar -opts (opciones separadas por comas). Devuelve un mensaje
+    // de error o ""
+    inline std::string parseOptions(const std::string& opts, AtimeMode& atime) {
+        std::stringstream stream(opts);
+        std::string option;
+        while (std::getline(stream, option, ',')) {
+            std::transform(option.begin(), option.end(), option.begin(), ::tolower);
+            if (option == "noatime") {
+                atime = AtimeMode::NoAtime;
+            } else if (option == "relatime") {
+                atime = AtimeMode::Relatime;
+            } else if (option == "strictatime") {
+                atime = AtimeMode::StrictAtime;
+            } else if (!option.empty()) {
+                return "Error: opción de montaje no válida '" + option +
+                       "'. Valores permitidos: noatime, relatime, strictatime";
+            }
+        }
+        return "";
+    }
+    
+    inline std::string atimeName(AtimeMode atime) {
+        switch (atime) {
+            case AtimeMode::NoAtime: return "noatime";
+            case AtimeMode::StrictAtime: return "strictatime";
+            default: return "relatime";
+        }
+    }
+    
+    // Modo de i_atime de la partición que empieza en 'start' del disco 'path'
+    // (relatime si no está montada)
+    inline AtimeMode atimeMode(const std::string& path, int start) {
+        for (const auto& [id, partition] : mountedPartitions) {
+            if (partition.path == path && partition.start == start) {
+                return partition.atime;
+            }
+        }
+        return AtimeMode::Relatime;
+    }
+    
     // Función para generar el ID de montaje
     inline std::string generateMountID(const std::string& path) {
         char diskLetter;
@@ -166,6 +239,15 @@ namespace CommandMount {
         
         std::string path = expandPath(pathIt->second);
         std::string name = nameIt->second;
+        AtimeMode atime = AtimeMode::Relatime;
+        auto optsIt = params.find("-opts");
+        if (optsIt != params.end()) {
+            std::string error = parseOptions(optsIt->second, atime);
+            if (!error.empty()) {
+                std::cerr << error << std::endl;
+                return;
+            }
+        }
         
         // Verificar que el archivo del disco existe
         std::ifstream file(path);
@@ -202,10 +284,15 @@ namespace CommandMount {
         mounted.type = type;
         mounted.start = start;
         mounted.size = size;
+        mounted.atime = atime;
         
         // Agregar al mapa de particiones montadas
         mountedPartitions[mountID] = mounted;
         
+        // Reaplicar el journal y reanudar la inicialización diferida de la tabla de inodos
+        int replayed = recoverJournal(path, start);
+        ItableInit::start(path, start);
+        
         std::cout << "Partición montada exitosamente" << std::endl;
         std::cout << "  ID: " << mountID << std::endl;
         std::cout << "  Disco: " << path << std::endl;
@@ -213,12 +300,22 @@ namespace CommandMount {
         std::cout << "  Tipo: " << type << std::endl;
         std::cout << "  Inicio: " << start << " bytes" << std::endl;
         std::cout << "  Tamaño: " << size << " bytes" << std::endl;
+        std::cout << "  Opciones: " << atimeName(atime) << std::endl;
+        if (replayed >= 0) {
+            std::cout << "  Journal: " << replayed << " transacciones reaplicadas" << std::endl;
+        }
     }
     
     // Sobrecarga de execute() que devuelve std::string (para compatibilidad con main.cpp)
-    inline std::string execute(const std::string& pathParam, const std::string& nameParam) {
+    inline std::string execute(const std::string& pathParam, const std::string& nameParam,
+                               const std::string& opts = "") {
         std::string path = expandPath(pathParam);
         std::string name = nameParam;
+        AtimeMode atime = AtimeMode::Relatime;
+        std::string error = parseOptions(opts, atime);
+        if (!error.empty()) {
+            return error;
+        }
         
         // Verificar que el archivo del disco existe
         std::ifstream file(path);
@@ -250,10 +347,15 @@ namespace CommandMount {
         mounted.type = type;
         mounted.start = start;
         mounted.size = size;
+        mounted.atime = atime;
         
         // Agregar al mapa de particiones montadas
         mountedPartitions[mountID] = mounted;
         
+        // Reaplicar el journal y reanudar la inicialización diferida de la tabla de inodos
+        int replayed = recoverJournal(path, start);
+        ItableInit::start(path, start);
+        
         std::ostringstream result;
         result << "\n=== MOUNT ===\n";
         result << "Partición montada exitosamente\n";
@@ -262,7 +364,11 @@ namespace CommandMount {
         result << "  Partición: " << name << "\n";
         result << "  Tipo: " << type << "\n";
         result << "  Inicio: " << start << " bytes\n";
-        result << "  Tamaño: " << size << " bytes";
+        result << "  Tamaño: " << size << " bytes\n";
+        result << "  Opciones: " << atimeName(atime);
+        if (replayed >= 0) {
+            result << "\n  Journal: " << replayed << " transacciones reaplicadas";
+        }
         
         return result.str();
     }
@@ -282,6 +388,7 @@ namespace CommandMount {
             result << "  Tipo: " << partition.type << "\n";
             result << "  Inicio: " << partition.start << " bytes\n";
             result << "  Tamaño: " << partition.size << " bytes\n";
+            result << "  Opciones: " << atimeName(partition.atime) << "\n";
             result << "---\n";
         }
         return result.str();
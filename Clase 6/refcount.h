@@ -0,0 +1,85 @@
+#ifndef REFCOUNT_H
+#define REFCOUNT_H
+
+#include <string>       // Manejo de la clase std::string
+#include <vector>       // Valores de un rango de la tabla
+#include "structures.h"
+#include "filesystem.h"
+#include "journal.h"
+#include "allocator.h"
+#include "buffer_cache.h"
+
+// Tabla de referencias de los bloques de datos (FS_FEATURE_REFLINK). Es un
+// área de metadatos declarada en el Superbloque (s_refcount_start) con un byte
+// por bloque: cuántos inodos, además del primero, usan el bloque. Con 0 el
+// bloque tiene un solo dueño (o está libre) y se maneja como siempre; una
+// copia con reflink suma 1 a los bloques del archivo en vez de duplicarlos y
+// liberar un bloque compartido solo resta 1
+namespace Refcount {
+
+    const int MAX_SHARES = 255;     // Referencias extra que caben en un byte
+
+    inline bool enabled(const Superblock& sb) {
+        return (sb.s_feature_compat & FS_FEATURE_REFLINK) != 0 && sb.s_refcount_start > 0;
+    }
+
+    // Valores de la tabla para los bloques [first, first + count)
+    inline std::vector<unsigned char> read(const std::string& path, const Superblock& sb, int first, int count) {
+        std::vector<unsigned char> values(count, 0);
+        BufferCache::read(path, static_cast<long long>(sb.s_refcount_start) + first, values.data(), values.size());
+        return values;
+    }
+
+    inline bool write(const std::string& path, int partStart, const Superblock& sb,
+                      int first, const std::vector<unsigned char>& values) {
+        return Journal::writeMetadata(path, partStart, sb, static_cast<long long>(sb.s_refcount_start) + first,
+                                      values.data(), values.size());
+    }
+
+    // Referencias extra del bloque b
+    inline int extra(const std::string& path, const Superblock& sb, int b) {
+        return read(path, sb, b, 1)[0];
+    }
+
+    // Sumar una referencia a los bloques [first, first + count). Si alguno ya
+    // está en el máximo no se cambia nada y se devuelve false
+    inline bool share(const std::string& path, int partStart, const Superblock& sb, int first, int count) {
+        std::vector<unsigned char> values = read(path, sb, first, count);
+        for (unsigned char value : values) {
+            if (value >= MAX_SHARES) {
+                return false;
+            }
+        }
+        for (unsigned char& value : values) {
+            value++;
+        }
+        return write(path, partStart, sb, first, values);
+    }
+
+    // Quitar una referencia a los bloques [first, first + count): los que no
+    // estaban compartidos se liberan
+    inline void release(const std::string& path, int partStart, const Superblock& sb, int first, int count) {
+        if (!enabled(sb)) {
+            for (int b = first; b < first + count; b++) {
+                Allocator::freeBlock(path, partStart, sb, b);
+            }
+            return;
+        }
+        std::vector<unsigned char> values = read(path, sb, first, count);
+        bool shared = false;
+        for (int k = 0; k < count; k++) {
+            if (values[k] > 0) {
+                values[k]--;
+                shared = true;
+            } else {
+                Allocator::freeBlock(path, partStart, sb, first + k);
+            }
+        }
+        if (shared) {
+            write(path, partStart, sb, first, values);
+        }
+    }
+
+} // namespace Refcount
+
+#endif // REFCOUNT_H
@@ -0,0 +1,153 @@
+#ifndef REMOVE_H
+#define REMOVE_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <vector>       // Inodos a eliminar
+#include "structures.h"
+#include "fileops.h"
+#include "allocator.h"
+#include "delalloc.h"
+#include "atime.h"
+#include "dentry_cache.h"
+#include "users.h"
+
+namespace CommandRemove {
+
+    // Inodo que se elimina, con la carpeta y el nombre de su entrada
+    struct Target {
+        int index;
+        int parent;
+        std::string name;
+        char type;
+    };
+
+    // Juntar 'index' y, si es carpeta, todo su contenido (primero lo de
+    // adentro). Sin permiso de escritura sobre alguno no se elimina nada
+    inline std::string collect(FileOps::Context& ctx, int index, int parent, const std::string& name,
+                               std::vector<Target>& targets) {
+        Inode inode = FileOps::readInode(ctx, index);
+        if (!Users::allowed(ctx, inode, 2)) {
+            return "Error: sin permiso de escritura sobre '" + name + "' (no se eliminó nada)";
+        }
+        if (inode.i_type == '1') {
+            int perBlock = FileSystem::contentsPerBlock(ctx.sb);
+            for (long long logical = 0; ; logical++) {
+                int b = FileOps::blockAt(ctx, inode, logical);
+                if (b < 0) {
+                    break;
+                }
+                FileSystem::Block block = FileOps::readBlock(ctx, b);
+                for (int k = 0; k < perBlock; k++) {
+                    const Content& entry = block.contents()[k];
+                    std::string entryName = FileOps::entryName(entry);
+                    if (entry.b_inodo >= 0 && entryName != "." && entryName != "..") {
+                        std::string error = collect(ctx, entry.b_inodo, index, entryName, targets);
+                        if (!error.empty()) {
+                            return error;
+                        }
+                    }
+                }
+            }
+        }
+        targets.push_back({index, parent, name, inode.i_type});
+        return "";
+    }
+
+    // Liberar los bloques y el inodo, y olvidar lo que quede de él en memoria.
+    // Con 'entry', su entrada se invalida sola en la caché de entradas; las
+    // negativas de una carpeta borrada siguen valiendo si su inodo se reutiliza
+    // (la carpeta nueva empieza vacía)
+    inline void release(FileOps::Context& ctx, const Target& target, bool entry) {
+        DelayedAlloc::drop(ctx, target.index);
+        Atime::forget(ctx, target.index);
+        Inode inode = FileOps::readInode(ctx, target.index);
+        FileOps::releaseData(ctx, inode);
+        FileOps::writeInode(ctx, target.index, inode);
+        Allocator::freeInode(ctx.path, ctx.partStart, ctx.sb, target.index, target.type == '1');
+        if (entry) {
+            DentryCache::invalidate(ctx.path, ctx.partStart, target.parent, target.name);
+        }
+        if (target.type == '1') {
+            DentryCache::invalidate(ctx.path, ctx.partStart, target.index, ".");
+            DentryCache::invalidate(ctx.path, ctx.partStart, target.index, "..");
+        }
+    }
+
+    // Comando remove: eliminar un archivo o una carpeta con todo su contenido.
+    // La entrada se quita de la carpeta padre primero; lo de adentro ya no es
+    // alcanzable y se libera después
+    inline std::string execute(const std::string& id, const std::string& path) {
+        if (id.empty()) {
+            return "Error: remove requiere el parámetro -id";
+        }
+        if (path.empty()) {
+            return "Error: remove requiere el parámetro -path";
+        }
+
+        std::vector<std::string> parts;
+        std::string error = FileOps::splitPath(path, parts);
+        if (!error.empty()) {
+            return error;
+        }
+        if (parts.empty()) {
+            return "Error: no se puede eliminar la raíz";
+        }
+        if (parts.back() == "." || parts.back() == "..") {
+            return "Error: remove requiere la ruta de un archivo o carpeta";
+        }
+
+        FileOps::Context ctx;
+        error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        int parentIndex = FileOps::resolveParent(ctx, parts, false, error);
+        if (parentIndex == -1) {
+            return "Error: no existe '" + path + "'";
+        }
+        Inode parent = FileOps::readInode(ctx, parentIndex);
+        int index = FileOps::lookup(ctx, parentIndex, parent, parts.back());
+        if (index == -1) {
+            return "Error: no existe '" + path + "'";
+        }
+        if (index == Users::USERS_INODE) {
+            return "Error: no se puede eliminar users.txt";
+        }
+        if (!Users::allowed(ctx, parent, 2)) {
+            return "Error: sin permiso de escritura sobre la carpeta de '" + path + "'";
+        }
+
+        std::vector<Target> targets;
+        error = collect(ctx, index, parentIndex, parts.back(), targets);
+        if (!error.empty()) {
+            return error;
+        }
+
+        auto state = Allocator::getState(ctx.path, ctx.partStart, ctx.sb);
+        int freeBefore = state ? state->freeBlocks : 0;
+        // removeEntry deja la entrada de -path (la última) como negativa en la caché
+        FileOps::removeEntry(ctx, parentIndex, parent, parts.back());
+        int files = 0;
+        int folders = 0;
+        for (size_t k = 0; k < targets.size(); k++) {
+            release(ctx, targets[k], k + 1 < targets.size());
+            (targets[k].type == '1' ? folders : files)++;
+        }
+        FileOps::finish(ctx);
+        int freedBlocks = state ? state->freeBlocks - freeBefore : 0;
+
+        std::ostringstream result;
+        result << "\n=== REMOVE ===\n";
+        result << "'" << path << "' eliminado\n";
+        result << "  Archivos: " << files << "\n";
+        if (folders > 0) {
+            result << "  Carpetas: " << folders << "\n";
+        }
+        result << "  Bloques liberados: " << freedBlocks;
+        return result.str();
+    }
+
+} // namespace CommandRemove
+
+#endif // REMOVE_H
@@ -9,10 +9,20 @@
 #include <algorithm>
 #include <vector>
 #include <iomanip>
+#include <functional>
 #include <sys/stat.h>
 #include <libgen.h>
 #include "structures.h"
+#include "bitmap.h"
+#include "filesystem.h"
 #include "mount.h"
+#include "inode_cache.h"
+#include "buffer_cache.h"
+#include "extents.h"
+#include "fileops.h"
+#include "file_stream.h"
+#include "delalloc.h"
+#include "atime.h"
 
 namespace CommandRep {
     
@@ -409,19 +419,25 @@ namespace CommandRep {
         Superblock sb;
         file.seekg(partStart, std::ios::beg);
         file.read(reinterpret_cast<char*>(&sb), sizeof(Superblock));
+        if (!file.good() || !FileSystem::acceptSuperblock(sb, partStart)) {
+            file.close();
+            return "Error: la partición no tiene un sistema de archivos válido (ejecute mkfs)";
+        }
         
         // Leer bitmap de inodos para saber cuáles están en uso
-        file.seekg(sb.s_bm_inode_start, std::ios::beg);
-        std::vector<char> bitmap(sb.s_inodes_count);
-        file.read(bitmap.data(), sb.s_inodes_count);
+        Bitmap::Bits bitmap = Bitmap::readInodes(file, sb);
         
         // Leer todos los inodos en uso
         std::vector<std::pair<int, Inode>> usedInodes;
         for (int i = 0; i < sb.s_inodes_count; i++) {
-            if (bitmap[i] == '1') {
+            if (bitmap.test(i)) {
                 Inode inode;
-                file.seekg(sb.s_inode_start + (i * sizeof(Inode)), std::ios::beg);
-                file.read(reinterpret_cast<char*>(&inode), sizeof(Inode));
+                if (!InodeCache::lookup(diskPath, partStart, i, inode)) {
+                    file.seekg(FileSystem::inodeOffset(sb, i), std::ios::beg);
+                    file.read(reinterpret_cast<char*>(&inode), sizeof(Inode));
+                    FileSystem::sanitizeInode(sb, inode);
+                    InodeCache::insert(diskPath, partStart, sb, i, inode, false);
+                }
                 usedInodes.push_back({i, inode});
             }
         }
@@ -462,6 +478,18 @@ namespace CommandRep {
             dot << "        <TR><TD ALIGN=\"LEFT\"><FONT POINT-SIZE=\"10\">i_size:</FONT></TD>"
                 << "<TD ALIGN=\"RIGHT\"><FONT POINT-SIZE=\"10\" COLOR=\"#1976D2\"><B>" << inode.i_size << " bytes</B></FONT></TD></TR>\n";
             
+            // Tamaño asignado: menor que i_size en un archivo disperso
+            FileOps::Context ctx{diskPath, partStart, sb};
+            long long allocated = FileOps::allocatedBlocks(ctx, inode);
+            dot << "        <TR><TD ALIGN=\"LEFT\"><FONT POINT-SIZE=\"10\">asignado:</FONT></TD>"
+                << "<TD ALIGN=\"RIGHT\"><FONT POINT-SIZE=\"10\" COLOR=\"#1976D2\"><B>" << allocated * sb.s_block_size
+                << " bytes (" << allocated << " bloques)";
+            if (!FileSystem::hasInlineData(inode) &&
+                allocated < (static_cast<long long>(inode.i_size) + sb.s_block_size - 1) / sb.s_block_size) {
+                dot << " disperso";
+            }
+            dot << "</B></FONT></TD></TR>\n";
+            
             // Fechas
             char dateStr[100];
             struct tm* timeinfo;
@@ -498,11 +526,19 @@ namespace CommandRep {
             // Bloques asignados
             dot << "        <TR><TD COLSPAN=\"2\" ALIGN=\"LEFT\"><FONT POINT-SIZE=\"10\"><B>Bloques asignados:</B></FONT></TD></TR>\n";
             
-            // Contar bloques asignados
+            // Contar bloques asignados (con extents, el primero de cada tramo de la raíz)
             std::vector<int> assignedBlocks;
-            for (int i = 0; i < 15; i++) {
-                if (inode.i_block[i] != -1) {
-                    assignedBlocks.push_back(inode.i_block[i]);
+            if (FileSystem::hasInlineData(inode)) {
+                // Contenido dentro del inodo: sin bloques
+            } else if (Extents::usesExtents(inode)) {
+                for (const Extents::Extent& e : Extents::root(inode).entries) {
+                    assignedBlocks.push_back(e.physical);
+                }
+            } else {
+                for (int i = 0; i < 15; i++) {
+                    if (inode.i_block[i] != -1) {
+                        assignedBlocks.push_back(inode.i_block[i]);
+                    }
                 }
             }
             
@@ -522,6 +558,10 @@ namespace CommandRep {
                 dot << "        <TR><TD COLSPAN=\"2\" ALIGN=\"CENTER\">"
                     << "<FONT POINT-SIZE=\"9\" COLOR=\"#9E9E9E\">Total: " << assignedBlocks.size() 
                     << " bloques asignados</FONT></TD></TR>\n";
+            } else if (FileSystem::hasInlineData(inode)) {
+                dot << "        <TR><TD COLSPAN=\"2\" ALIGN=\"CENTER\">"
+                    << "<FONT POINT-SIZE=\"10\" COLOR=\"#9E9E9E\"><I>Datos en línea (" << inode.i_size
+                    << " bytes en el inodo)</I></FONT></TD></TR>\n";
             } else {
                 dot << "        <TR><TD COLSPAN=\"2\" ALIGN=\"CENTER\">"
                     << "<FONT POINT-SIZE=\"10\" COLOR=\"#9E9E9E\"><I>Sin bloques asignados</I></FONT></TD></TR>\n";
@@ -575,7 +615,297 @@ namespace CommandRep {
                + std::to_string(usedInodes.size()) + " inodos utilizados)";
     }
     
+    // Reporte BM_INODE / BM_BLOCK - Vista textual 0/1 del bitmap (20 objetos por línea)
+    inline std::string reportBitmap(const std::string& path, const std::string& diskPath,
+                                    int partStart, bool inodes) {
+        std::ifstream file(diskPath, std::ios::binary);
+        if (!file.is_open()) {
+            return "Error: no se pudo abrir el disco '" + diskPath + "'";
+        }
+        
+        // Leer Superblock
+        Superblock sb;
+        file.seekg(partStart, std::ios::beg);
+        file.read(reinterpret_cast<char*>(&sb), sizeof(Superblock));
+        
+        if (!file.good() || !FileSystem::acceptSuperblock(sb, partStart)) {
+            file.close();
+            return "Error: la partición no tiene un sistema de archivos válido (ejecute mkfs)";
+        }
+        
+        // El bitmap se lee en su formato de disco y se muestra siempre como 0/1
+        Bitmap::Bits bitmap = inodes ? Bitmap::readInodes(file, sb) : Bitmap::readBlocks(file, sb);
+        file.close();
+        
+        // Crear directorio si no existe
+        std::string parentPath = getParentPath(path);
+        createDirectories(parentPath);
+        
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            return "Error: no se pudo crear el archivo '" + path + "'";
+        }
+        out << Bitmap::render(bitmap, 20);
+        out.close();
+        
+        return std::string("Reporte ") + (inodes ? "BM_INODE" : "BM_BLOCK") +
+               " generado exitosamente en: " + path + " (" + std::to_string(bitmap.countUsed()) +
+               " de " + std::to_string(bitmap.count) + " en uso)";
+    }
+    
+    // Texto seguro dentro de una etiqueta HTML de Graphviz
+    inline std::string escapeHtml(const std::string& text) {
+        std::string out;
+        for (unsigned char c : text) {
+            if (c == '&') out += "&amp;";
+            else if (c == '<') out += "&lt;";
+            else if (c == '>') out += "&gt;";
+            else if (c == '"') out += "&quot;";
+            else if (c < 32 || c > 126) out += '.';
+            else out += static_cast<char>(c);
+        }
+        return out;
+    }
+    
+    // Reporte TREE - Inodos y bloques alcanzables desde la raíz. Lee las
+    // carpetas de forma lineal, bloque por bloque: en una carpeta indexada los
+    // nodos del índice aparecen como bloques de carpeta vacíos
+    inline std::string reportTREE(const std::string& path, const std::string& diskPath, int partStart) {
+        std::ifstream file(diskPath, std::ios::binary);
+        if (!file.is_open()) {
+            return "Error: no se pudo abrir el disco '" + diskPath + "'";
+        }
+        
+        // Leer Superblock
+        Superblock sb;
+        file.seekg(partStart, std::ios::beg);
+        file.read(reinterpret_cast<char*>(&sb), sizeof(Superblock));
+        if (!file.good() || !FileSystem::acceptSuperblock(sb, partStart)) {
+            file.close();
+            return "Error: la partición no tiene un sistema de archivos válido (ejecute mkfs)";
+        }
+        
+        int perBlock = FileSystem::contentsPerBlock(sb);
+        int perPointers = FileSystem::pointersPerBlock(sb);
+        std::ostringstream dot;
+        std::vector<bool> seenInodes(sb.s_inodes_count, false);
+        std::vector<bool> seenBlocks(sb.s_blocks_count, false);
+        std::vector<int> pending = {0};
+        std::vector<std::pair<int, Inode>> folders;    // Carpetas cuyas entradas se leyeron
+        int inodeCount = 0;
+        int blockCount = 0;
+        
+        auto readInode = [&](int i) {
+            Inode inode;
+            if (!InodeCache::lookup(diskPath, partStart, i, inode)) {
+                file.seekg(FileSystem::inodeOffset(sb, i), std::ios::beg);
+                file.read(reinterpret_cast<char*>(&inode), sizeof(Inode));
+                FileSystem::sanitizeInode(sb, inode);
+            }
+            return inode;
+        };
+        
+        // Bloque de datos (carpeta o archivo) o de apuntadores de nivel 'level'
+        std::function<void(const std::string&, int, int, bool)> visitBlock =
+            [&](const std::string& from, int b, int level, bool folder) {
+            if (b < 0 || b >= sb.s_blocks_count) {
+                return;
+            }
+            dot << "    " << from << " -> block" << b << ";\n";
+            if (seenBlocks[b]) {
+                return;
+            }
+            seenBlocks[b] = true;
+            blockCount++;
+            FileSystem::Block block = FileSystem::readBlock(file, sb, b);
+            std::string name = "block" + std::to_string(b);
+            
+            if (level > 0) {
+                dot << "    " << name << " [label=<<TABLE BORDER=\"1\" CELLBORDER=\"0\" BGCOLOR=\"#FFF59D\">"
+                    << "<TR><TD><B>Apuntadores " << b << "</B></TD></TR><TR><TD>";
+                for (int k = 0; k < perPointers; k++) {
+                    if (block.pointers()[k] != -1) {
+                        dot << block.pointers()[k] << " ";
+                    }
+                }
+                dot << "</TD></TR></TABLE>>];\n";
+                for (int k = 0; k < perPointers; k++) {
+                    visitBlock(name, block.pointers()[k], level - 1, folder);
+                }
+            } else if (folder) {
+                dot << "    " << name << " [label=<<TABLE BORDER=\"1\" CELLBORDER=\"1\" BGCOLOR=\"#C8E6C9\">"
+                    << "<TR><TD COLSPAN=\"2\"><B>Carpeta " << b << "</B></TD></TR>";
+                std::vector<int> children;
+                for (int k = 0; k < perBlock; k++) {
+                    Content& entry = block.contents()[k];
+                    if (entry.b_inodo == -1) {
+                        continue;
+                    }
+                    std::string entryName(entry.b_name, strnlen(entry.b_name, sizeof(entry.b_name)));
+                    dot << "<TR><TD>" << escapeHtml(entryName) << "</TD><TD>" << entry.b_inodo << "</TD></TR>";
+                    if (entryName != "." && entryName != ".." &&
+                        entry.b_inodo >= 0 && entry.b_inodo < sb.s_inodes_count) {
+                        children.push_back(entry.b_inodo);
+                    }
+                }
+                dot << "</TABLE>>];\n";
+                for (int child : children) {
+                    dot << "    " << name << " -> inode" << child << ";\n";
+                    pending.push_back(child);
+                }
+            } else {
+                std::string text(block.data.data(), strnlen(block.data.data(), block.size()));
+                if (text.size() > 64) {
+                    text = text.substr(0, 64) + "...";
+                }
+                dot << "    " << name << " [label=<<TABLE BORDER=\"1\" CELLBORDER=\"0\" BGCOLOR=\"#BBDEFB\">"
+                    << "<TR><TD><B>Archivo " << b << "</B></TD></TR>"
+                    << "<TR><TD>" << escapeHtml(text) << "</TD></TR></TABLE>>];\n";
+            }
+        };
+        
+        dot << "digraph TREE_Report {\n";
+        dot << "    node [shape=plaintext]\n";
+        dot << "    rankdir=LR;\n\n";
+        while (!pending.empty()) {
+            int i = pending.back();
+            pending.pop_back();
+            if (seenInodes[i]) {
+                continue;
+            }
+            seenInodes[i] = true;
+            inodeCount++;
+            Inode inode = readInode(i);
+            bool folder = inode.i_type == '1';
+            if (folder) {
+                folders.push_back({i, inode});
+            }
+            std::string name = "inode" + std::to_string(i);
+            dot << "    " << name << " [label=<<TABLE BORDER=\"2\" CELLBORDER=\"0\" BGCOLOR=\""
+                << (folder ? "#FFE0B2" : "#FFCDD2") << "\">"
+                << "<TR><TD COLSPAN=\"2\"><B>" << (folder ? "[DIR]" : "[FILE]") << " Inodo " << i << "</B></TD></TR>"
+                << "<TR><TD>i_size</TD><TD>" << inode.i_size << "</TD></TR>"
+                << "<TR><TD>i_perm</TD><TD>" << inode.i_perm << "</TD></TR>";
+            
+            // Archivo con datos en línea: el contenido está en el inodo
+            if (FileSystem::hasInlineData(inode)) {
+                dot << "<TR><TD>en línea</TD><TD>" << escapeHtml(FileSystem::readInlineData(inode))
+                    << "</TD></TR></TABLE>>];\n";
+                continue;
+            }
+            
+            // Archivo con extents: un tramo por fila y los nodos del árbol
+            if (Extents::usesExtents(inode)) {
+                std::vector<Extents::Extent> extents;
+                std::vector<int> treeBlocks;
+                Extents::collect(sb, inode, [&](int b) { return FileSystem::readBlock(file, sb, b); },
+                                 extents, treeBlocks);
+                for (const Extents::Extent& e : extents) {
+                    dot << "<TR><TD>extent " << e.logical << "</TD><TD>" << e.physical
+                        << " (" << e.length << " bloques)</TD></TR>";
+                }
+                for (int b : treeBlocks) {
+                    dot << "<TR><TD>nodo</TD><TD>" << b << "</TD></TR>";
+                }
+                dot << "</TABLE>>];\n";
+                blockCount += static_cast<int>(treeBlocks.size());
+                for (const Extents::Extent& e : extents) {
+                    blockCount += e.length;
+                }
+                continue;
+            }
+            
+            for (int k = 0; k < 15; k++) {
+                if (inode.i_block[k] != -1) {
+                    dot << "<TR><TD>i_block[" << k << "]</TD><TD>" << inode.i_block[k] << "</TD></TR>";
+                }
+            }
+            dot << "</TABLE>>];\n";
+            for (int k = 0; k < 15; k++) {
+                visitBlock(name, inode.i_block[k], k < 12 ? 0 : k - 11, folder);
+            }
+        }
+        dot << "}\n";
+        file.close();
+        
+        // Leer una carpeta es acceder a ella; los archivos solo se listan
+        FileOps::Context ctx{diskPath, partStart, sb};
+        for (const auto& [index, folder] : folders) {
+            Atime::touch(ctx, index, folder);
+        }
+        
+        // Crear directorios si no existen
+        std::string parentPath = getParentPath(path);
+        createDirectories(parentPath);
+        
+        // Guardar archivo .dot
+        std::string dotPath = path + ".dot";
+        std::ofstream dotFile(dotPath);
+        if (!dotFile.is_open()) {
+            return "Error: no se pudo crear el archivo .dot";
+        }
+        dotFile << dot.str();
+        dotFile.close();
+        
+        // Ejecutar Graphviz para generar la imagen
+        std::string ext = getExtension(path);
+        std::string cmd = "dot -T" + ext + " \"" + dotPath + "\" -o \"" + path + "\" 2>&1";
+        int result = system(cmd.c_str());
+        
+        if (result != 0) {
+            return "Error: no se pudo generar el reporte con Graphviz.\n"
+                   "Archivo DOT guardado en: " + dotPath;
+        }
+        remove(dotPath.c_str());
+        
+        return "Reporte TREE generado exitosamente en: " + path + " (" + std::to_string(inodeCount) +
+               " inodos y " + std::to_string(blockCount) + " bloques)";
+    }
+    
     // Función principal del comando REP
+    // Reporte FILE: copiar el contenido del archivo -path_file_ls al archivo
+    // de salida. Se lee en secuencia por tramos, sin cargarlo completo
+    inline std::string reportFILE(const std::string& path, const std::string& id, const std::string& pathFileLs) {
+        if (pathFileLs.empty()) {
+            return "Error: el reporte file requiere el parámetro -path_file_ls";
+        }
+        
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, id);
+        if (!error.empty()) {
+            return error;
+        }
+        int index = FileOps::resolvePath(ctx, pathFileLs, error);
+        if (index == -1) {
+            return error;
+        }
+        Inode inode = FileOps::readInode(ctx, index);
+        if (inode.i_type != '0') {
+            return "Error: '" + pathFileLs + "' no es un archivo";
+        }
+        
+        // Crear directorios si no existen
+        std::string parentPath = getParentPath(path);
+        createDirectories(parentPath);
+        
+        std::ofstream output(path, std::ios::binary);
+        if (!output.is_open()) {
+            return "Error: no se pudo crear el archivo '" + path + "'";
+        }
+        FileStream::Result read = FileStream::read(ctx, inode, [&](const char* data, size_t size) {
+            output.write(data, static_cast<std::streamsize>(size));
+            return static_cast<bool>(output);
+        });
+        output.close();
+        if (!read.error.empty()) {
+            return read.error;
+        }
+        Atime::touch(ctx, index, inode);
+        
+        return "Reporte FILE generado exitosamente en: " + path + " (" + std::to_string(read.bytes) +
+               " bytes de '" + pathFileLs + "')";
+    }
+    
     inline std::string execute(const std::string& name, const std::string& path, 
                                const std::string& id, const std::string& pathFileLs) {
         // Validar parámetros obligatorios
@@ -593,9 +923,9 @@ namespace CommandRep {
         
         // Validar tipo de reporte
         if (reportType != "mbr" && reportType != "disk" && reportType != "inode" && 
-            reportType != "block" && reportType != "bm_block" && 
+            reportType != "block" && reportType != "bm_inode" && reportType != "bm_block" && 
             reportType != "tree" && reportType != "sb" && reportType != "file" && reportType != "ls") {
-            return "Error: tipo de reporte no válido. Valores permitidos: mbr, disk, inode, block, bm_block, tree, sb, file, ls";
+            return "Error: tipo de reporte no válido. Valores permitidos: mbr, disk, inode, block, bm_inode, bm_block, tree, sb, file, ls";
         }
         
         // Buscar la partición montada
@@ -604,6 +934,11 @@ namespace CommandRep {
             return "Error: la partición con ID '" + id + "' no está montada";
         }
         
+        // Los reportes leen el disco directamente
+        DelayedAlloc::flush(partition.path, partition.start);
+        Atime::flush(partition.path, partition.start);
+        BufferCache::flush(partition.path);
+        
         std::ostringstream result;
         result << "\n=== REP ===\n";
         result << "Generando reporte '" << reportType << "'...\n";
@@ -618,6 +953,15 @@ namespace CommandRep {
         } else if (reportType == "inode") {
             std::string res = reportINODE(path, partition.path, partition.start, pathFileLs);
             result << res << "\n";
+        } else if (reportType == "bm_inode" || reportType == "bm_block") {
+            std::string res = reportBitmap(path, partition.path, partition.start, reportType == "bm_inode");
+            result << res << "\n";
+        } else if (reportType == "tree") {
+            std::string res = reportTREE(path, partition.path, partition.start);
+            result << res << "\n";
+        } else if (reportType == "file") {
+            std::string res = reportFILE(path, id, pathFileLs);
+            result << res << "\n";
         } else {
             result << "Reporte '" << reportType << "' aún no implementado\n";
         }
@@ -10,6 +10,8 @@
 #include <cstdio>        // funciones para trabajar con archivos en estilo C
 #include <filesystem>    // Proporciona funciones para trabajar con el sistema de archivos (archivos, directorios).
 #include "structures.h"  // Define estructuras de datos personalizadas.
+#include "buffer_cache.h" // Marcos en memoria del disco
+#include "itable_init.h"  // Hilos de fondo que escriben en el disco
 
 namespace CommandRmdisk {
     
@@ -59,7 +61,10 @@ namespace CommandRmdisk {
                               std::string("  Fecha creación: ") + timeStr + "\n" +
                               std::string("  Firma: ") + std::to_string(mbr.mbr_disk_signature);
 
-            // Eliminar el archivo
+            // Eliminar el archivo (sin hilos de fondo escribiéndolo y
+            // olvidando sus marcos en memoria)
+            ItableInit::stopDisk(expandedPath);
+            BufferCache::forget(expandedPath);
             if (remove(expandedPath.c_str()) != 0) {
                 return "Error: No se pudo eliminar el archivo del disco";
             }
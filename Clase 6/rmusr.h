@@ -0,0 +1,42 @@
+#ifndef RMUSR_H
+#define RMUSR_H
+
+#include <string>       // Manejo de la clase std::string
+#include "structures.h"
+#include "fileops.h"
+#include "users.h"
+
+namespace CommandRmusr {
+
+    // Comando rmusr: borrar el usuario -user de la partición de la sesión
+    // (su línea de users.txt queda con id 0). Solo root
+    inline std::string execute(const std::string& user) {
+        if (user.empty()) {
+            return "Error: rmusr requiere el parámetro -user";
+        }
+        const Users::Session& session = Users::session();
+        if (!session.active) {
+            return "Error: rmusr requiere una sesión activa";
+        }
+        if (session.uid != Users::ROOT_UID) {
+            return "Error: solo root puede borrar usuarios";
+        }
+        if (user == "root") {
+            return "Error: no se puede borrar el usuario root";
+        }
+
+        FileOps::Context ctx;
+        std::string error = FileOps::open(ctx, session.id);
+        if (!error.empty()) {
+            return error;
+        }
+        error = Users::removeUser(ctx, user);
+        if (!error.empty()) {
+            return error;
+        }
+        return "\n=== RMUSR ===\nUsuario '" + user + "' borrado";
+    }
+
+} // namespace CommandRmusr
+
+#endif // RMUSR_H
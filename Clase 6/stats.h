@@ -0,0 +1,86 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del reporte
+#include <iomanip>      // Formato de porcentajes
+#include <mutex>        // Lectura de los contadores de la caché de bloques
+#include "inode_cache.h"
+#include "buffer_cache.h"
+#include "dentry_cache.h"
+#include "users.h"
+#include "atime.h"
+
+namespace CommandStats {
+
+    // Porcentaje de aciertos de una caché
+    inline std::string hitRate(long long hits, long long misses) {
+        std::ostringstream out;
+        long long total = hits + misses;
+        out << std::fixed << std::setprecision(1) << (total > 0 ? hits * 100.0 / total : 0.0) << "%";
+        return out.str();
+    }
+
+    // Comando stats: contadores de las cachés del sistema de archivos
+    inline std::string execute() {
+        std::ostringstream result;
+        result << "\n=== STATS ===\n";
+
+        InodeCache::Stats& inodes = InodeCache::stats();
+        size_t entries, dirty;
+        InodeCache::usage(entries, dirty);
+        result << "Caché de inodos (" << InodeCache::SHARDS << " fragmentos, "
+               << InodeCache::CAPACITY << " entradas máx.)\n";
+        result << "  Aciertos: " << inodes.hits << "\n";
+        result << "  Fallos: " << inodes.misses << "\n";
+        result << "  Tasa de aciertos: " << hitRate(inodes.hits, inodes.misses) << "\n";
+        result << "  En memoria: " << entries << " (" << dirty << " sucios)\n";
+        result << "  Escrituras diferidas: " << inodes.writebacks << "\n";
+        result << "  Desalojos: " << inodes.evictions << "\n";
+
+        DentryCache::Stats& dentries = DentryCache::stats();
+        size_t positive, negative;
+        DentryCache::usage(positive, negative);
+        result << "Caché de entradas de carpeta (" << DentryCache::CAPACITY << " entradas máx.)\n";
+        result << "  Aciertos: " << dentries.hits << " (+" << dentries.negativeHits << " negativos)\n";
+        result << "  Fallos: " << dentries.misses << "\n";
+        result << "  Tasa de aciertos: " << hitRate(dentries.hits + dentries.negativeHits, dentries.misses) << "\n";
+        result << "  En memoria: " << positive << " positivas, " << negative << " negativas\n";
+        result << "  Invalidaciones: " << dentries.invalidations << "\n";
+
+        Users::Stats& users = Users::stats();
+        result << "Tabla de usuarios y grupos (users.txt)\n";
+        result << "  Consultas en memoria: " << users.hits << "\n";
+        result << "  Lecturas de users.txt: " << users.loads << "\n";
+        result << "  Cambios sin releer: " << users.updates << "\n";
+
+        Atime::Stats& atimes = Atime::stats();
+        result << "Fechas de acceso (i_atime)\n";
+        result << "  Lecturas: " << atimes.reads << " (" << atimes.skipped << " sin cambio, "
+               << atimes.coalesced << " agrupadas en memoria)\n";
+        result << "  Inodos escritos: " << atimes.written << " en " << atimes.batches << " lote(s)\n";
+
+        BufferCache::Cache& blocks = BufferCache::cache();
+        std::lock_guard<std::mutex> lock(blocks.mutex);
+        size_t used = 0, dirtyFrames = 0;
+        for (const BufferCache::Frame& frame : blocks.frames) {
+            if (frame.device != -1) used++;
+            if (frame.device != -1 && frame.dirty) dirtyFrames++;
+        }
+        result << "Caché de bloques (" << BufferCache::FRAMES << " marcos de "
+               << BufferCache::FRAME_SIZE << " bytes, reloj)\n";
+        result << "  Aciertos: " << blocks.hits << "\n";
+        result << "  Fallos: " << blocks.misses << "\n";
+        result << "  Tasa de aciertos: " << hitRate(blocks.hits, blocks.misses) << "\n";
+        result << "  En memoria: " << used << " (" << dirtyFrames << " sucios, "
+               << blocks.pinned << " fijados por el journal)\n";
+        result << "  Desalojos: " << blocks.evictions << " (" << blocks.overflows
+               << " marcos extra con todo fijado)\n";
+        result << "  Volcados: " << blocks.flushes << " (" << blocks.framesWritten << " marcos en "
+               << blocks.writes << " escrituras)";
+        return result.str();
+    }
+
+} // namespace CommandStats
+
+#endif // STATS_H
@@ -59,6 +59,16 @@ struct EBR {
 
 //estructuras para mkfs
 
+// Revisiones del sistema de archivos (Superblock::s_rev_level)
+const int FS_REV_ASCII_BITMAPS = 0;    // Bitmaps con un byte '0'/'1' por objeto
+const int FS_REV_PACKED_BITMAPS = 1;   // Bitmaps empaquetados: un bit por objeto
+
+// Características opcionales del sistema de archivos (Superblock::s_feature_compat)
+const int FS_FEATURE_DIR_INDEX = 0x1;  // Carpetas grandes indexadas por hash del nombre
+const int FS_FEATURE_EXTENTS = 0x2;    // Archivos nuevos mapeados con extents
+const int FS_FEATURE_INLINE_DATA = 0x4; // Archivos pequeños guardados dentro del inodo
+const int FS_FEATURE_REFLINK = 0x8;    // Bloques compartidos entre copias (tabla de referencias)
+
 struct Superblock {
     int s_filesystem_type;         // Tipo de sistema de archivos: 2 = EXT2, 3 = EXT3
     int s_inodes_count;            // Número total de inodos
@@ -77,6 +87,21 @@ struct Superblock {
     int s_bm_block_start;          // Inicio del bitmap de bloques
     int s_inode_start;             // Inicio de la tabla de inodos
     int s_block_start;             // Inicio de los bloques
+    int s_rev_level;               // Revisión del formato (ver FS_REV_*)
+    int s_itable_groups;           // Grupos en que se divide la tabla de inodos
+    int s_itable_group_inodes;     // Inodos por grupo de la tabla
+    int s_sb_size;                 // Bytes del Superbloque en disco (marca de los campos desde s_rev_level)
+    unsigned long long s_itable_uninit;  // Bit g = 1: grupo g aún no se ha puesto a cero
+    int s_journal_start;           // Inicio del journal (solo EXT3, -1 si no hay)
+    int s_journal_size;            // Tamaño del journal en bytes
+    int s_groups_count;            // Grupos de bloques (1 = distribución clásica)
+    int s_inodes_per_group;        // Inodos por grupo
+    int s_blocks_per_group;        // Bloques por grupo
+    int s_group_size;              // Bytes que ocupa cada grupo
+    int s_gdt_start;               // Inicio de la tabla de descriptores (-1 si no hay)
+    int s_feature_compat;          // Características opcionales (ver FS_FEATURE_*)
+    int s_refcount_start;          // Inicio de la tabla de referencias (solo FS_FEATURE_REFLINK)
+    int s_refcount_size;           // Bytes de la tabla (uno por bloque)
 
     Superblock() {
         s_filesystem_type = 0;
@@ -96,9 +121,98 @@ struct Superblock {
         s_bm_block_start = 0;
         s_inode_start = 0;
         s_block_start = 0;
+        s_rev_level = FS_REV_ASCII_BITMAPS;
+        s_itable_groups = 1;
+        s_itable_group_inodes = 0;
+        s_sb_size = sizeof(Superblock);
+        s_itable_uninit = 0;
+        s_journal_start = -1;
+        s_journal_size = 0;
+        s_groups_count = 1;
+        s_inodes_per_group = 0;
+        s_blocks_per_group = 0;
+        s_group_size = 0;
+        s_gdt_start = -1;
+        s_feature_compat = 0;
+        s_refcount_start = -1;
+        s_refcount_size = 0;
+    }
+};
+
+// Descriptor de un grupo de bloques. Cada grupo tiene, en este orden, su
+// bitmap de inodos, su bitmap de bloques, su porción de la tabla de inodos
+// y sus bloques; la tabla de descriptores va antes del primer grupo
+struct GroupDescriptor {
+    int bg_inode_bitmap;           // Inicio del bitmap de inodos del grupo
+    int bg_block_bitmap;           // Inicio del bitmap de bloques del grupo
+    int bg_inode_table;            // Inicio de la porción de la tabla de inodos
+    int bg_block_start;            // Inicio de los bloques del grupo
+    int bg_free_inodes_count;      // Inodos libres en el grupo
+    int bg_free_blocks_count;      // Bloques libres en el grupo
+    int bg_used_dirs_count;        // Carpetas creadas en el grupo
+    int bg_flags;                  // Reservado
+
+    GroupDescriptor() {
+        bg_inode_bitmap = 0;
+        bg_block_bitmap = 0;
+        bg_inode_table = 0;
+        bg_block_start = 0;
+        bg_free_inodes_count = 0;
+        bg_free_blocks_count = 0;
+        bg_used_dirs_count = 0;
+        bg_flags = 0;
+    }
+};
+
+// Estructuras del journal (EXT3). El área del journal empieza con un
+// JournalHeader y le siguen transacciones: un JournalTransaction y sus
+// registros (JournalRecord + datos) escritos de forma secuencial
+const int JOURNAL_MAGIC = 0x4A524E4C;      // "JRNL"
+const int JOURNAL_TX_MAGIC = 0x54584E31;   // "TXN1"
+
+struct JournalHeader {
+    int j_magic;                   // JOURNAL_MAGIC
+    int j_first_seq;               // Secuencia de la primera transacción válida
+    int j_size;                    // Tamaño del área del journal en bytes
+
+    JournalHeader() {
+        j_magic = JOURNAL_MAGIC;
+        j_first_seq = 1;
+        j_size = 0;
+    }
+};
+
+struct JournalTransaction {
+    int t_magic;                   // JOURNAL_TX_MAGIC
+    int t_seq;                     // Número de secuencia de la transacción
+    int t_records;                 // Registros en la transacción
+    int t_bytes;                   // Bytes de registros que siguen a este encabezado
+    unsigned int t_checksum;       // Suma de verificación de los registros
+
+    JournalTransaction() {
+        t_magic = JOURNAL_TX_MAGIC;
+        t_seq = 0;
+        t_records = 0;
+        t_bytes = 0;
+        t_checksum = 0;
     }
 };
 
+struct JournalRecord {
+    long long r_offset;            // Posición en disco de la estructura
+    int r_length;                  // Bytes de la estructura que siguen al registro
+
+    JournalRecord() {
+        r_offset = 0;
+        r_length = 0;
+    }
+};
+
+// Indicadores de un inodo (Inode::i_flags)
+const int INODE_FLAG_INDEX = 0x1;      // Carpeta indexada (ver FileOps, directorios indexados)
+const int INODE_FLAG_EXTENTS = 0x2;    // i_block guarda un árbol de extents (ver extents.h)
+const int INODE_FLAG_INLINE_DATA = 0x4; // i_block guarda el contenido del archivo (i_size bytes)
+
 struct Inode {
     int i_uid;                     // UID del usuario propietario
     int i_gid;                     // GID del grupo propietario
@@ -109,6 +223,7 @@ struct Inode {
     int i_block[15];
     char i_type;                   // Tipo: '0' = archivo, '1' = carpeta
     int i_perm;                    // Permisos del archivo/carpeta
+    int i_flags;                   // Indicadores (ver INODE_FLAG_*)
 
     Inode() {
         i_uid = 0;
@@ -122,6 +237,7 @@ struct Inode {
         }
         i_type = '0';
         i_perm = 664;
+        i_flags = 0;
     }
 };
 
@@ -142,6 +258,10 @@ struct FolderBlock {
     }
 };
 
+// FolderBlock, FileBlock y PointerBlock son las estructuras originales del
+// curso. En disco un bloque mide s_block_size bytes (64 en el formato
+// clásico) y contiene s_block_size / sizeof(Content) entradas o
+// s_block_size / 4 apuntadores (ver FileSystem::Block)
 struct FileBlock {
     char b_content[256];            // Contenido del archivo
 
@@ -0,0 +1,64 @@
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <string>       // Manejo de la clase std::string
+#include <sstream>      // Construcción del mensaje de resultado
+#include <mutex>        // Lectura de los contadores de la caché
+#include "inode_cache.h"
+#include "journal.h"
+#include "buffer_cache.h"
+#include "delalloc.h"
+#include "atime.h"
+
+namespace CommandSync {
+
+    // Escribir todo lo que sigue en memoria, en orden: datos con asignación
+    // diferida a sus bloques, fechas de acceso pendientes (relatime), inodos sucios a la caché de bloques, commit y checkpoint de los journals y, por último,
+    // los marcos sucios restantes (EXT2 y contenido de archivos). Devuelve un
+    // error si algo no llegó al disco
+    inline std::string syncAll() {
+        std::string error = DelayedAlloc::flushAll();
+        Atime::flushAll();
+        InodeCache::flushAll();
+        if (!Journal::flushAll() && error.empty()) {
+            error = "Error: no se pudo escribir el journal al disco";
+        }
+        if (!BufferCache::flushAll() && error.empty()) {
+            error = "Error: no se pudieron escribir los bloques en memoria al disco";
+        }
+        return error;
+    }
+
+    // Comando sync
+    inline std::string execute() {
+        BufferCache::Cache& cache = BufferCache::cache();
+        long long framesBefore, writesBefore;
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            framesBefore = cache.framesWritten;
+            writesBefore = cache.writes;
+        }
+
+        std::string error = syncAll();
+
+        long long frames, writes;
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            frames = cache.framesWritten - framesBefore;
+            writes = cache.writes - writesBefore;
+        }
+
+        std::ostringstream result;
+        result << "\n=== SYNC ===\n";
+        result << "Datos en memoria escritos al disco\n";
+        result << "  Marcos escritos: " << frames << " (" << frames * BufferCache::FRAME_SIZE / 1024 << " KB)\n";
+        result << "  Escrituras: " << writes;
+        if (!error.empty()) {
+            result << "\n" << error;
+        }
+        return result.str();
+    }
+
+} // namespace CommandSync
+
+#endif // SYNC_H
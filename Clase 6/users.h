@@ -0,0 +1,286 @@
+#ifndef USERS_H
+#define USERS_H
+
+#include <string>         // Manejo de la clase std::string
+#include <sstream>        // Lectura de las líneas de users.txt
+#include <vector>         // Campos de una línea
+#include <unordered_map>  // Usuarios y grupos por nombre y por id
+#include <map>            // Tablas por partición
+#include <memory>         // Tablas compartidas con los lectores
+#include <mutex>          // Acceso concurrente al registro
+#include <atomic>         // Contadores
+#include "structures.h"
+#include "fileops.h"
+#include "allocator.h"
+#include "delalloc.h"
+
+// Usuarios y grupos de una partición (users.txt, inodo 1) ya interpretados.
+// La tabla se arma una vez y se guarda junto con la generación del inodo de
+// users.txt: mientras el inodo no se escriba, login y los permisos la usan
+// sin leer el archivo. mkusr y rmusr escriben el archivo y actualizan la
+// tabla en memoria con la generación nueva en vez de volver a leerla
+namespace Users {
+
+    const int USERS_INODE = 1;      // users.txt (lo crea mkfs)
+    const int ROOT_UID = 1;
+    const size_t MAX_NAME = 10;     // Largo máximo de usuario, grupo y contraseña
+
+    struct Group {
+        int gid;
+        std::string name;
+    };
+
+    struct User {
+        int uid;
+        std::string name;
+        std::string group;
+        std::string password;
+    };
+
+    struct Table {
+        long long generation = -1;
+        std::unordered_map<std::string, Group> groups;     // Activos, por nombre
+        std::unordered_map<std::string, User> users;
+        std::unordered_map<int, std::string> groupById;
+        std::unordered_map<int, std::string> userById;
+        int groupLines = 0;         // Líneas de cada tipo (también las borradas):
+        int userLines = 0;          // el id nuevo es la cantidad + 1
+    };
+
+    // Sesión activa (una a la vez, como la consola)
+    struct Session {
+        bool active = false;
+        std::string id;             // Partición montada
+        std::string path;
+        int partStart = 0;
+        std::string user;
+        std::string group;
+        int uid = -1;
+        int gid = -1;
+    };
+
+    struct Stats {
+        std::atomic<long long> hits{0};         // Tabla vigente
+        std::atomic<long long> loads{0};        // users.txt leído e interpretado
+        std::atomic<long long> updates{0};      // Cambios aplicados sin releer
+    };
+
+    inline std::map<std::string, std::shared_ptr<const Table>>& registry() {
+        static auto* tables = new std::map<std::string, std::shared_ptr<const Table>>();
+        return *tables;
+    }
+
+    inline std::mutex& registryMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    inline Stats& stats() {
+        static auto* counters = new Stats();
+        return *counters;
+    }
+
+    inline Session& session() {
+        static auto* current = new Session();
+        return *current;
+    }
+
+    inline std::vector<std::string> split(const std::string& line) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            size_t first = field.find_first_not_of(" \t\r");
+            size_t last = field.find_last_not_of(" \t\r");
+            fields.push_back(first == std::string::npos ? "" : field.substr(first, last - first + 1));
+        }
+        return fields;
+    }
+
+    // Interpretar users.txt: "gid,G,grupo" y "uid,U,grupo,usuario,contraseña";
+    // id 0 marca una línea borrada
+    inline void parse(const std::string& content, Table& table) {
+        std::stringstream stream(content);
+        std::string line;
+        while (std::getline(stream, line)) {
+            std::vector<std::string> fields = split(line);
+            if (fields.size() < 3) {
+                continue;
+            }
+            int id;
+            try {
+                id = std::stoi(fields[0]);
+            } catch (const std::exception& e) {
+                continue;
+            }
+            if (fields[1] == "G") {
+                table.groupLines++;
+                if (id > 0) {
+                    table.groups[fields[2]] = Group{id, fields[2]};
+                    table.groupById[id] = fields[2];
+                }
+            } else if (fields[1] == "U" && fields.size() >= 5) {
+                table.userLines++;
+                if (id > 0) {
+                    table.users[fields[3]] = User{id, fields[3], fields[2], fields[4]};
+                    table.userById[id] = fields[3];
+                }
+            }
+        }
+    }
+
+    // Tabla vigente de la partición de 'ctx'. Solo se lee users.txt si su
+    // inodo cambió desde la última vez
+    inline std::shared_ptr<const Table> table(FileOps::Context& ctx) {
+        std::string key = Allocator::key(ctx.path, ctx.partStart);
+        if (DelayedAlloc::pendingBytes(ctx, USERS_INODE) > 0) {
+            DelayedAlloc::flush(ctx);
+        }
+        long long generation = FileOps::inodeGeneration(ctx, USERS_INODE);
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            auto it = registry().find(key);
+            if (it != registry().end() && it->second->generation == generation) {
+                stats().hits++;
+                return it->second;
+            }
+        }
+
+        auto fresh = std::make_shared<Table>();
+        Inode inode = FileOps::readInode(ctx, USERS_INODE);
+        if (inode.i_type == '0') {
+            parse(FileOps::readFileData(ctx, inode), *fresh);
+        }
+        fresh->generation = generation;
+        stats().loads++;
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry()[key] = fresh;
+        return fresh;
+    }
+
+    // Reescribir users.txt y dejar en el registro 'updated' (ya con el
+    // cambio aplicado) con la generación que resulta de la escritura
+    inline std::string store(FileOps::Context& ctx, const std::string& content, std::shared_ptr<Table> updated) {
+        Inode inode = FileOps::readInode(ctx, USERS_INODE);
+        std::string error = FileOps::writeFileData(ctx, USERS_INODE, inode, content);
+        FileOps::finish(ctx);
+        if (!error.empty()) {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry().erase(Allocator::key(ctx.path, ctx.partStart));
+            return error;
+        }
+        updated->generation = FileOps::inodeGeneration(ctx, USERS_INODE);
+        stats().updates++;
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry()[Allocator::key(ctx.path, ctx.partStart)] = updated;
+        return "";
+    }
+
+    // Agregar el usuario 'name' al grupo 'group' (que debe existir)
+    inline std::string addUser(FileOps::Context& ctx, const std::string& name, const std::string& password,
+                               const std::string& group) {
+        std::shared_ptr<const Table> current = table(ctx);
+        if (current->users.count(name)) {
+            return "Error: el usuario '" + name + "' ya existe";
+        }
+        if (!current->groups.count(group)) {
+            return "Error: el grupo '" + group + "' no existe";
+        }
+        auto updated = std::make_shared<Table>(*current);
+        int uid = updated->userLines + 1;
+        updated->userLines++;
+        updated->users[name] = User{uid, name, group, password};
+        updated->userById[uid] = name;
+
+        Inode inode = FileOps::readInode(ctx, USERS_INODE);
+        std::string content = FileOps::readFileData(ctx, inode);
+        if (!content.empty() && content.back() != '\n') {
+            content += "\n";
+        }
+        content += std::to_string(uid) + ",U," + group + "," + name + "," + password + "\n";
+        return store(ctx, content, updated);
+    }
+
+    // Borrar el usuario 'name': su línea queda con id 0
+    inline std::string removeUser(FileOps::Context& ctx, const std::string& name) {
+        std::shared_ptr<const Table> current = table(ctx);
+        auto found = current->users.find(name);
+        if (found == current->users.end()) {
+            return "Error: el usuario '" + name + "' no existe";
+        }
+        auto updated = std::make_shared<Table>(*current);
+        updated->userById.erase(found->second.uid);
+        updated->users.erase(name);
+
+        Inode inode = FileOps::readInode(ctx, USERS_INODE);
+        std::stringstream stream(FileOps::readFileData(ctx, inode));
+        std::string line, content;
+        while (std::getline(stream, line)) {
+            std::vector<std::string> fields = split(line);
+            if (fields.size() >= 5 && fields[1] == "U" && fields[3] == name && fields[0] != "0") {
+                line = "0" + line.substr(line.find(','));
+            }
+            content += line + "\n";
+        }
+        return store(ctx, content, updated);
+    }
+
+    // Olvidar la tabla (antes de volver a formatear la partición)
+    inline void discard(const std::string& path, int partStart) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().erase(Allocator::key(path, partStart));
+    }
+
+    // ¿Puede el usuario de la sesión hacer 'need' (4 leer, 2 escribir) sobre
+    // el inodo? Sin sesión, o en otra partición, no se revisa nada; root
+    // puede todo. Con la tabla vigente son búsquedas en memoria
+    inline bool allowed(FileOps::Context& ctx, const Inode& inode, int need) {
+        const Session& current = session();
+        if (!current.active || current.path != ctx.path || current.partStart != ctx.partStart) {
+            return true;
+        }
+        std::shared_ptr<const Table> users = table(ctx);
+        auto name = users->userById.find(current.uid);
+        if (name == users->userById.end()) {
+            return false;   // Usuario borrado con la sesión abierta
+        }
+        if (current.uid == ROOT_UID) {
+            return true;
+        }
+        int digit = inode.i_uid == current.uid ? inode.i_perm / 100
+                  : inode.i_gid == current.gid ? inode.i_perm / 10 % 10
+                  : inode.i_perm % 10;
+        return (digit & need) == need;
+    }
+
+    // Crear 'path' (ya separada en 'parts') escribe en la carpeta existente
+    // más profunda del camino: el padre o, con -p/-r, la última que ya existe
+    // (las que faltan se crean dentro de ella). Con 'inside' la ruta es la
+    // carpeta donde se escribe (import), así que cuenta ella misma. Devuelve
+    // el error si la sesión no puede escribir ahí
+    inline std::string checkCreate(FileOps::Context& ctx, const std::vector<std::string>& parts,
+                                   const std::string& path, bool inside = false) {
+        int current = 0;   // Raíz
+        Inode dir = FileOps::readInode(ctx, current);
+        for (size_t k = 0; k + (inside ? 0 : 1) < parts.size(); k++) {
+            int next = FileOps::lookup(ctx, current, dir, parts[k]);
+            if (next == -1) {
+                break;
+            }
+            Inode child = FileOps::readInode(ctx, next);
+            if (child.i_type != '1') {
+                break;      // resolveParent informa el error
+            }
+            current = next;
+            dir = child;
+        }
+        if (!allowed(ctx, dir, 2)) {
+            return inside ? "Error: sin permiso de escritura para importar en '" + path + "'"
+                          : "Error: sin permiso de escritura sobre la carpeta de '" + path + "'";
+        }
+        return "";
+    }
+
+} // namespace Users
+
+#endif // USERS_H